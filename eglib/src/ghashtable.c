@@ -29,32 +29,45 @@
 #include <math.h>
 #include <glib.h>
 
-typedef struct _Slot Slot;
+/*
+ * The table uses open addressing with linear probing over a power of two sized
+ * array, so a lookup touches one or two cache lines instead of chasing a list of
+ * separately allocated slots. The (mixed) hash code of each entry is kept in a
+ * parallel array, which is scanned first and lets most mismatches be rejected
+ * without calling key_equal_func, and lets the table be resized without calling
+ * hash_func again.
+ *
+ * Removed entries leave a tombstone behind instead of moving later entries back,
+ * so removing entries while iterating the table is safe. Tombstones are dropped
+ * the next time the table is resized.
+ */
 
-struct _Slot {
+typedef struct {
 	gpointer key;
 	gpointer value;
-	Slot    *next;
-};
+} Entry;
+
+#define HASH_EMPTY 0
+#define HASH_TOMBSTONE 1
+#define HASH_IS_LIVE(h) ((h) > HASH_TOMBSTONE)
 
-static gpointer KEYMARKER_REMOVED = &KEYMARKER_REMOVED;
+#define MIN_TABLE_SIZE 8
 
 struct _GHashTable {
 	GHashFunc      hash_func;
 	GEqualFunc     key_equal_func;
 
-	Slot **table;
+	guint *hashes;
+	Entry *entries;
 	int   table_size;
 	int   in_use;
-	int   threshold;
-	int   last_rehash;
+	int   tombstones;
 	GDestroyNotify value_destroy_func, key_destroy_func;
 };
 
 typedef struct {
 	GHashTable *ht;
 	int slot_index;
-	Slot *slot;
 } Iter;
 
 static const guint prime_tbl[] = {
@@ -104,6 +117,51 @@ g_spaced_primes_closest (guint x)
 	return calc_prime (x);
 }
 
+/*
+ * The table is indexed by the low bits of the hash code, and hash functions like
+ * g_direct_hash () leave those bits constant, so scramble them first with the
+ * MurmurHash3 finalizer. The result is never HASH_EMPTY or HASH_TOMBSTONE.
+ */
+static inline guint
+mix_hash (guint h)
+{
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return HASH_IS_LIVE (h) ? h : h + 2;
+}
+
+/* Most tables use g_direct_hash/g_direct_equal, so avoid the indirect calls for those */
+static inline guint
+hash_key (GHashTable *hash, gconstpointer key)
+{
+	return mix_hash (hash->hash_func == g_direct_hash ? GPOINTER_TO_UINT (key) : (*hash->hash_func) (key));
+}
+
+#define KEYS_EQUAL(hash,k1,k2) ((hash)->key_equal_func == g_direct_equal ? (k1) == (k2) : (*(hash)->key_equal_func) ((k1), (k2)))
+
+/* Smallest table size which keeps the load factor of N entries under 1/2 */
+static int
+table_size_for (int n)
+{
+	int size = MIN_TABLE_SIZE;
+
+	while (size < n * 2)
+		size <<= 1;
+	return size;
+}
+
+static void
+alloc_table (GHashTable *hash, int size)
+{
+	hash->table_size = size;
+	hash->hashes = g_new0 (guint, size);
+	hash->entries = g_new0 (Entry, size);
+	hash->tombstones = 0;
+}
+
 GHashTable *
 g_hash_table_new (GHashFunc hash_func, GEqualFunc key_equal_func)
 {
@@ -118,9 +176,7 @@ g_hash_table_new (GHashFunc hash_func, GEqualFunc key_equal_func)
 	hash->hash_func = hash_func;
 	hash->key_equal_func = key_equal_func;
 
-	hash->table_size = g_spaced_primes_closest (1);
-	hash->table = g_new0 (Slot *, hash->table_size);
-	hash->last_rehash = hash->table_size;
+	alloc_table (hash, MIN_TABLE_SIZE);
 	
 	return hash;
 }
@@ -139,44 +195,32 @@ g_hash_table_new_full (GHashFunc hash_func, GEqualFunc key_equal_func,
 	return hash;
 }
 
-#if 0
-static void
-dump_hash_table (GHashTable *hash)
-{
-	int i;
-
-	for (i = 0; i < hash->table_size; i++) {
-		Slot *s;
-
-		for (s = hash->table [i]; s != NULL; s = s->next){
-			guint hashcode = (*hash->hash_func) (s->key);
-			guint slot = (hashcode) % hash->table_size;
-			printf ("key %p hash %x on slot %d correct slot %d tb size %d\n", s->key, hashcode, i, slot, hash->table_size);
-		}
-	}
-}
-#endif
-
 #ifdef SANITY_CHECK
 static void
 sanity_check (GHashTable *hash)
 {
-	int i;
+	int i, live = 0, tombstones = 0;
+	guint mask = hash->table_size - 1;
 
 	for (i = 0; i < hash->table_size; i++) {
-		Slot *s;
-
-		for (s = hash->table [i]; s != NULL; s = s->next){
-			guint hashcode = (*hash->hash_func) (s->key);
-			guint slot = (hashcode) % hash->table_size;
-			if (slot != i) {
-				dump_hashcode_func = 1;
-				hashcode = (*hash->hash_func) (s->key);
-				dump_hashcode_func = 0;
-				g_error ("Key %p (bucket %d) on invalid bucket %d (hashcode %x) (tb size %d)", s->key, slot, i, hashcode, hash->table_size);
-			}
+		guint hashcode = hash->hashes [i];
+		guint j;
+
+		if (hashcode == HASH_TOMBSTONE)
+			tombstones++;
+		if (!HASH_IS_LIVE (hashcode))
+			continue;
+		live++;
+		if (hashcode != hash_key (hash, hash->entries [i].key))
+			g_error ("Key %p on slot %d has a stale hashcode %x", hash->entries [i].key, i, hashcode);
+		/* There must be no empty slot between the home slot and the entry */
+		for (j = hashcode & mask; j != i; j = (j + 1) & mask) {
+			if (hash->hashes [j] == HASH_EMPTY)
+				g_error ("Key %p on slot %d is unreachable from slot %d", hash->entries [i].key, i, hashcode & mask);
 		}
 	}
+	if (live != hash->in_use || tombstones != hash->tombstones)
+		g_error ("Found %d entries and %d tombstones, expected %d and %d", live, tombstones, hash->in_use, hash->tombstones);
 }
 #else
 
@@ -185,81 +229,112 @@ sanity_check (GHashTable *hash)
 #endif
 
 static void
-do_rehash (GHashTable *hash)
-{
-	int current_size, i;
-	Slot **table;
-
-	/* printf ("Resizing diff=%d slots=%d\n", hash->in_use - hash->last_rehash, hash->table_size); */
-	hash->last_rehash = hash->table_size;
-	current_size = hash->table_size;
-	hash->table_size = g_spaced_primes_closest (hash->in_use);
-	/* printf ("New size: %d\n", hash->table_size); */
-	table = hash->table;
-	hash->table = g_new0 (Slot *, hash->table_size);
-	
-	for (i = 0; i < current_size; i++){
-		Slot *s, *next;
+resize (GHashTable *hash, int new_size)
+{
+	guint *hashes = hash->hashes;
+	Entry *entries = hash->entries;
+	int i, current_size = hash->table_size;
+	guint mask;
 
-		for (s = table [i]; s != NULL; s = next){
-			guint hashcode = ((*hash->hash_func) (s->key)) % hash->table_size;
-			next = s->next;
+	alloc_table (hash, new_size);
+	mask = new_size - 1;
 
-			s->next = hash->table [hashcode];
-			hash->table [hashcode] = s;
-		}
+	for (i = 0; i < current_size; i++){
+		guint j;
+
+		if (!HASH_IS_LIVE (hashes [i]))
+			continue;
+		for (j = hashes [i] & mask; hash->hashes [j] != HASH_EMPTY; j = (j + 1) & mask)
+			;
+		hash->hashes [j] = hashes [i];
+		hash->entries [j] = entries [i];
 	}
-	g_free (table);
+	g_free (hashes);
+	g_free (entries);
 }
 
+/* Shrink the table after a lot of entries have been removed */
 static void
-rehash (GHashTable *hash)
+maybe_shrink (GHashTable *hash)
 {
-	int diff = ABS (hash->last_rehash - hash->in_use);
+	if (hash->table_size > MIN_TABLE_SIZE && hash->in_use * 8 < hash->table_size)
+		resize (hash, table_size_for (hash->in_use));
+}
 
-	/* These are the factors to play with to change the rehashing strategy */
-	/* I played with them with a large range, and could not really get */
-	/* something that was too good, maybe the tests are not that great */
-	if (!(diff * 0.75 > hash->table_size * 2))
-		return;
-	do_rehash (hash);
-	sanity_check (hash);
+static int
+find_slot (GHashTable *hash, gconstpointer key)
+{
+	guint hashcode = hash_key (hash, key);
+	guint mask = hash->table_size - 1;
+	guint i;
+
+	for (i = hashcode & mask; hash->hashes [i] != HASH_EMPTY; i = (i + 1) & mask) {
+		if (hash->hashes [i] == hashcode && KEYS_EQUAL (hash, hash->entries [i].key, key))
+			return i;
+	}
+	return -1;
+}
+
+static void
+clear_slot (GHashTable *hash, int i, gboolean notify)
+{
+	if (notify) {
+		if (hash->key_destroy_func != NULL)
+			(*hash->key_destroy_func)(hash->entries [i].key);
+		if (hash->value_destroy_func != NULL)
+			(*hash->value_destroy_func)(hash->entries [i].value);
+	}
+	/* A tombstone is only needed if a probe sequence can continue past this slot */
+	if (hash->hashes [(i + 1) & (hash->table_size - 1)] == HASH_EMPTY) {
+		hash->hashes [i] = HASH_EMPTY;
+	} else {
+		hash->hashes [i] = HASH_TOMBSTONE;
+		hash->tombstones++;
+	}
+	hash->entries [i].key = NULL;
+	hash->entries [i].value = NULL;
+	hash->in_use--;
 }
 
 void
 g_hash_table_insert_replace (GHashTable *hash, gpointer key, gpointer value, gboolean replace)
 {
-	guint hashcode;
-	Slot *s;
-	GEqualFunc equal;
+	guint hashcode, mask, i;
+	int free_slot = -1;
 	
 	g_return_if_fail (hash != NULL);
 	sanity_check (hash);
 
-	equal = hash->key_equal_func;
-	if (hash->in_use >= hash->threshold)
-		rehash (hash);
-
-	hashcode = ((*hash->hash_func) (key)) % hash->table_size;
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal) (s->key, key)){
+	/* Keep at least a quarter of the slots empty so probe sequences stay short */
+	if ((hash->in_use + hash->tombstones + 1) * 4 > hash->table_size * 3)
+		resize (hash, table_size_for (hash->in_use + 1));
+
+	hashcode = hash_key (hash, key);
+	mask = hash->table_size - 1;
+	for (i = hashcode & mask; hash->hashes [i] != HASH_EMPTY; i = (i + 1) & mask) {
+		if (hash->hashes [i] == HASH_TOMBSTONE) {
+			if (free_slot == -1)
+				free_slot = i;
+		} else if (hash->hashes [i] == hashcode && KEYS_EQUAL (hash, hash->entries [i].key, key)) {
 			if (replace){
 				if (hash->key_destroy_func != NULL)
-					(*hash->key_destroy_func)(s->key);
-				s->key = key;
+					(*hash->key_destroy_func)(hash->entries [i].key);
+				hash->entries [i].key = key;
 			}
 			if (hash->value_destroy_func != NULL)
-				(*hash->value_destroy_func) (s->value);
-			s->value = value;
+				(*hash->value_destroy_func) (hash->entries [i].value);
+			hash->entries [i].value = value;
 			sanity_check (hash);
 			return;
 		}
 	}
-	s = g_new (Slot, 1);
-	s->key = key;
-	s->value = value;
-	s->next = hash->table [hashcode];
-	hash->table [hashcode] = s;
+	if (free_slot == -1)
+		free_slot = i;
+	else
+		hash->tombstones--;
+	hash->entries [free_slot].key = key;
+	hash->entries [free_slot].value = value;
+	hash->hashes [free_slot] = hashcode;
 	hash->in_use++;
 	sanity_check (hash);
 }
@@ -317,26 +392,19 @@ g_hash_table_lookup (GHashTable *hash, gconstpointer key)
 gboolean
 g_hash_table_lookup_extended (GHashTable *hash, gconstpointer key, gpointer *orig_key, gpointer *value)
 {
-	GEqualFunc equal;
-	Slot *s;
-	guint hashcode;
+	int i;
 	
 	g_return_val_if_fail (hash != NULL, FALSE);
 	sanity_check (hash);
-	equal = hash->key_equal_func;
 
-	hashcode = ((*hash->hash_func) (key)) % hash->table_size;
-	
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal)(s->key, key)){
-			if (orig_key)
-				*orig_key = s->key;
-			if (value)
-				*value = s->value;
-			return TRUE;
-		}
-	}
-	return FALSE;
+	i = find_slot (hash, key);
+	if (i == -1)
+		return FALSE;
+	if (orig_key)
+		*orig_key = hash->entries [i].key;
+	if (value)
+		*value = hash->entries [i].value;
+	return TRUE;
 }
 
 void
@@ -348,10 +416,8 @@ g_hash_table_foreach (GHashTable *hash, GHFunc func, gpointer user_data)
 	g_return_if_fail (func != NULL);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s;
-
-		for (s = hash->table [i]; s != NULL; s = s->next)
-			(*func)(s->key, s->value, user_data);
+		if (HASH_IS_LIVE (hash->hashes [i]))
+			(*func)(hash->entries [i].key, hash->entries [i].value, user_data);
 	}
 }
 
@@ -364,11 +430,8 @@ g_hash_table_find (GHashTable *hash, GHRFunc predicate, gpointer user_data)
 	g_return_val_if_fail (predicate != NULL, NULL);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s;
-
-		for (s = hash->table [i]; s != NULL; s = s->next)
-			if ((*predicate)(s->key, s->value, user_data))
-				return s->value;
+		if (HASH_IS_LIVE (hash->hashes [i]) && (*predicate)(hash->entries [i].key, hash->entries [i].value, user_data))
+			return hash->entries [i].value;
 	}
 	return NULL;
 }
@@ -381,164 +444,81 @@ g_hash_table_remove_all (GHashTable *hash)
 	g_return_if_fail (hash != NULL);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s;
-
-		while (hash->table [i]) {
-			s = hash->table [i];
-			g_hash_table_remove (hash, s->key);
-		}
+		if (HASH_IS_LIVE (hash->hashes [i]))
+			clear_slot (hash, i, TRUE);
 	}
+	g_free (hash->hashes);
+	g_free (hash->entries);
+	alloc_table (hash, MIN_TABLE_SIZE);
 }
 
 gboolean
 g_hash_table_remove (GHashTable *hash, gconstpointer key)
 {
-	GEqualFunc equal;
-	Slot *s, *last;
-	guint hashcode;
+	int i;
 	
 	g_return_val_if_fail (hash != NULL, FALSE);
 	sanity_check (hash);
-	equal = hash->key_equal_func;
-
-	hashcode = ((*hash->hash_func)(key)) % hash->table_size;
-	last = NULL;
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal)(s->key, key)){
-			if (hash->key_destroy_func != NULL)
-				(*hash->key_destroy_func)(s->key);
-			if (hash->value_destroy_func != NULL)
-				(*hash->value_destroy_func)(s->value);
-			if (last == NULL)
-				hash->table [hashcode] = s->next;
-			else
-				last->next = s->next;
-			g_free (s);
-			hash->in_use--;
-			sanity_check (hash);
-			return TRUE;
-		}
-		last = s;
-	}
+
+	i = find_slot (hash, key);
+	if (i == -1)
+		return FALSE;
+	clear_slot (hash, i, TRUE);
 	sanity_check (hash);
-	return FALSE;
+	return TRUE;
 }
 
-guint
-g_hash_table_foreach_remove (GHashTable *hash, GHRFunc func, gpointer user_data)
+static guint
+foreach_remove (GHashTable *hash, GHRFunc func, gpointer user_data, gboolean notify)
 {
 	int i;
 	int count = 0;
-	
-	g_return_val_if_fail (hash != NULL, 0);
-	g_return_val_if_fail (func != NULL, 0);
 
 	sanity_check (hash);
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s, *last;
-
-		last = NULL;
-		for (s = hash->table [i]; s != NULL; ){
-			if ((*func)(s->key, s->value, user_data)){
-				Slot *n;
-
-				if (hash->key_destroy_func != NULL)
-					(*hash->key_destroy_func)(s->key);
-				if (hash->value_destroy_func != NULL)
-					(*hash->value_destroy_func)(s->value);
-				if (last == NULL){
-					hash->table [i] = s->next;
-					n = s->next;
-				} else  {
-					last->next = s->next;
-					n = last->next;
-				}
-				g_free (s);
-				hash->in_use--;
-				count++;
-				s = n;
-			} else {
-				last = s;
-				s = s->next;
-			}
+		if (HASH_IS_LIVE (hash->hashes [i]) && (*func)(hash->entries [i].key, hash->entries [i].value, user_data)){
+			clear_slot (hash, i, notify);
+			count++;
 		}
 	}
 	sanity_check (hash);
 	if (count > 0)
-		rehash (hash);
+		maybe_shrink (hash);
 	return count;
 }
 
+guint
+g_hash_table_foreach_remove (GHashTable *hash, GHRFunc func, gpointer user_data)
+{
+	g_return_val_if_fail (hash != NULL, 0);
+	g_return_val_if_fail (func != NULL, 0);
+
+	return foreach_remove (hash, func, user_data, TRUE);
+}
+
 gboolean
 g_hash_table_steal (GHashTable *hash, gconstpointer key)
 {
-	GEqualFunc equal;
-	Slot *s, *last;
-	guint hashcode;
+	int i;
 	
 	g_return_val_if_fail (hash != NULL, FALSE);
 	sanity_check (hash);
-	equal = hash->key_equal_func;
-	
-	hashcode = ((*hash->hash_func)(key)) % hash->table_size;
-	last = NULL;
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal)(s->key, key)) {
-			if (last == NULL)
-				hash->table [hashcode] = s->next;
-			else
-				last->next = s->next;
-			g_free (s);
-			hash->in_use--;
-			sanity_check (hash);
-			return TRUE;
-		}
-		last = s;
-	}
+
+	i = find_slot (hash, key);
+	if (i == -1)
+		return FALSE;
+	clear_slot (hash, i, FALSE);
 	sanity_check (hash);
-	return FALSE;
-	
+	return TRUE;
 }
 
 guint
 g_hash_table_foreach_steal (GHashTable *hash, GHRFunc func, gpointer user_data)
 {
-	int i;
-	int count = 0;
-	
 	g_return_val_if_fail (hash != NULL, 0);
 	g_return_val_if_fail (func != NULL, 0);
 
-	sanity_check (hash);
-	for (i = 0; i < hash->table_size; i++){
-		Slot *s, *last;
-
-		last = NULL;
-		for (s = hash->table [i]; s != NULL; ){
-			if ((*func)(s->key, s->value, user_data)){
-				Slot *n;
-
-				if (last == NULL){
-					hash->table [i] = s->next;
-					n = s->next;
-				} else  {
-					last->next = s->next;
-					n = last->next;
-				}
-				g_free (s);
-				hash->in_use--;
-				count++;
-				s = n;
-			} else {
-				last = s;
-				s = s->next;
-			}
-		}
-	}
-	sanity_check (hash);
-	if (count > 0)
-		rehash (hash);
-	return count;
+	return foreach_remove (hash, func, user_data, FALSE);
 }
 
 void
@@ -549,19 +529,15 @@ g_hash_table_destroy (GHashTable *hash)
 	g_return_if_fail (hash != NULL);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s, *next;
-
-		for (s = hash->table [i]; s != NULL; s = next){
-			next = s->next;
-			
-			if (hash->key_destroy_func != NULL)
-				(*hash->key_destroy_func)(s->key);
-			if (hash->value_destroy_func != NULL)
-				(*hash->value_destroy_func)(s->value);
-			g_free (s);
-		}
+		if (!HASH_IS_LIVE (hash->hashes [i]))
+			continue;
+		if (hash->key_destroy_func != NULL)
+			(*hash->key_destroy_func)(hash->entries [i].key);
+		if (hash->value_destroy_func != NULL)
+			(*hash->value_destroy_func)(hash->entries [i].value);
 	}
-	g_free (hash->table);
+	g_free (hash->hashes);
+	g_free (hash->entries);
 	
 	g_free (hash);
 }
@@ -569,22 +545,22 @@ g_hash_table_destroy (GHashTable *hash)
 void
 g_hash_table_print_stats (GHashTable *table)
 {
-	int i, max_chain_index, chain_size, max_chain_size;
-	Slot *node;
+	int i, probe_length, max_probe_length, max_probe_index;
+	guint mask = table->table_size - 1;
 
-	max_chain_size = 0;
-	max_chain_index = -1;
+	max_probe_length = 0;
+	max_probe_index = -1;
 	for (i = 0; i < table->table_size; i++) {
-		chain_size = 0;
-		for (node = table->table [i]; node; node = node->next)
-			chain_size ++;
-		if (chain_size > max_chain_size) {
-			max_chain_size = chain_size;
-			max_chain_index = i;
+		if (!HASH_IS_LIVE (table->hashes [i]))
+			continue;
+		probe_length = ((i - (table->hashes [i] & mask)) & mask) + 1;
+		if (probe_length > max_probe_length) {
+			max_probe_length = probe_length;
+			max_probe_index = i;
 		}
 	}
 
-	printf ("Size: %d Table Size: %d Max Chain Length: %d at %d\n", table->in_use, table->table_size, max_chain_size, max_chain_index);
+	printf ("Size: %d Table Size: %d Tombstones: %d Max Probe Length: %d at %d\n", table->in_use, table->table_size, table->tombstones, max_probe_length, max_probe_index);
 }
 
 void
@@ -606,24 +582,20 @@ gboolean g_hash_table_iter_next (GHashTableIter *it, gpointer *key, gpointer *va
 	g_assert (iter->slot_index != -2);
 	g_assert (sizeof (Iter) <= sizeof (GHashTableIter));
 
-	if (!iter->slot) {
-		while (TRUE) {
-			iter->slot_index ++;
-			if (iter->slot_index >= hash->table_size) {
-				iter->slot_index = -2;
-				return FALSE;
-			}
-			if (hash->table [iter->slot_index])
-				break;
+	while (TRUE) {
+		iter->slot_index ++;
+		if (iter->slot_index >= hash->table_size) {
+			iter->slot_index = -2;
+			return FALSE;
 		}
-		iter->slot = hash->table [iter->slot_index];
+		if (HASH_IS_LIVE (hash->hashes [iter->slot_index]))
+			break;
 	}
 
 	if (key)
-		*key = iter->slot->key;
+		*key = hash->entries [iter->slot_index].key;
 	if (value)
-		*value = iter->slot->value;
-	iter->slot = iter->slot->next;
+		*value = hash->entries [iter->slot_index].value;
 
 	return TRUE;
 }
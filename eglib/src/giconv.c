@@ -33,6 +33,10 @@
 #include <iconv.h>
 #endif
 #include <errno.h>
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define USE_SSE2 1
+#include <emmintrin.h>
+#endif
 
 #ifdef _MSC_VER
 #define FORCE_INLINE(RET_TYPE) __forceinline RET_TYPE
@@ -886,6 +890,110 @@ g_unichar_to_utf16 (gunichar c, gunichar2 *outbuf)
 	}
 }
 
+/*
+ * Most strings converted by the runtime are ASCII, so the UTF-8 <-> UTF-16
+ * conversions handle the leading run of ASCII characters (not counting NUL,
+ * which the conversions treat specially) without decoding it.
+ */
+static glong
+utf16_ascii_prefix (const gunichar2 *str, glong len)
+{
+	glong i = 0;
+
+#ifdef USE_SSE2
+	const __m128i one = _mm_set1_epi16 (1);
+	const __m128i max = _mm_set1_epi16 (0x7e);
+	const __m128i zero = _mm_setzero_si128 ();
+
+	for (; i + 8 <= len; i += 8) {
+		/* c - 1 wraps around for NUL, so this is 0 for chars between 1 and 0x7f */
+		__m128i v = _mm_subs_epu16 (_mm_sub_epi16 (_mm_loadu_si128 ((const __m128i *) (str + i)), one), max);
+
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi16 (v, zero)) != 0xffff)
+			break;
+	}
+#endif
+	for (; i < len; i++) {
+		if (str [i] == 0 || str [i] >= 0x80)
+			break;
+	}
+
+	return i;
+}
+
+static glong
+utf8_ascii_prefix (const gchar *str, glong len)
+{
+	glong i = 0;
+
+#ifdef USE_SSE2
+	const __m128i one = _mm_set1_epi8 (1);
+	const __m128i max = _mm_set1_epi8 (0x7e);
+	const __m128i zero = _mm_setzero_si128 ();
+
+	for (; i + 16 <= len; i += 16) {
+		__m128i v = _mm_subs_epu8 (_mm_sub_epi8 (_mm_loadu_si128 ((const __m128i *) (str + i)), one), max);
+
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, zero)) != 0xffff)
+			break;
+	}
+#endif
+	for (; i < len; i++) {
+		if (str [i] == 0 || (guchar) str [i] >= 0x80)
+			break;
+	}
+
+	return i;
+}
+
+static void
+ascii_utf16_to_utf8 (const gunichar2 *str, glong len, gchar *outbuf)
+{
+	glong i = 0;
+
+#ifdef USE_SSE2
+	for (; i + 16 <= len; i += 16) {
+		__m128i lo = _mm_loadu_si128 ((const __m128i *) (str + i));
+		__m128i hi = _mm_loadu_si128 ((const __m128i *) (str + i + 8));
+
+		_mm_storeu_si128 ((__m128i *) (outbuf + i), _mm_packus_epi16 (lo, hi));
+	}
+#endif
+	for (; i < len; i++)
+		outbuf [i] = (gchar) str [i];
+}
+
+static void
+ascii_utf8_to_utf16 (const gchar *str, glong len, gunichar2 *outbuf)
+{
+	glong i = 0;
+
+#ifdef USE_SSE2
+	const __m128i zero = _mm_setzero_si128 ();
+
+	for (; i + 16 <= len; i += 16) {
+		__m128i v = _mm_loadu_si128 ((const __m128i *) (str + i));
+
+		_mm_storeu_si128 ((__m128i *) (outbuf + i), _mm_unpacklo_epi8 (v, zero));
+		_mm_storeu_si128 ((__m128i *) (outbuf + i + 8), _mm_unpackhi_epi8 (v, zero));
+	}
+#endif
+	for (; i < len; i++)
+		outbuf [i] = (guchar) str [i];
+}
+
+glong
+eg_utf8_ascii_prefix (const gchar *str, glong len)
+{
+	return utf8_ascii_prefix (str, len);
+}
+
+void
+eg_ascii_to_utf16 (const gchar *str, glong len, gunichar2 *outbuf)
+{
+	ascii_utf8_to_utf16 (str, len, outbuf);
+}
+
 gunichar *
 g_utf8_to_ucs4_fast (const gchar *str, glong len, glong *items_written)
 {
@@ -921,6 +1029,7 @@ eg_utf8_to_utf16_general (const gchar *str, glong len, glong *items_read, glong
 	size_t inleft;
 	char *inptr;
 	gunichar c;
+	glong prefix;
 	int u, n;
 	
 	g_return_val_if_fail (str != NULL, NULL);
@@ -934,8 +1043,10 @@ eg_utf8_to_utf16_general (const gchar *str, glong len, glong *items_read, glong
 		len = strlen (str);
 	}
 	
-	inptr = (char *) str;
-	inleft = len;
+	prefix = utf8_ascii_prefix (str, len);
+	outlen = prefix;
+	inptr = (char *) str + prefix;
+	inleft = len - prefix;
 	
 	while (inleft > 0) {
 		if ((n = decode_utf8 (inptr, inleft, &c)) < 0)
@@ -961,8 +1072,10 @@ eg_utf8_to_utf16_general (const gchar *str, glong len, glong *items_read, glong
 		*items_written = outlen;
 	
 	outptr = outbuf = g_malloc ((outlen + 1) * sizeof (gunichar2));
-	inptr = (char *) str;
-	inleft = len;
+	ascii_utf8_to_utf16 (str, prefix, outptr);
+	outptr += prefix;
+	inptr = (char *) str + prefix;
+	inleft = len - prefix;
 	
 	while (inleft > 0) {
 		if ((n = decode_utf8 (inptr, inleft, &c)) < 0)
@@ -1091,6 +1204,7 @@ g_utf16_to_utf8 (const gunichar2 *str, glong len, glong *items_read, glong *item
 	size_t outlen = 0;
 	size_t inleft;
 	gunichar c;
+	glong prefix;
 	int n;
 	
 	g_return_val_if_fail (str != NULL, NULL);
@@ -1101,8 +1215,10 @@ g_utf16_to_utf8 (const gunichar2 *str, glong len, glong *items_read, glong *item
 			len++;
 	}
 	
-	inptr = (char *) str;
-	inleft = len * 2;
+	prefix = utf16_ascii_prefix (str, len);
+	outlen = prefix;
+	inptr = (char *) (str + prefix);
+	inleft = (len - prefix) * 2;
 	
 	while (inleft > 0) {
 		if ((n = decode_utf16 (inptr, inleft, &c)) < 0) {
@@ -1145,8 +1261,10 @@ g_utf16_to_utf8 (const gunichar2 *str, glong len, glong *items_read, glong *item
 		*items_written = outlen;
 	
 	outptr = outbuf = g_malloc (outlen + 1);
-	inptr = (char *) str;
-	inleft = len * 2;
+	ascii_utf16_to_utf8 (str, prefix, outptr);
+	outptr += prefix;
+	inptr = (char *) (str + prefix);
+	inleft = (len - prefix) * 2;
 	
 	while (inleft > 0) {
 		if ((n = decode_utf16 (inptr, inleft, &c)) < 0)
@@ -1164,6 +1282,53 @@ g_utf16_to_utf8 (const gunichar2 *str, glong len, glong *items_read, glong *item
 	return outbuf;
 }
 
+/*
+ * eg_utf16_to_utf8_buf:
+ *
+ *   Convert the first LEN characters of STR to a nul-terminated UTF-8 string in BUF,
+ * stopping at the first nul character, like g_utf16_to_utf8 () does. Returns the
+ * number of bytes written, not counting the terminator, or -1 if STR is not valid
+ * UTF-16 or BUF_SIZE bytes are not enough. LEN * 3 + 1 bytes are always enough.
+ */
+glong
+eg_utf16_to_utf8_buf (const gunichar2 *str, glong len, gchar *buf, glong buf_size)
+{
+	char *inptr, *outptr, *outend;
+	size_t inleft;
+	gunichar c;
+	glong prefix;
+	int n, u;
+	
+	prefix = utf16_ascii_prefix (str, len);
+	if (prefix >= buf_size)
+		return -1;
+	
+	ascii_utf16_to_utf8 (str, prefix, buf);
+	outptr = buf + prefix;
+	outend = buf + buf_size;
+	inptr = (char *) (str + prefix);
+	inleft = (len - prefix) * 2;
+	
+	while (inleft > 0) {
+		if ((n = decode_utf16 (inptr, inleft, &c)) < 0)
+			return -1;
+		else if (c == 0)
+			break;
+		
+		u = g_unichar_to_utf8 (c, NULL);
+		if (outend - outptr <= u)
+			return -1;
+		
+		outptr += g_unichar_to_utf8 (c, outptr);
+		inleft -= n;
+		inptr += n;
+	}
+	
+	*outptr = '\0';
+	
+	return outptr - buf;
+}
+
 gunichar *
 g_utf16_to_ucs4 (const gunichar2 *str, glong len, glong *items_read, glong *items_written, GError **err)
 {
@@ -758,6 +758,9 @@ gunichar  *g_utf8_to_ucs4 (const gchar *str, glong len, glong *items_read, glong
 gunichar2 *g_utf8_to_utf16 (const gchar *str, glong len, glong *items_read, glong *items_written, GError **err);
 gunichar2 *eg_utf8_to_utf16_with_nuls (const gchar *str, glong len, glong *items_read, glong *items_written, GError **err);
 gchar     *g_utf16_to_utf8 (const gunichar2 *str, glong len, glong *items_read, glong *items_written, GError **err);
+glong      eg_utf16_to_utf8_buf (const gunichar2 *str, glong len, gchar *buf, glong buf_size);
+glong      eg_utf8_ascii_prefix (const gchar *str, glong len);
+void       eg_ascii_to_utf16 (const gchar *str, glong len, gunichar2 *outbuf);
 gunichar  *g_utf16_to_ucs4 (const gunichar2 *str, glong len, glong *items_read, glong *items_written, GError **err);
 gchar     *g_ucs4_to_utf8  (const gunichar *str, glong len, glong *items_read, glong *items_written, GError **err);
 gunichar2 *g_ucs4_to_utf16 (const gunichar *str, glong len, glong *items_read, glong *items_written, GError **err);
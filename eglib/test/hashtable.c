@@ -163,6 +163,58 @@ RESULT hash_iter (void)
 #endif
 }
 
+static gboolean
+remove_odd (gpointer key, gpointer value, gpointer user_data)
+{
+	return (GPOINTER_TO_UINT (key) & 1) != 0;
+}
+
+RESULT hash_remove_reinsert (void)
+{
+	GHashTable *hash = g_hash_table_new (NULL, NULL);
+	GHashTableIter iter;
+	gpointer key, value;
+	int i, round, count;
+
+	/* Repeatedly fill and drain the table, so removed slots get reused */
+	for (round = 0; round < 10; round++) {
+		for (i = 0; i < 1000; i++)
+			g_hash_table_insert (hash, GUINT_TO_POINTER (i), GUINT_TO_POINTER (i + round));
+		for (i = 0; i < 1000; i += 2) {
+			if (!g_hash_table_remove (hash, GUINT_TO_POINTER (i)))
+				return FAILED ("Did not remove %d in round %d", i, round);
+		}
+		for (i = 0; i < 1000; i++) {
+			gboolean found = g_hash_table_lookup_extended (hash, GUINT_TO_POINTER (i), &key, &value);
+			if (found != ((i & 1) != 0))
+				return FAILED ("Lookup of %d returned %d in round %d", i, found, round);
+			if (found && value != GUINT_TO_POINTER (i + round))
+				return FAILED ("Wrong value for %d in round %d", i, round);
+		}
+		if (g_hash_table_size (hash) != 500)
+			return FAILED ("Size is %d, expected 500", g_hash_table_size (hash));
+		if (g_hash_table_foreach_remove (hash, remove_odd, NULL) != 500)
+			return FAILED ("foreach_remove did not remove all entries");
+		if (g_hash_table_size (hash) != 0)
+			return FAILED ("Size is %d, expected 0", g_hash_table_size (hash));
+	}
+
+	/* Removing the current entry while iterating must not skip or repeat entries */
+	for (i = 0; i < 1000; i++)
+		g_hash_table_insert (hash, GUINT_TO_POINTER (i), GUINT_TO_POINTER (i));
+	count = 0;
+	g_hash_table_iter_init (&iter, hash);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		g_hash_table_remove (hash, key);
+		count++;
+	}
+	if (count != 1000 || g_hash_table_size (hash) != 0)
+		return FAILED ("Iterated %d entries, %d left", count, g_hash_table_size (hash));
+
+	g_hash_table_destroy (hash);
+	return NULL;
+}
+
 static Test hashtable_tests [] = {
 	{"t1", hash_t1},
 	{"t2", hash_t2},
@@ -170,6 +222,7 @@ static Test hashtable_tests [] = {
 	{"default", hash_default},
 	{"null_lookup", hash_null_lookup},
 	{"iter", hash_iter},
+	{"remove_reinsert", hash_remove_reinsert},
 	{NULL, NULL}
 };
 
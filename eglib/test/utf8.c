@@ -908,6 +908,65 @@ test_utf8_strdown ()
 	return OK;
 }
 
+/*
+ * ASCII runs of every length, so both the vector and the scalar parts of the
+ * ASCII fast paths are covered, followed by a non-ASCII character or a nul.
+ */
+RESULT
+test_ascii_runs ()
+{
+	gunichar2 utf16 [64], *utf16_res;
+	gchar utf8 [128], buf [256], *utf8_res;
+	glong i, len, written, res;
+	int k;
+
+	for (len = 0; len < 40; len++) {
+		for (k = 0; k < 3; k++) {
+			for (i = 0; i < len; i++)
+				utf16 [i] = 'a' + (i % 26);
+			/* U+00E9, U+5E74 or nul, then one more ASCII char */
+			utf16 [len] = k == 0 ? 0xE9 : (k == 1 ? 0x5E74 : 0);
+			utf16 [len + 1] = 'z';
+
+			utf8_res = g_utf16_to_utf8 (utf16, len + 2, NULL, &written, NULL);
+			if (!utf8_res)
+				return FAILED ("g_utf16_to_utf8 failed for run %d, case %d", (int) len, k);
+			if (written != (k == 2 ? len : len + (k == 0 ? 2 : 3) + 1))
+				return FAILED ("g_utf16_to_utf8 wrote %d bytes for run %d, case %d", (int) written, (int) len, k);
+			for (i = 0; i < len; i++) {
+				if (utf8_res [i] != 'a' + (i % 26))
+					return FAILED ("wrong byte %d for run %d, case %d", (int) i, (int) len, k);
+			}
+
+			res = eg_utf16_to_utf8_buf (utf16, len + 2, buf, sizeof (buf));
+			if (res != written || memcmp (buf, utf8_res, written + 1))
+				return FAILED ("eg_utf16_to_utf8_buf differs for run %d, case %d", (int) len, k);
+			if (eg_utf16_to_utf8_buf (utf16, len + 2, buf, written) != -1)
+				return FAILED ("eg_utf16_to_utf8_buf overflowed for run %d, case %d", (int) len, k);
+
+			memcpy (utf8, utf8_res, written + 1);
+			g_free (utf8_res);
+
+			if (k == 2)
+				continue;
+			utf16_res = g_utf8_to_utf16 (utf8, written, NULL, &res, NULL);
+			if (!utf16_res || res != len + 2 || memcmp (utf16_res, utf16, (len + 2) * sizeof (gunichar2)))
+				return FAILED ("g_utf8_to_utf16 round trip failed for run %d, case %d", (int) len, k);
+			g_free (utf16_res);
+		}
+	}
+
+	/* Unpaired surrogate after an ASCII run */
+	for (i = 0; i < 20; i++)
+		utf16 [i] = 'a';
+	utf16 [20] = 0xD801;
+	utf16 [21] = 'a';
+	if (eg_utf16_to_utf8_buf (utf16, 22, buf, sizeof (buf)) != -1)
+		return FAILED ("eg_utf16_to_utf8_buf accepted an unpaired surrogate");
+
+	return OK;
+}
+
 /*
  * test initialization
  */
@@ -927,6 +986,7 @@ static Test utf8_tests [] = {
 	{"g_utf8_validate", test_utf8_validate },
 	{"g_utf8_strup", test_utf8_strup},
 	{"g_utf8_strdown", test_utf8_strdown},
+	{"ascii_runs", test_ascii_runs},
 	{NULL, NULL}
 };
 
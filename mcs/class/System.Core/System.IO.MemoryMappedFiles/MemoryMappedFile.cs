@@ -58,6 +58,22 @@ namespace System.IO.MemoryMappedFiles
 		[MethodImplAttribute (MethodImplOptions.InternalCall)]
 		extern static int MapInternal (IntPtr handle, long offset, ref long size, MemoryMappedFileAccess access, out IntPtr mmap_handle, out IntPtr base_address);
 
+		[MethodImplAttribute (MethodImplOptions.InternalCall)]
+		extern static bool Advise (IntPtr mmap_handle, long offset, long size, MemoryMappedViewAdvice advice);
+
+		internal static void Advise (IntPtr mmap_handle, long offset, long size, MemoryMappedViewAdvice advice, long capacity)
+		{
+			if (offset < 0 || offset > capacity)
+				throw new ArgumentOutOfRangeException ("offset");
+			if (size < 0 || offset + size > capacity)
+				throw new ArgumentOutOfRangeException ("size");
+			if (advice < MemoryMappedViewAdvice.Normal || advice > MemoryMappedViewAdvice.DontNeed)
+				throw new ArgumentOutOfRangeException ("advice");
+
+			// The advice is only a hint, so failures are ignored
+			Advise (mmap_handle, offset, size, advice);
+		}
+
 		internal static void Map (IntPtr handle, long offset, ref long size, MemoryMappedFileAccess access, out IntPtr mmap_handle, out IntPtr base_address)
 		{
 			int error = MapInternal (handle, offset, ref size, access, out mmap_handle, out base_address);
@@ -160,6 +176,16 @@ namespace System.IO.MemoryMappedFiles
 		}
 
 		public static MemoryMappedFile CreateFromFile (string path, FileMode mode, string mapName, long capacity, MemoryMappedFileAccess access)
+		{
+			return CreateFromFile (path, mode, mapName, capacity, access, MemoryMappedFileHints.None);
+		}
+
+		//
+		// Mono extension: HINTS control how the views of the file are mapped, for example
+		// MemoryMappedFileHints.Populate faults in a whole view in one go instead of one page
+		// at a time on first access.
+		//
+		public static MemoryMappedFile CreateFromFile (string path, FileMode mode, string mapName, long capacity, MemoryMappedFileAccess access, MemoryMappedFileHints hints)
 		{
 			if (path == null)
 				throw new ArgumentNullException ("path");
@@ -172,7 +198,7 @@ namespace System.IO.MemoryMappedFiles
 			if (capacity < 0)
 				throw new ArgumentOutOfRangeException ("capacity");
 
-			IntPtr handle = MemoryMapImpl.OpenFile (path, mode, mapName, out capacity, access, MemoryMappedFileOptions.DelayAllocatePages);
+			IntPtr handle = MemoryMapImpl.OpenFile (path, mode, mapName, out capacity, access, MemoryMappedFileOptions.DelayAllocatePages | (MemoryMappedFileOptions)hints);
 			
 			return new MemoryMappedFile () {
 				handle = handle,
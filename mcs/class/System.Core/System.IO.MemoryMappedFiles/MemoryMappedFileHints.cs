@@ -0,0 +1,44 @@
+//
+// MemoryMappedFileHints.cs: Mono specific hints for mapping the views of
+// a MemoryMappedFile.
+//
+// Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+//
+// Permission is hereby granted, free of charge, to any person obtaining
+// a copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+// OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+// WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+using System;
+
+namespace System.IO.MemoryMappedFiles
+{
+	//
+	// These are passed to the runtime together with the MemoryMappedFileOptions,
+	// so they must not overlap with its values. Hints which are not supported
+	// by the platform are ignored.
+	//
+	[Flags]
+	public enum MemoryMappedFileHints {
+		None = 0,
+		// Fault in all the pages of a view when it is created
+		Populate = 1,
+		// Back views with transparent huge pages where the file system allows it
+		HugePages = 2
+	}
+}
@@ -86,6 +86,19 @@ namespace System.IO.MemoryMappedFiles
 		{
 			MemoryMapImpl.Flush (mmap_handle);
 		}
+
+		//
+		// Mono extension: tell the OS how the range [offset, offset + size) of the view
+		// will be accessed. A size of 0 means up to the end of the view.
+		//
+		public void Advise (long offset, long size, MemoryMappedViewAdvice advice)
+		{
+			lock (monitor) {
+				if (mmap_handle == (IntPtr)(-1))
+					throw new ObjectDisposedException ("MemoryMappedViewStream");
+				MemoryMapImpl.Advise (mmap_handle, offset, size, advice, Capacity);
+			}
+		}
 	}
 }
 
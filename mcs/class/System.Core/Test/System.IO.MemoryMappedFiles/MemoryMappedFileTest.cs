@@ -357,6 +357,44 @@ namespace MonoTests.System.IO.MemoryMappedFiles {
 
 			stream.Write (new byte [pageSize], 0, pageSize);
 		}
+
+		[Test]
+		public void CreateFromFileWithHints ()
+		{
+			int pageSize = Environment.SystemPageSize;
+			string f = Path.Combine (tempDir, "hints-file");
+			byte[] data = new byte [pageSize * 4];
+			data [pageSize * 3 + 1] = 42;
+			File.WriteAllBytes (f, data);
+
+			using (MemoryMappedFile mappedFile = MemoryMappedFile.CreateFromFile (f, FileMode.Open, null, 0, MemoryMappedFileAccess.Read,
+										MemoryMappedFileHints.Populate | MemoryMappedFileHints.HugePages)) {
+				using (MemoryMappedViewAccessor accessor = mappedFile.CreateViewAccessor (1, 0, MemoryMappedFileAccess.Read)) {
+					accessor.Advise (0, 0, MemoryMappedViewAdvice.Sequential);
+					accessor.Advise (pageSize, pageSize, MemoryMappedViewAdvice.WillNeed);
+					Assert.AreEqual (42, accessor.ReadByte (pageSize * 3), "#1");
+				}
+				using (MemoryMappedViewStream stream = mappedFile.CreateViewStream (0, 0, MemoryMappedFileAccess.Read)) {
+					stream.Advise (0, 0, MemoryMappedViewAdvice.Random);
+					stream.Position = pageSize * 3 + 1;
+					Assert.AreEqual (42, stream.ReadByte (), "#2");
+				}
+			}
+		}
+
+		[Test]
+		[ExpectedException(typeof(ArgumentOutOfRangeException))]
+		public void AdviseOutOfRange ()
+		{
+			string f = Path.Combine (tempDir, "advise-file");
+			File.WriteAllBytes (f, new byte [8192]);
+
+			using (MemoryMappedFile mappedFile = MemoryMappedFile.CreateFromFile (f, FileMode.Open)) {
+				using (MemoryMappedViewAccessor accessor = mappedFile.CreateViewAccessor (0, 8192)) {
+					accessor.Advise (8000, 8000, MemoryMappedViewAdvice.WillNeed);
+				}
+			}
+		}
 	}
 }
 
@@ -53,6 +53,9 @@ namespace System.Net.Sockets
 		private bool islistening;
 		private bool useoverlappedIO;
 		private const int SOCKET_CLOSED = 10004;
+		// Error hit by ReceiveMessages/SendMessages after some datagrams were
+		// transferred, thrown by the next call like recvmmsg does
+		private int pending_messages_error;
 
 		private static readonly string timeout_exc_msg = "A connection attempt failed because the connected party did not properly respond after a period of time, or established connection failed because connected host has failed to respond";
 
@@ -1720,6 +1723,130 @@ namespace System.Net.Sockets
 			return cnt;
 		}
 
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		private extern static int ReceiveMessages_internal (IntPtr sock,
+								    byte[][] buffers,
+								    int[] offsets,
+								    int[] counts,
+								    SocketAddress[] sockaddrs,
+								    SocketFlags flags,
+								    out int error);
+
+		static void SplitSegments (IList<ArraySegment<byte>> buffers, out byte[][] arrays, out int[] offsets, out int[] counts)
+		{
+			int n = buffers.Count;
+
+			arrays = new byte [n][];
+			offsets = new int [n];
+			counts = new int [n];
+			for (int i = 0; i < n; i++) {
+				ArraySegment<byte> segment = buffers [i];
+
+				if (segment.Array == null)
+					throw new ArgumentNullException ("buffers");
+				arrays [i] = segment.Array;
+				offsets [i] = segment.Offset;
+				counts [i] = segment.Count;
+			}
+		}
+
+		// The icalls hand the arrays to the kernel during a blocking call, so they
+		// must not be moved by the GC in the meantime
+		static GCHandle[] PinSegments (byte[][] arrays)
+		{
+			GCHandle[] gch = new GCHandle [arrays.Length];
+			try {
+				for (int i = 0; i < arrays.Length; i++)
+					gch [i] = GCHandle.Alloc (arrays [i], GCHandleType.Pinned);
+			} catch {
+				UnpinSegments (gch);
+				throw;
+			}
+			return gch;
+		}
+
+		static void UnpinSegments (GCHandle[] gch)
+		{
+			for (int i = 0; i < gch.Length; i++) {
+				if (gch [i].IsAllocated)
+					gch [i].Free ();
+			}
+		}
+
+		void ThrowPendingMessagesError ()
+		{
+			int error = pending_messages_error;
+			if (error != 0) {
+				pending_messages_error = 0;
+				throw new SocketException (error);
+			}
+		}
+
+		// Mono extension: receives a batch of datagrams with a single system call
+		// (recvmmsg on Linux). Blocks until at least one datagram is available, then
+		// also returns the ones which are already queued. The length of each datagram
+		// is stored in lengths, and its sender in remoteEPs if that is not null.
+		// Returns the number of datagrams received.
+		public int ReceiveMessages (IList<ArraySegment<byte>> buffers, int[] lengths, EndPoint[] remoteEPs, SocketFlags socketFlags)
+		{
+			if (disposed && closed)
+				throw new ObjectDisposedException (GetType ().ToString ());
+
+			if (buffers == null)
+				throw new ArgumentNullException ("buffers");
+
+			if (lengths == null)
+				throw new ArgumentNullException ("lengths");
+
+			if (lengths.Length < buffers.Count)
+				throw new ArgumentException ("lengths");
+
+			if (remoteEPs != null && remoteEPs.Length < buffers.Count)
+				throw new ArgumentException ("remoteEPs");
+
+			ThrowPendingMessagesError ();
+
+			byte[][] arrays;
+			int[] offsets, counts;
+			SplitSegments (buffers, out arrays, out offsets, out counts);
+
+			SocketAddress[] sockaddrs = remoteEPs != null ? new SocketAddress [arrays.Length] : null;
+			int error, ret;
+			GCHandle[] gch = PinSegments (arrays);
+			try {
+				ret = ReceiveMessages_internal (socket, arrays, offsets, counts, sockaddrs, socketFlags, out error);
+			} finally {
+				UnpinSegments (gch);
+			}
+			if (error != 0 && ret > 0) {
+				// Return what was received, the error is thrown by the next call
+				pending_messages_error = error;
+				error = 0;
+			}
+			SocketError err = (SocketError) error;
+			if (err != 0) {
+				if (err != SocketError.WouldBlock && err != SocketError.InProgress)
+					connected = false;
+				else if (err == SocketError.WouldBlock && blocking) // This might happen when ReceiveTimeout is set
+					throw new SocketException ((int) SocketError.TimedOut, timeout_exc_msg);
+
+				throw new SocketException (error);
+			}
+
+			isbound = true;
+
+			Array.Copy (counts, lengths, ret);
+			if (remoteEPs != null) {
+				EndPoint template = seed_endpoint;
+				if (template == null)
+					template = new IPEndPoint (address_family == AddressFamily.InterNetworkV6 ? IPAddress.IPv6Any : IPAddress.Any, 0);
+				for (int i = 0; i < ret; i++)
+					remoteEPs [i] = sockaddrs [i] != null ? template.Create (sockaddrs [i]) : null;
+			}
+
+			return ret;
+		}
+
 		[MonoTODO ("Not implemented")]
 		public bool ReceiveMessageFromAsync (SocketAsyncEventArgs e)
 		{
@@ -1855,7 +1982,7 @@ namespace System.Net.Sockets
 		}
 
 		[MethodImplAttribute(MethodImplOptions.InternalCall)]
-		private extern static bool SendFile (IntPtr sock, string filename, byte [] pre_buffer, byte [] post_buffer, TransmitFileOptions flags);
+		private extern static bool SendFile (IntPtr sock, string filename, long offset, long count, byte [] pre_buffer, byte [] post_buffer, TransmitFileOptions flags);
 
 		public void SendFile (string fileName)
 		{
@@ -1882,7 +2009,29 @@ namespace System.Net.Sockets
 			if (!blocking)
 				throw new InvalidOperationException ();
 
-			if (!SendFile (socket, fileName, preBuffer, postBuffer, flags)) {
+			SendFile (fileName, 0, 0, preBuffer, postBuffer, flags);
+		}
+
+		// Sends count bytes of the file starting at offset, or the rest of the file if
+		// count is 0, with the buffers coalesced into full segments where the OS allows
+		public void SendFile (string fileName, long offset, long count, byte[] preBuffer, byte[] postBuffer, TransmitFileOptions flags)
+		{
+			if (disposed && closed)
+				throw new ObjectDisposedException (GetType ().ToString ());
+
+			if (!connected)
+				throw new NotSupportedException ();
+
+			if (!blocking)
+				throw new InvalidOperationException ();
+
+			if (offset < 0)
+				throw new ArgumentOutOfRangeException ("offset");
+
+			if (count < 0)
+				throw new ArgumentOutOfRangeException ("count");
+
+			if (!SendFile (socket, fileName, offset, count, preBuffer, postBuffer, flags)) {
 				SocketException exc = new SocketException ();
 				if (exc.ErrorCode == 2 || exc.ErrorCode == 3)
 					throw new FileNotFoundException ();
@@ -2013,6 +2162,73 @@ namespace System.Net.Sockets
 			return ret;
 		}
 
+		[MethodImplAttribute(MethodImplOptions.InternalCall)]
+		private extern static int SendMessages_internal (IntPtr sock,
+								 byte[][] buffers,
+								 int[] offsets,
+								 int[] counts,
+								 SocketAddress[] sockaddrs,
+								 SocketFlags flags,
+								 out int error);
+
+		// Mono extension: sends a batch of datagrams with a single system call
+		// (sendmmsg on Linux), each to the corresponding endpoint in remoteEPs, or
+		// to the connected peer if remoteEPs is null. Returns the number of
+		// datagrams sent, which can be less than buffers.Count.
+		public int SendMessages (IList<ArraySegment<byte>> buffers, EndPoint[] remoteEPs, SocketFlags socketFlags)
+		{
+			if (disposed && closed)
+				throw new ObjectDisposedException (GetType ().ToString ());
+
+			if (buffers == null)
+				throw new ArgumentNullException ("buffers");
+
+			if (remoteEPs != null && remoteEPs.Length < buffers.Count)
+				throw new ArgumentException ("remoteEPs");
+
+			ThrowPendingMessagesError ();
+
+			byte[][] arrays;
+			int[] offsets, counts;
+			SplitSegments (buffers, out arrays, out offsets, out counts);
+
+			SocketAddress[] sockaddrs = null;
+			if (remoteEPs != null) {
+				sockaddrs = new SocketAddress [arrays.Length];
+				for (int i = 0; i < arrays.Length; i++) {
+					if (remoteEPs [i] == null)
+						throw new ArgumentNullException ("remoteEPs");
+					sockaddrs [i] = remoteEPs [i].Serialize ();
+				}
+			}
+
+			int error, ret;
+			GCHandle[] gch = PinSegments (arrays);
+			try {
+				ret = SendMessages_internal (socket, arrays, offsets, counts, sockaddrs, socketFlags, out error);
+			} finally {
+				UnpinSegments (gch);
+			}
+			if (error != 0 && ret > 0) {
+				// Return what was sent, the error is thrown by the next call
+				pending_messages_error = error;
+				error = 0;
+			}
+			SocketError err = (SocketError) error;
+			if (err != 0) {
+				if (err != SocketError.WouldBlock && err != SocketError.InProgress)
+					connected = false;
+
+				throw new SocketException (error);
+			}
+
+			isbound = true;
+			if (remoteEPs != null && ret > 0)
+				seed_endpoint = remoteEPs [0];
+
+			return ret;
+		}
+
 		public void SetSocketOption (SocketOptionLevel optionLevel, SocketOptionName optionName, byte [] optionValue)
 		{
 			if (disposed && closed)
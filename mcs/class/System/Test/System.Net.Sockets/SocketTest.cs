@@ -4244,6 +4244,90 @@ namespace MonoTests.System.Net.Sockets
 			}
 		}
 		
+		[Test]
+		public void SendFileRange ()
+		{
+			var buffer = new byte [4096];
+			for (int i = 0; i < buffer.Length; ++i)
+				buffer [i] = (byte) (i % 251);
+
+			string temp = Path.GetTempFileName ();
+			try {
+				File.WriteAllBytes (temp, buffer);
+
+				using (Socket listener = new Socket (AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp)) {
+					listener.Bind (new IPEndPoint (IPAddress.Loopback, 0));
+					listener.Listen (1);
+
+					using (Socket client = new Socket (AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp)) {
+						client.Connect (listener.LocalEndPoint);
+						using (Socket server = listener.Accept ()) {
+							byte[] head = new byte [] { 1, 2, 3 };
+							byte[] tail = new byte [] { 4, 5 };
+							client.SendFile (temp, 1000, 500, head, tail, TransmitFileOptions.UseDefaultWorkerThread);
+							client.Shutdown (SocketShutdown.Send);
+
+							var received = new MemoryStream ();
+							var buf = new byte [1024];
+							int n;
+							while ((n = server.Receive (buf)) > 0)
+								received.Write (buf, 0, n);
+
+							byte[] data = received.ToArray ();
+							Assert.AreEqual (505, data.Length, "#1");
+							Assert.AreEqual (1, data [0], "#2");
+							for (int i = 0; i < 500; ++i)
+								Assert.AreEqual (buffer [1000 + i], data [3 + i], "#3:" + i);
+							Assert.AreEqual (5, data [504], "#4");
+						}
+					}
+				}
+			} finally {
+				File.Delete (temp);
+			}
+		}
+
+		[Test]
+		public void SendMessages_ReceiveMessages ()
+		{
+			using (Socket receiver = new Socket (AddressFamily.InterNetwork, SocketType.Dgram, ProtocolType.Udp))
+			using (Socket sender = new Socket (AddressFamily.InterNetwork, SocketType.Dgram, ProtocolType.Udp)) {
+				receiver.Bind (new IPEndPoint (IPAddress.Loopback, 0));
+				sender.Bind (new IPEndPoint (IPAddress.Loopback, 0));
+
+				var outgoing = new List<ArraySegment<byte>> ();
+				var targets = new EndPoint [3];
+				for (int i = 0; i < 3; i++) {
+					outgoing.Add (new ArraySegment<byte> (new byte [] { 0, (byte) i, (byte) i, 0 }, 1, i + 1));
+					targets [i] = receiver.LocalEndPoint;
+				}
+				Assert.AreEqual (3, sender.SendMessages (outgoing, targets, SocketFlags.None), "#1");
+
+				var incoming = new List<ArraySegment<byte>> ();
+				for (int i = 0; i < 4; i++)
+					incoming.Add (new ArraySegment<byte> (new byte [16], 2, 8));
+				int[] lengths = new int [4];
+				EndPoint[] senders = new EndPoint [4];
+				int received = 0;
+				while (received < 3) {
+					var rest = incoming.GetRange (received, 4 - received);
+					int[] rest_lengths = new int [rest.Count];
+					EndPoint[] rest_senders = new EndPoint [rest.Count];
+					int n = receiver.ReceiveMessages (rest, rest_lengths, rest_senders, SocketFlags.None);
+					Assert.IsTrue (n > 0, "#2");
+					Array.Copy (rest_lengths, 0, lengths, received, n);
+					Array.Copy (rest_senders, 0, senders, received, n);
+					received += n;
+				}
+
+				for (int i = 0; i < 3; i++) {
+					Assert.AreEqual (i + 1, lengths [i], "#3:" + i);
+					Assert.AreEqual ((byte) i, incoming [i].Array [2], "#4:" + i);
+					Assert.AreEqual (sender.LocalEndPoint, senders [i], "#5:" + i);
+				}
+			}
+		}
+
 		Socket StartSocketServer ()
 		{
 
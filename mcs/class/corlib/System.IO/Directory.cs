@@ -491,6 +491,12 @@ namespace System.IO
 				return new string [] { path_with_pattern };
 
 			MonoIOError error;
+			if (MonoIO.IsMatchAllPattern (searchPattern) && (mask & ~FileAttributes.Directory) == 0) {
+				IntPtr handle = MonoIO.OpenDirectory (path, out error);
+				if (handle != IntPtr.Zero)
+					return ReadDirectoryEntries (path, handle, mask, attrs);
+			}
+
 			string [] result = MonoIO.GetFileSystemEntries (path, path_with_pattern, (int) attrs, (int) mask, out error);
 			if (error != 0)
 				throw MonoIO.GetException (Path.GetDirectoryName (Path.Combine (path, searchPattern)), error);
@@ -504,6 +510,32 @@ namespace System.IO
 			return new List<string> (EnumerateFileSystemEntries (path, searchPattern, searchOption)).ToArray ();
 		}
 
+		const int DirectoryBatchSize = 256;
+
+		static string [] ReadDirectoryEntries (string path, IntPtr handle, FileAttributes mask, FileAttributes attrs)
+		{
+			var result = new List<string> ();
+			var names = new string [DirectoryBatchSize];
+			var rattrs = new FileAttributes [DirectoryBatchSize];
+			MonoIOError error;
+			int count;
+
+			try {
+				while ((count = MonoIO.ReadDirectory (handle, names, rattrs, out error)) > 0) {
+					for (int i = 0; i < count; ++i) {
+						if ((rattrs [i] & mask) == attrs)
+							result.Add (names [i]);
+					}
+				}
+			} finally {
+				MonoIO.CloseDirectory (handle);
+			}
+
+			if (error != 0)
+				throw MonoIO.GetException (path, error);
+			return result.ToArray ();
+		}
+
 		static void EnumerateCheck (string path, string searchPattern, SearchOption searchOption)
 		{
 			if (searchPattern == null)
@@ -534,6 +566,16 @@ namespace System.IO
 			IntPtr handle;
 			MonoIOError error;
 			FileAttributes rattr;
+
+			if (MonoIO.IsMatchAllPattern (searchPattern)) {
+				handle = MonoIO.OpenDirectory (path, out error);
+				if (handle != IntPtr.Zero) {
+					foreach (string entry in EnumerateKindStreaming (path, handle, searchPattern, searchOption, kind))
+						yield return entry;
+					yield break;
+				}
+			}
+
 			string s = MonoIO.FindFirst (path, path_with_pattern, out rattr, out error, out handle);
 			try {
 				while (s != null) {
@@ -574,6 +616,47 @@ namespace System.IO
 			}
 		}
 
+		// Lists the directory in one pass, and only recurses into the subdirectories
+		// once the directory itself has been enumerated, like EnumerateKind
+		static IEnumerable<string> EnumerateKindStreaming (string path, IntPtr handle, string searchPattern, SearchOption searchOption, FileAttributes kind)
+		{
+			var names = new string [DirectoryBatchSize];
+			var attrs = new FileAttributes [DirectoryBatchSize];
+			List<string> subdirs = null;
+			MonoIOError error;
+			int count;
+
+			try {
+				while ((count = MonoIO.ReadDirectory (handle, names, attrs, out error)) > 0) {
+					for (int i = 0; i < count; ++i) {
+						FileAttributes rattr = attrs [i];
+						if (((rattr & FileAttributes.Directory) == 0) && rattr != 0)
+							rattr |= FileAttributes.Normal;
+
+						if ((rattr & kind) != 0)
+							yield return names [i];
+
+						if (searchOption == SearchOption.AllDirectories && (rattr & FileAttributes.Directory) != 0 && (rattr & FileAttributes.ReparsePoint) == 0) {
+							if (subdirs == null)
+								subdirs = new List<string> ();
+							subdirs.Add (names [i]);
+						}
+					}
+				}
+
+				if (error != 0)
+					throw MonoIO.GetException (path, error);
+			} finally {
+				MonoIO.CloseDirectory (handle);
+			}
+
+			if (subdirs != null) {
+				foreach (string subdir in subdirs)
+					foreach (string child in EnumerateKind (subdir, searchPattern, searchOption, kind))
+						yield return child;
+			}
+		}
+
 		public static IEnumerable<string> EnumerateDirectories (string path, string searchPattern, SearchOption searchOption)
 		{
 			EnumerateCheck (path, searchPattern, searchOption);
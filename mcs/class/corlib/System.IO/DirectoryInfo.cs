@@ -432,6 +432,15 @@ namespace System.IO {
 			bool subdirs = searchOption == SearchOption.AllDirectories;
 
 			Path.Validate (full);
+
+			if (MonoIO.IsMatchAllPattern (searchPattern)) {
+				handle = MonoIO.OpenDirectory (full, out error);
+				if (handle != IntPtr.Zero) {
+					foreach (FileSystemInfo info in EnumerateFileSystemInfosStreaming (full, handle, searchPattern, subdirs))
+						yield return info;
+					yield break;
+				}
+			}
 			
 			string s = MonoIO.FindFirst (full, path_with_pattern, out rattr, out error, out handle);
 			if (s == null)
@@ -457,6 +466,40 @@ namespace System.IO {
 				MonoIO.FindClose (handle);
 			}
 		}
+
+		// The FileSystemInfo objects only stat the entries when their attributes are used
+		static IEnumerable<FileSystemInfo> EnumerateFileSystemInfosStreaming (string full, IntPtr handle, string searchPattern, bool subdirs)
+		{
+			var names = new string [256];
+			var attrs = new FileAttributes [256];
+			MonoIOError error;
+			int count;
+
+			try {
+				while ((count = MonoIO.ReadDirectory (handle, names, attrs, out error)) > 0) {
+					for (int i = 0; i < count; ++i) {
+						FileAttributes rattr = attrs [i];
+						string s = names [i];
+
+						if (((rattr & FileAttributes.ReparsePoint) == 0)){
+							if ((rattr & FileAttributes.Directory) != 0)
+								yield return new DirectoryInfo (s);
+							else
+								yield return new FileInfo (s);
+						}
+
+						if (((rattr & FileAttributes.Directory) != 0) && subdirs)
+							foreach (FileSystemInfo child in EnumerateFileSystemInfos (s, searchPattern, SearchOption.AllDirectories))
+								yield return child;
+					}
+				}
+
+				if (error != 0)
+					throw MonoIO.GetException (full, error);
+			} finally {
+				MonoIO.CloseDirectory (handle);
+			}
+		}
 		
 		
 	}
@@ -577,6 +577,10 @@ namespace System.IO
 			if (!async)
 				return base.BeginRead (array, offset, numBytes, userCallback, stateObject);
 
+			IAsyncResult result = BeginAsyncIO (array, offset, numBytes, false, userCallback, stateObject);
+			if (result != null)
+				return result;
+
 			ReadDelegate r = new ReadDelegate (ReadInternal);
 			return r.BeginInvoke (array, offset, numBytes, userCallback, stateObject);
 		}
@@ -589,6 +593,10 @@ namespace System.IO
 			if (!async)
 				return base.EndRead (asyncResult);
 
+			FileStreamAsyncResult fsares = asyncResult as FileStreamAsyncResult;
+			if (fsares != null)
+				return EndAsyncIO (fsares);
+
 			AsyncResult ares = asyncResult as AsyncResult;
 			if (ares == null)
 				throw new ArgumentException ("Invalid IAsyncResult", "asyncResult");
@@ -688,6 +696,10 @@ namespace System.IO
 			if (!async)
 				return base.BeginWrite (array, offset, numBytes, userCallback, stateObject);
 
+			IAsyncResult async_result = BeginAsyncIO (array, offset, numBytes, true, userCallback, stateObject);
+			if (async_result != null)
+				return async_result;
+
 			FileStreamAsyncResult result = new FileStreamAsyncResult (userCallback, stateObject);
 			result.BytesRead = -1;
 			result.Count = numBytes;
@@ -718,6 +730,12 @@ namespace System.IO
 				return;
 			}
 
+			FileStreamAsyncResult fsares = asyncResult as FileStreamAsyncResult;
+			if (fsares != null) {
+				EndAsyncIO (fsares);
+				return;
+			}
+
 			AsyncResult ares = asyncResult as AsyncResult;
 			if (ares == null)
 				throw new ArgumentException ("Invalid IAsyncResult", "asyncResult");
@@ -730,6 +748,104 @@ namespace System.IO
 			return;
 		}
 
+		static readonly WaitCallback async_io_completed = AsyncIOCompleted;
+
+		// Submits the read or write to the runtime, which completes it without blocking a
+		// threadpool thread where the OS allows it (io_uring on Linux). Returns null if that
+		// is not possible, the caller then falls back to doing the I/O on a threadpool thread.
+		IAsyncResult BeginAsyncIO (byte [] array, int offset, int numBytes, bool write,
+					   AsyncCallback userCallback, object stateObject)
+		{
+			// The request is done at an explicit position, so only when no buffered data
+			// would have to be read or written first
+			if (!canseek || isExposed || buf_dirty || buf_offset != buf_length)
+				return null;
+
+			MonoIOError error;
+			long position = buf_start + buf_offset;
+			if (!write) {
+				// Like overlapped I/O on Windows, don't read past the end of the file, so
+				// the position can be moved past the request right away
+				long length = MonoIO.GetLength (safeHandle, out error);
+				if (error != MonoIOError.ERROR_SUCCESS)
+					return null;
+				if (position + numBytes > length)
+					numBytes = (int) Math.Max (0, length - position);
+			}
+
+			FileStreamAsyncResult result = new FileStreamAsyncResult (userCallback, stateObject);
+			result.Buffer = array;
+			result.Offset = offset;
+			result.Count = numBytes;
+			result.OriginalCount = numBytes;
+
+			if (numBytes == 0) {
+				result.SetComplete (null, 0, true);
+				return result;
+			}
+
+			MonoIOAsyncRequest request = new MonoIOAsyncRequest ();
+			request.Stream = this;
+			request.Result = result;
+			request.Write = write;
+			request.Offset = offset;
+			request.Count = numBytes;
+			request.Position = position;
+			if (!MonoIO.SubmitAsync (safeHandle, array, offset, numBytes, position, write, request, async_io_completed))
+				return null;
+
+			buf_start = MonoIO.Seek (safeHandle, position + numBytes, SeekOrigin.Begin, out error);
+			buf_offset = buf_length = 0;
+			if (error != MonoIOError.ERROR_SUCCESS)
+				throw MonoIO.GetException (GetSecureFileName (name), error);
+
+			return result;
+		}
+
+		static void AsyncIOCompleted (object state)
+		{
+			MonoIOAsyncRequest request = (MonoIOAsyncRequest) state;
+			FileStreamAsyncResult result = request.Result;
+			Exception exc = null;
+
+			try {
+				if (request.Error != MonoIOError.ERROR_SUCCESS) {
+					exc = MonoIO.GetException (request.Stream.GetSecureFileName (request.Stream.name), request.Error);
+				} else if (request.Write && request.BytesTransferred < request.Count) {
+					// Writes can be short, submit the rest, the next completion reports
+					// the error which stopped this one if there was one
+					if (request.BytesTransferred > 0) {
+						request.Offset += request.BytesTransferred;
+						request.Count -= request.BytesTransferred;
+						request.Position += request.BytesTransferred;
+						if (MonoIO.SubmitAsync (request.Handle, result.Buffer, request.Offset, request.Count, request.Position, true, request, async_io_completed))
+							return;
+					}
+					exc = new IOException ("Unable to write all the data to " + request.Stream.GetSecureFileName (request.Stream.name));
+				}
+			} finally {
+				// Each submission holds its own reference
+				request.Handle.DangerousRelease ();
+			}
+
+			result.SetComplete (exc, request.Offset - result.Offset + request.BytesTransferred);
+		}
+
+		int EndAsyncIO (FileStreamAsyncResult result)
+		{
+			if (result.Done)
+				throw new InvalidOperationException ("EndRead or EndWrite already called.");
+			result.Done = true;
+
+			if (!result.IsCompleted)
+				result.AsyncWaitHandle.WaitOne ();
+
+			if (result.Exception != null)
+				throw result.Exception;
+
+			return result.BytesRead;
+		}
+
 		public override long Seek (long offset, SeekOrigin origin)
 		{
 			long pos;
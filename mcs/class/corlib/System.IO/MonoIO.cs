@@ -229,6 +229,24 @@ namespace System.IO
 		
 		[MethodImplAttribute (MethodImplOptions.InternalCall)]
 		public extern static int FindClose (IntPtr handle);
+
+		//
+		// Streaming directory reading, which doesn't support patterns.
+		// OpenDirectory returns IntPtr.Zero where it is not available.
+		//
+		[MethodImplAttribute (MethodImplOptions.InternalCall)]
+		public extern static IntPtr OpenDirectory (string path, out MonoIOError error);
+
+		[MethodImplAttribute (MethodImplOptions.InternalCall)]
+		public extern static int ReadDirectory (IntPtr handle, string [] names, FileAttributes [] attrs, out MonoIOError error);
+
+		[MethodImplAttribute (MethodImplOptions.InternalCall)]
+		public extern static void CloseDirectory (IntPtr handle);
+
+		public static bool IsMatchAllPattern (string searchPattern)
+		{
+			return searchPattern == "*" || searchPattern == "*.*";
+		}
 		
 		public static bool Exists (string path, out MonoIOError error)
 		{
@@ -344,6 +362,35 @@ namespace System.IO
 			}
 		}
 		
+		[MethodImplAttribute (MethodImplOptions.InternalCall)]
+		private extern static bool SubmitAsync (IntPtr handle, byte [] buffer,
+							int offset, int count, long position,
+							bool write, MonoIOAsyncRequest request,
+							WaitCallback callback);
+
+		// Starts an asynchronous read or write at position, without using the file pointer.
+		// Once it completes, callback is invoked with request on a threadpool thread.
+		// Returns false if the runtime can't do asynchronous I/O on this handle, in which
+		// case the caller has to do the I/O synchronously.
+		public static bool SubmitAsync (SafeHandle safeHandle, byte [] buffer,
+						int offset, int count, long position,
+						bool write, MonoIOAsyncRequest request,
+						WaitCallback callback)
+		{
+			bool release = false;
+			bool submitted = false;
+			try {
+				// The reference is released by the completion callback
+				safeHandle.DangerousAddRef (ref release);
+				request.Handle = safeHandle;
+				submitted = SubmitAsync (safeHandle.DangerousGetHandle (), buffer, offset, count, position, write, request, callback);
+				return submitted;
+			} finally {
+				if (release && !submitted)
+					safeHandle.DangerousRelease ();
+			}
+		}
+
 		[MethodImplAttribute (MethodImplOptions.InternalCall)]
 		private extern static long Seek (IntPtr handle, long offset,
 						SeekOrigin origin,
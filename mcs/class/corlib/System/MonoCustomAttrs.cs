@@ -304,6 +304,8 @@ namespace System
 				throw new ArgumentNullException ("attributeType");
 
 			AttributeUsageAttribute usage = null;
+			// Pseudo custom attributes are all defined in corlib, avoid creating them for other types
+			bool check_pseudo = attributeType.Assembly == typeof (object).Assembly;
 			do {
 				if (IsUserCattrProvider (obj))
 					return obj.IsDefined (attributeType, inherit);
@@ -311,11 +313,13 @@ namespace System
 				if (IsDefinedInternal (obj, attributeType))
 					return true;
 
-				object[] pseudoAttrs = GetPseudoCustomAttributes (obj, attributeType);
-				if (pseudoAttrs != null) {
-					for (int i = 0; i < pseudoAttrs.Length; ++i)
-						if (attributeType.IsAssignableFrom (pseudoAttrs[i].GetType ()))
-							return true;
+				if (check_pseudo) {
+					object[] pseudoAttrs = GetPseudoCustomAttributes (obj, attributeType);
+					if (pseudoAttrs != null) {
+						for (int i = 0; i < pseudoAttrs.Length; ++i)
+							if (attributeType.IsAssignableFrom (pseudoAttrs[i].GetType ()))
+								return true;
+					}
 				}
 
 				if (usage == null) {
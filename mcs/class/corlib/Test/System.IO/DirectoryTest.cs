@@ -93,6 +93,42 @@ public class DirectoryTest
 		Assert.AreEqual (cdir, files3 [2], "#4.d");
 #endif
 	}
+
+	[Test]
+	public void EnumerateAllEntries ()
+	{
+		if (!RunningOnUnix)
+			Assert.Ignore ("Not running on Unix.");
+
+		var subdir = Path.Combine (TempFolder, "subdir");
+		var linkdir = Path.Combine (TempFolder, "linkdir");
+		Directory.CreateDirectory (subdir);
+		new UnixFileInfo (subdir).CreateSymbolicLink (linkdir);
+		// More entries than are read from the runtime at once
+		for (int i = 0; i < 300; i++)
+			File.WriteAllText (Path.Combine (TempFolder, "file" + i), "");
+		File.WriteAllText (Path.Combine (subdir, ".hidden"), "");
+
+		try {
+			Assert.AreEqual (300, Directory.GetFiles (TempFolder).Length, "#1");
+			Assert.AreEqual (302, Directory.GetFileSystemEntries (TempFolder).Length, "#2");
+
+			var dirs = Directory.GetDirectories (TempFolder);
+			Array.Sort (dirs);
+			Assert.AreEqual (2, dirs.Length, "#3");
+			Assert.AreEqual (linkdir, dirs [0], "#4");
+			Assert.AreEqual (subdir, dirs [1], "#5");
+
+#if NET_4_0
+			var files = new List<string> (Directory.EnumerateFiles (TempFolder, "*", SearchOption.AllDirectories));
+			Assert.AreEqual (301, files.Count, "#6");
+			Assert.IsTrue (files.Contains (Path.Combine (subdir, ".hidden")), "#7");
+			Assert.IsFalse (files.Contains (Path.Combine (linkdir, ".hidden")), "#8");
+#endif
+		} finally {
+			new UnixSymbolicLinkInfo (linkdir).Delete ();
+		}
+	}
 #endif
 	[Test]
 	public void CreateDirectory ()
@@ -0,0 +1,61 @@
+using System;
+using System.Diagnostics;
+using System.Reflection;
+
+/*
+ * Repeated custom attribute queries on the same members, as done by frameworks
+ * which dispatch on attributes: GetCustomAttributes on a method and IsDefined
+ * on a type.
+ */
+[AttributeUsage (AttributeTargets.All)]
+public class RouteAttribute : Attribute {
+	public RouteAttribute (string path) {
+		Path = path;
+	}
+
+	public string Path;
+	public int Order { get; set; }
+}
+
+[Serializable]
+[Route ("/controller")]
+public class Test {
+
+	[Route ("/action", Order = 1)]
+	[Obsolete]
+	public void Action () {
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		MethodInfo action = typeof (Test).GetMethod ("Action");
+		int count = repeat * 200000;
+		int found = 0;
+
+		Stopwatch sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++) {
+			object[] attrs = action.GetCustomAttributes (typeof (RouteAttribute), false);
+			found += ((RouteAttribute)attrs [0]).Order;
+		}
+		sw.Stop ();
+		Console.WriteLine ("GetCustomAttributes: {0} ms, {1:F1} ns/call", sw.ElapsedMilliseconds,
+				   sw.Elapsed.TotalMilliseconds * 1000000 / count);
+
+		sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++) {
+			if (typeof (Test).IsDefined (typeof (RouteAttribute), false))
+				found ++;
+		}
+		sw.Stop ();
+		Console.WriteLine ("IsDefined: {0} ms, {1:F1} ns/call", sw.ElapsedMilliseconds,
+				   sw.Elapsed.TotalMilliseconds * 1000000 / count);
+
+		return found == count * 2 ? 0 : 1;
+	}
+}
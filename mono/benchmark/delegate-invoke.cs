@@ -0,0 +1,93 @@
+using System;
+using System.Reflection;
+
+/*
+ * Creating short-lived delegates and invoking each of them a few times, the way
+ * event handlers and callbacks are used. The first invocation of each delegate
+ * is the interesting part, the later ones should be a plain indirect call.
+ */
+public class Test {
+
+	delegate int Handler (int a);
+
+	int val;
+
+	public Test (int val) {
+		this.val = val;
+	}
+
+	int Add (int a) {
+		return a + val;
+	}
+
+	static int Twice (int a) {
+		return a * 2;
+	}
+
+	const int Iterations = 2000000;
+
+	static void Report (string name, DateTime start, int count, int res) {
+		TimeSpan elapsed = DateTime.Now - start;
+
+		Console.WriteLine ("{0,-22} {1,8:F1} ns/delegate ({2})", name, elapsed.TotalMilliseconds * 1000000 / count, res);
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+		int res, n;
+		DateTime start;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+
+		Console.WriteLine ("Repeat = " + repeat);
+		n = Iterations * repeat;
+
+		Test t = new Test (1);
+		MethodInfo add = typeof (Test).GetMethod ("Add", BindingFlags.Instance | BindingFlags.NonPublic);
+		MethodInfo twice = typeof (Test).GetMethod ("Twice", BindingFlags.Static | BindingFlags.NonPublic);
+
+		res = 0;
+		start = DateTime.Now;
+		for (int i = 0; i < n; i++) {
+			Handler h = new Handler (t.Add);
+			res = h (h (res));
+		}
+		Report ("closed", start, n, res);
+
+		res = 0;
+		start = DateTime.Now;
+		for (int i = 0; i < n; i++) {
+			Handler h = new Handler (Twice);
+			res = h (h (i)) & 0xffff;
+		}
+		Report ("static", start, n, res);
+
+		res = 0;
+		start = DateTime.Now;
+		for (int i = 0; i < n / 4; i++) {
+			Handler h = (Handler)Delegate.CreateDelegate (typeof (Handler), t, add);
+			res = h (h (res));
+		}
+		Report ("CreateDelegate", start, n / 4, res);
+
+		res = 0;
+		start = DateTime.Now;
+		for (int i = 0; i < n / 4; i++) {
+			Handler h = (Handler)Delegate.CreateDelegate (typeof (Handler), twice);
+			res = h (h (i)) & 0xffff;
+		}
+		Report ("CreateDelegate static", start, n / 4, res);
+
+		res = 0;
+		start = DateTime.Now;
+		for (int i = 0; i < n / 4; i++) {
+			Handler h = new Handler (t.Add);
+			h += Twice;
+			res = h (res) & 0xffff;
+		}
+		Report ("multicast", start, n / 4, res);
+
+		return 0;
+	}
+}
@@ -0,0 +1,99 @@
+using System;
+using System.Runtime.CompilerServices;
+
+/*
+ * Throwing and catching exceptions, caught in the throwing method or a few frames
+ * up the stack. The stack trace is only read in the last case, so the other ones
+ * measure the cost of the throw alone.
+ */
+public class Test {
+
+	static Exception exc = new FormatException ();
+
+	const int Iterations = 200000;
+
+	static int CatchLocal (int i) {
+		try {
+			if (i >= 0)
+				throw new FormatException ();
+		} catch (FormatException) {
+			return 1;
+		}
+		return 0;
+	}
+
+	static int CatchLocalPreallocated (int i) {
+		try {
+			if (i >= 0)
+				throw exc;
+		} catch (FormatException) {
+			return 1;
+		}
+		return 0;
+	}
+
+	[MethodImpl(MethodImplOptions.NoInlining)]
+	static void Throw (int depth) {
+		if (depth == 0)
+			throw new FormatException ();
+		Throw (depth - 1);
+	}
+
+	static int CatchDeep (int depth) {
+		try {
+			Throw (depth);
+		} catch (FormatException) {
+			return 1;
+		}
+		return 0;
+	}
+
+	static int CatchDeepTrace (int depth) {
+		try {
+			Throw (depth);
+		} catch (FormatException e) {
+			return e.StackTrace.Length > 0 ? 1 : 0;
+		}
+		return 0;
+	}
+
+	static void Report (string name, DateTime start, int count) {
+		TimeSpan elapsed = DateTime.Now - start;
+
+		Console.WriteLine ("{0,-24} {1,8:F2} us/throw", name, elapsed.TotalMilliseconds * 1000 / count);
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+		int n, res = 0;
+		DateTime start;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+
+		Console.WriteLine ("Repeat = " + repeat);
+		n = Iterations * repeat;
+
+		start = DateTime.Now;
+		for (int i = 0; i < n; i++)
+			res += CatchLocal (i);
+		Report ("same frame", start, n);
+
+		start = DateTime.Now;
+		for (int i = 0; i < n; i++)
+			res += CatchLocalPreallocated (i);
+		Report ("same frame, preallocated", start, n);
+
+		start = DateTime.Now;
+		for (int i = 0; i < n / 4; i++)
+			res += CatchDeep (10);
+		Report ("10 frames", start, n / 4);
+
+		start = DateTime.Now;
+		for (int i = 0; i < n / 4; i++)
+			res += CatchDeepTrace (10);
+		Report ("10 frames, StackTrace", start, n / 4);
+
+		return res == n + n / 2 ? 0 : 1;
+	}
+}
@@ -0,0 +1,87 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Threading;
+
+/*
+ * Random 4K reads through FileStream.BeginRead on a file opened with
+ * FileOptions.Asynchronous, keeping 1 to 256 requests in flight. Reports the
+ * achieved IOPS and the peak thread count of the process for each queue depth.
+ */
+public class Test {
+
+	const int BlockSize = 4096;
+	const int FileBlocks = 16384;
+
+	static FileStream fs;
+	static Random random = new Random (42);
+	static int remaining;
+	static int outstanding;
+	static int peak_threads;
+	static ManualResetEvent done = new ManualResetEvent (false);
+
+	static void Issue (byte[] buf) {
+		lock (fs) {
+			fs.Seek ((long)random.Next (FileBlocks) * BlockSize, SeekOrigin.Begin);
+			fs.BeginRead (buf, 0, BlockSize, Completed, buf);
+		}
+	}
+
+	static void Completed (IAsyncResult ares) {
+		byte[] buf = (byte[])ares.AsyncState;
+
+		if (fs.EndRead (ares) != BlockSize)
+			throw new Exception ("short read");
+
+		if (Interlocked.Decrement (ref remaining) >= 0)
+			Issue (buf);
+		else if (Interlocked.Decrement (ref outstanding) == 0)
+			done.Set ();
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+
+		Console.WriteLine ("Repeat = " + repeat);
+
+		string path = Path.GetTempFileName ();
+		try {
+			using (FileStream w = new FileStream (path, FileMode.Create)) {
+				byte[] block = new byte [BlockSize];
+				for (int i = 0; i < FileBlocks; ++i)
+					w.Write (block, 0, BlockSize);
+			}
+
+			fs = new FileStream (path, FileMode.Open, FileAccess.Read, FileShare.Read, 1, FileOptions.Asynchronous);
+			Process self = Process.GetCurrentProcess ();
+
+			for (int depth = 1; depth <= 256; depth *= 2) {
+				int requests = repeat * 20000;
+
+				remaining = requests - depth;
+				outstanding = depth;
+				peak_threads = 0;
+				done.Reset ();
+
+				Stopwatch sw = Stopwatch.StartNew ();
+				for (int i = 0; i < depth; ++i)
+					Issue (new byte [BlockSize]);
+				while (!done.WaitOne (10)) {
+					self.Refresh ();
+					peak_threads = Math.Max (peak_threads, self.Threads.Count);
+				}
+				sw.Stop ();
+
+				Console.WriteLine ("QD {0,3}: {1,8:0} IOPS, peak threads {2}", depth,
+						   requests / sw.Elapsed.TotalSeconds, peak_threads);
+			}
+			fs.Close ();
+		} finally {
+			File.Delete (path);
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,72 @@
+using System;
+
+/*
+ * Array.Copy and Array.Clear on arrays of longs and of references, from 8 bytes
+ * to a few megabytes. The runtime implements these with the GC-safe memmove and
+ * bzero primitives, which must not tear pointer-sized slots.
+ */
+public class Test {
+
+	const long TotalBytes = 1L << 30;
+
+	static void Report (string what, int bytes, int iterations, DateTime start) {
+		TimeSpan elapsed = DateTime.Now - start;
+
+		Console.WriteLine ("{0,-14} {1,8} bytes: {2,8:F0} MB/s", what, bytes,
+				   (double)bytes * iterations / (1024 * 1024) / elapsed.TotalSeconds);
+	}
+
+	static void Run (int bytes, int repeat) {
+		int longs = bytes / 8;
+		int refs = bytes / IntPtr.Size;
+		int iterations = (int)Math.Max (1, TotalBytes * repeat / bytes / 8);
+		long[] la = new long [longs + 1];
+		object[] oa = new object [refs + 1];
+		object o = new object ();
+		DateTime start;
+
+		for (int i = 0; i < la.Length; i++)
+			la [i] = i;
+		for (int i = 0; i < oa.Length; i++)
+			oa [i] = o;
+
+		/* Overlapping moves by one element, in both directions */
+		start = DateTime.Now;
+		for (int i = 0; i < iterations; i++) {
+			Array.Copy (la, 0, la, 1, longs);
+			Array.Copy (la, 1, la, 0, longs);
+		}
+		Report ("copy long[]", bytes, iterations * 2, start);
+
+		start = DateTime.Now;
+		for (int i = 0; i < iterations; i++) {
+			Array.Copy (oa, 0, oa, 1, refs);
+			Array.Copy (oa, 1, oa, 0, refs);
+		}
+		Report ("copy object[]", bytes, iterations * 2, start);
+
+		start = DateTime.Now;
+		for (int i = 0; i < iterations; i++)
+			Array.Clear (la, 0, longs);
+		Report ("clear long[]", bytes, iterations, start);
+
+		start = DateTime.Now;
+		for (int i = 0; i < iterations; i++)
+			Array.Clear (oa, 0, refs);
+		Report ("clear object[]", bytes, iterations, start);
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		for (int bytes = 8; bytes <= 4 * 1024 * 1024; bytes *= 4)
+			Run (bytes, repeat);
+
+		return 0;
+	}
+}
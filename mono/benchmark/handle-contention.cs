@@ -0,0 +1,85 @@
+using System;
+using System.Threading;
+
+/*
+ * Several threads creating and closing wait handles at the same time, which
+ * exercises handle allocation in the io-layer, followed by WaitHandle.WaitAny
+ * calls on a set of events signalled from other threads.
+ */
+public class Test {
+
+	const int NumThreads = 4;
+	const int NumEvents = 8;
+
+	static int count;
+	static AutoResetEvent[] events;
+	static volatile bool done;
+
+	static void CreateClose () {
+		for (int i = 0; i < count; i++) {
+			ManualResetEvent e = new ManualResetEvent (false);
+			e.Close ();
+		}
+	}
+
+	static void Signal (object o) {
+		int first = (int)o;
+
+		while (!done) {
+			for (int i = first; i < NumEvents; i += 2)
+				events [i].Set ();
+			Thread.Sleep (0);
+		}
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		count = repeat * 100000;
+
+		Thread[] threads = new Thread [NumThreads];
+		DateTime start = DateTime.Now;
+		for (int i = 0; i < NumThreads; i++) {
+			threads [i] = new Thread (CreateClose);
+			threads [i].Start ();
+		}
+		for (int i = 0; i < NumThreads; i++)
+			threads [i].Join ();
+		TimeSpan elapsed = DateTime.Now - start;
+
+		Console.WriteLine ("{0} handles created and closed in {1} ms, {2:F0} handles/s", count * NumThreads,
+				   (int)elapsed.TotalMilliseconds, count * NumThreads / elapsed.TotalSeconds);
+
+		events = new AutoResetEvent [NumEvents];
+		for (int i = 0; i < NumEvents; i++)
+			events [i] = new AutoResetEvent (false);
+
+		Thread[] signallers = new Thread [2];
+		for (int i = 0; i < signallers.Length; i++) {
+			signallers [i] = new Thread (Signal);
+			signallers [i].Start (i);
+		}
+
+		int waits = repeat * 100000;
+		start = DateTime.Now;
+		for (int i = 0; i < waits; i++) {
+			int res = WaitHandle.WaitAny (events, 10000);
+			if (res == WaitHandle.WaitTimeout)
+				return 1;
+		}
+		elapsed = DateTime.Now - start;
+
+		done = true;
+		for (int i = 0; i < signallers.Length; i++)
+			signallers [i].Join ();
+
+		Console.WriteLine ("{0} WaitAny calls in {1} ms, {2:F0} waits/s", waits,
+				   (int)elapsed.TotalMilliseconds, waits / elapsed.TotalSeconds);
+		return 0;
+	}
+}
@@ -0,0 +1,64 @@
+using System;
+using System.Collections.Generic;
+
+/*
+ * Casts to and calls through the interfaces of a class implementing many of them,
+ * which exercises mono_class_interface_offset () in the runtime cast and dispatch paths.
+ */
+public interface I0 { int M (); }
+public interface I1 { int M (); }
+public interface I2 { int M (); }
+public interface I3 { int M (); }
+public interface I4 { int M (); }
+public interface I5 { int M (); }
+public interface I6 { int M (); }
+public interface I7 { int M (); }
+public interface I8 { int M (); }
+public interface I9 { int M (); }
+public interface I10 { int M (); }
+public interface I11 { int M (); }
+
+public class Many : List<string>, I0, I1, I2, I3, I4, I5, I6, I7, I8, I9, I10, I11 {
+	int I0.M () { return 0; }
+	int I1.M () { return 1; }
+	int I2.M () { return 2; }
+	int I3.M () { return 3; }
+	int I4.M () { return 4; }
+	int I5.M () { return 5; }
+	int I6.M () { return 6; }
+	int I7.M () { return 7; }
+	int I8.M () { return 8; }
+	int I9.M () { return 9; }
+	int I10.M () { return 10; }
+	int I11.M () { return 11; }
+}
+
+public class Test {
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		object a = new Many ();
+		int sum = 0;
+		
+		for (int i = 0; i < (repeat * 500); i++) {
+			for (int j = 0; j < 100000; j++) {
+				if (!(a is I11))
+					return 1;
+				sum += ((I7)a).M ();
+				/* Variant casts go through mono_class_interface_offset_with_variance () */
+				if (!(a is IEnumerable<object>))
+					return 2;
+				if (!(a is IReadOnlyList<object>))
+					return 3;
+			}
+		}
+
+		return sum == repeat * 500 * 100000 * 7 ? 0 : 4;
+	}
+}
@@ -1,6 +1,13 @@
 using System;
 using System.Runtime.InteropServices;
 
+namespace System.Runtime.InteropServices {
+	/* Recognized by name, marks p/invokes which are called without a full wrapper */
+	[AttributeUsage (AttributeTargets.Method)]
+	public sealed class SuppressGCTransitionAttribute : Attribute {
+	}
+}
+
 public class Test {
 
 	public static int delegate_test (int a)
@@ -14,17 +21,30 @@ public class Test {
 	[DllImport ("libtest", EntryPoint="mono_test_empty_pinvoke")]
 	public static extern int mono_test_empty_pinvoke (int i);
 
+	[DllImport ("libtest", EntryPoint="mono_test_empty_pinvoke")]
+	[SuppressGCTransition]
+	public static extern int mono_test_empty_pinvoke_direct (int i);
+
 	public static int Main (String[] args) {
 		int repeat = 1;
+		DateTime start;
 				
 		if (args.Length == 1)
 			repeat = Convert.ToInt32 (args [0]);
 		
 		Console.WriteLine ("Repeat = " + repeat);
 
+		start = DateTime.Now;
 		for (int i = 0; i < (repeat * 5000); i++)
 			for (int j = 0; j < 10000; j++)
 				mono_test_empty_pinvoke (5);
+		Console.WriteLine ("Full wrapper:   {0} ms", (int)(DateTime.Now - start).TotalMilliseconds);
+
+		start = DateTime.Now;
+		for (int i = 0; i < (repeat * 5000); i++)
+			for (int j = 0; j < 10000; j++)
+				mono_test_empty_pinvoke_direct (5);
+		Console.WriteLine ("Direct wrapper: {0} ms", (int)(DateTime.Now - start).TotalMilliseconds);
 		
 		return 0;
 	}
@@ -0,0 +1,52 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+
+/*
+ * Launches short lived child processes with Process.Start while the managed heap
+ * holds a configurable amount of live data, to show how the cost of a launch
+ * depends on the size of the parent process.
+ *
+ * Usage: process-spawn.exe [repeat] [heap size in MB]
+ */
+public class Test {
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+		int heap_mb = 256;
+
+		if (args.Length >= 1)
+			repeat = Convert.ToInt32 (args [0]);
+		if (args.Length >= 2)
+			heap_mb = Convert.ToInt32 (args [1]);
+		
+		Console.WriteLine ("Repeat = " + repeat + ", heap = " + heap_mb + " MB");
+
+		List<byte[]> heap = new List<byte[]> ();
+		for (int i = 0; i < heap_mb; i++) {
+			byte[] chunk = new byte [1024 * 1024];
+			/* Touch every page so it is really mapped */
+			for (int j = 0; j < chunk.Length; j += 4096)
+				chunk [j] = 1;
+			heap.Add (chunk);
+		}
+
+		ProcessStartInfo info = new ProcessStartInfo ("/bin/true");
+		info.UseShellExecute = false;
+
+		int count = repeat * 200;
+		Stopwatch sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++) {
+			using (Process p = Process.Start (info)) {
+				p.WaitForExit ();
+				if (p.ExitCode != 0)
+					return 1;
+			}
+		}
+		sw.Stop ();
+
+		Console.WriteLine ("{0} processes in {1} ms, {2:F1} spawns/s with {3} MB of heap", count,
+				   sw.ElapsedMilliseconds, count / sw.Elapsed.TotalSeconds, heap.Count);
+		return 0;
+	}
+}
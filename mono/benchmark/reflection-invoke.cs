@@ -0,0 +1,69 @@
+using System;
+using System.Diagnostics;
+using System.Reflection;
+
+/*
+ * Compares MethodInfo.Invoke and PropertyInfo.GetValue with calls through
+ * delegates bound to the same methods.
+ */
+public class Test {
+
+	int value = 42;
+
+	public int Add (int a, int b) {
+		return a + b + value;
+	}
+
+	public string Name {
+		get { return "test"; }
+	}
+
+	static void Report (string what, int count, Stopwatch sw) {
+		Console.WriteLine ("{0,-24} {1,8} ms {2,8:F1} ns/call", what, sw.ElapsedMilliseconds,
+				   sw.Elapsed.TotalMilliseconds * 1000000 / count);
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		Test t = new Test ();
+		MethodInfo add = typeof (Test).GetMethod ("Add");
+		PropertyInfo name = typeof (Test).GetProperty ("Name");
+		Func<int, int, int> add_del = (Func<int, int, int>)Delegate.CreateDelegate (typeof (Func<int, int, int>), t, add);
+		Func<string> name_del = (Func<string>)Delegate.CreateDelegate (typeof (Func<string>), t, name.GetGetMethod ());
+		int count = repeat * 1000000;
+		object[] add_args = new object [] { 1, 2 };
+		long sum = 0;
+
+		Stopwatch sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++)
+			sum += (int)add.Invoke (t, add_args);
+		sw.Stop ();
+		Report ("MethodInfo.Invoke", count, sw);
+
+		sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++)
+			sum += add_del (1, 2);
+		sw.Stop ();
+		Report ("delegate", count, sw);
+
+		sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++)
+			sum += ((string)name.GetValue (t, null)).Length;
+		sw.Stop ();
+		Report ("PropertyInfo.GetValue", count, sw);
+
+		sw = Stopwatch.StartNew ();
+		for (int i = 0; i < count; i++)
+			sum += name_del ().Length;
+		sw.Stop ();
+		Report ("getter delegate", count, sw);
+
+		return sum == (long)count * (45 * 2 + 4 * 2) ? 0 : 1;
+	}
+}
@@ -0,0 +1,76 @@
+using System;
+using System.Net;
+using System.Net.Sockets;
+using System.Threading;
+
+/*
+ * Small synchronous Send/Receive round trips over a loopback TCP connection, which
+ * exercises the Socket.Send_internal and Socket.Receive_internal icalls.
+ */
+public class Test {
+
+	const int MessageSize = 64;
+
+	static void Echo (object o) {
+		Socket s = (Socket)o;
+		byte[] buf = new byte [MessageSize];
+		int n;
+
+		while ((n = s.Receive (buf)) > 0)
+			s.Send (buf, 0, n, SocketFlags.None);
+		s.Close ();
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		Socket listener = new Socket (AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+		listener.Bind (new IPEndPoint (IPAddress.Loopback, 0));
+		listener.Listen (1);
+
+		Socket client = new Socket (AddressFamily.InterNetwork, SocketType.Stream, ProtocolType.Tcp);
+		client.NoDelay = true;
+		client.Connect (listener.LocalEndPoint);
+		Socket server = listener.Accept ();
+		server.NoDelay = true;
+		listener.Close ();
+
+		Thread t = new Thread (Echo);
+		t.Start (server);
+
+		byte[] msg = new byte [MessageSize];
+		byte[] reply = new byte [MessageSize];
+		int count = repeat * 100000;
+		long bytes = 0;
+
+		DateTime start = DateTime.Now;
+		for (int i = 0; i < count; i++) {
+			msg [0] = (byte)i;
+			client.Send (msg, 0, MessageSize, SocketFlags.None);
+			int received = 0;
+			while (received < MessageSize) {
+				int n = client.Receive (reply, received, MessageSize - received, SocketFlags.None);
+				if (n <= 0)
+					return 1;
+				received += n;
+			}
+			if (reply [0] != (byte)i)
+				return 2;
+			bytes += received;
+		}
+		TimeSpan elapsed = DateTime.Now - start;
+
+		client.Shutdown (SocketShutdown.Send);
+		t.Join ();
+		client.Close ();
+
+		Console.WriteLine ("{0} round trips in {1} ms, {2:F1} MB/s", count, (int)elapsed.TotalMilliseconds,
+				   (bytes * 2) / elapsed.TotalSeconds / (1024 * 1024));
+		return 0;
+	}
+}
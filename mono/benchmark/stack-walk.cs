@@ -0,0 +1,46 @@
+using System;
+using System.Diagnostics;
+using System.Runtime.CompilerServices;
+
+/*
+ * Walking the stack at various depths, the way exceptions, the GC and the
+ * sampling profiler do. Each walk unwinds every managed frame on the stack.
+ */
+public class Test {
+
+	const int TotalFrames = 20000000;
+
+	static int walks;
+
+	[MethodImpl(MethodImplOptions.NoInlining)]
+	static int Recurse (int depth) {
+		if (depth > 0)
+			return Recurse (depth - 1) + 1;
+
+		int frames = 0;
+		for (int i = 0; i < walks; i++)
+			frames += new StackTrace (false).FrameCount;
+		return frames;
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+
+		Console.WriteLine ("Repeat = " + repeat);
+
+		for (int depth = 1; depth <= 1000; depth *= 10) {
+			walks = TotalFrames * repeat / (depth + 10);
+
+			DateTime start = DateTime.Now;
+			Recurse (depth);
+			TimeSpan elapsed = DateTime.Now - start;
+
+			Console.WriteLine ("depth {0,5}: {1,10:F0} walks/s", depth, walks / elapsed.TotalSeconds);
+		}
+
+		return 0;
+	}
+}
@@ -0,0 +1,63 @@
+using System;
+using System.Threading;
+
+/*
+ * Several threads interning the same set of strings, the way parsers intern
+ * XML element names or JSON keys. Almost every call finds the string already
+ * interned, so this measures lookups in the domain's intern table.
+ */
+public class Test {
+
+	const int NumKeys = 1000;
+
+	static string[] keys;
+	static int count;
+
+	static void Intern () {
+		for (int i = 0; i < count; i++) {
+			string s = String.Intern (keys [i % NumKeys]);
+			if (s.Length == 0)
+				throw new Exception ();
+		}
+	}
+
+	static void Run (int num_threads) {
+		Thread[] threads = new Thread [num_threads];
+		DateTime start = DateTime.Now;
+		for (int i = 0; i < num_threads; i++) {
+			threads [i] = new Thread (Intern);
+			threads [i].Start ();
+		}
+		for (int i = 0; i < num_threads; i++)
+			threads [i].Join ();
+		TimeSpan elapsed = DateTime.Now - start;
+
+		Console.WriteLine ("{0} threads: {1} interns in {2} ms, {3:F0} interns/s", num_threads, count * num_threads,
+				   (int)elapsed.TotalMilliseconds, count * num_threads / elapsed.TotalSeconds);
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		/* Build the keys at runtime so they are not literals, which are interned already */
+		keys = new string [NumKeys];
+		for (int i = 0; i < NumKeys; i++)
+			keys [i] = "element" + i.ToString ();
+
+		count = repeat * 1000000;
+
+		for (int n = 1; n <= 8; n *= 2)
+			Run (n);
+
+		for (int i = 0; i < NumKeys; i++) {
+			if ((object)String.Intern (keys [i]) != (object)String.IsInterned ("element" + i.ToString ()))
+				return 1;
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,57 @@
+using System;
+using System.Runtime.InteropServices;
+
+/*
+ * Passing UTF-8 strings of various sizes to native code, and getting them back.
+ * Most strings passed to native APIs are ASCII, the non-ASCII case is timed too.
+ */
+public class Test {
+
+	[DllImport ("libtest", EntryPoint="mono_test_marshal_lpstr")]
+	public static extern int to_native ([MarshalAs(UnmanagedType.LPStr)] string str);
+
+	[DllImport ("libtest", EntryPoint="mono_test_marshal_lpstr_echo")]
+	public static extern string round_trip ([MarshalAs(UnmanagedType.LPStr)] string str1, [MarshalAs(UnmanagedType.LPStr)] string str2);
+
+	const long TotalChars = 1L << 28;
+
+	static void Run (string s, int repeat) {
+		int iterations = (int)Math.Max (1, TotalChars * repeat / Math.Max (s.Length, 16));
+		DateTime start;
+		TimeSpan elapsed;
+
+		start = DateTime.Now;
+		for (int i = 0; i < iterations; i++)
+			to_native (s);
+		elapsed = DateTime.Now - start;
+		Console.Write ("{0,8} chars: to native {1,8:F0} MB/s", s.Length, (double)s.Length * iterations / (1024 * 1024) / elapsed.TotalSeconds);
+
+		iterations /= 4;
+		start = DateTime.Now;
+		for (int i = 0; i < iterations; i++) {
+			if (round_trip (s, s) == null)
+				throw new Exception ();
+		}
+		elapsed = DateTime.Now - start;
+		Console.WriteLine (", round trip {0,8:F0} MB/s", (double)s.Length * iterations / (1024 * 1024) / elapsed.TotalSeconds);
+	}
+
+	public static int Main (string[] args) {
+		int repeat = 1;
+
+		if (args.Length == 1)
+			repeat = Convert.ToInt32 (args [0]);
+		
+		Console.WriteLine ("Repeat = " + repeat);
+
+		Console.WriteLine ("ASCII:");
+		for (int len = 16; len <= 4 * 1024 * 1024; len *= 8)
+			Run (new string ('x', len), repeat);
+
+		Console.WriteLine ("Non-ASCII:");
+		for (int len = 16; len <= 4 * 1024 * 1024; len *= 8)
+			Run (new string ('x', len - 1) + "\u00e9", repeat);
+
+		return 0;
+	}
+}
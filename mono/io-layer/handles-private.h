@@ -35,8 +35,6 @@ extern struct _WapiHandleSharedLayout *_wapi_shared_layout;
 extern struct _WapiFileShareLayout *_wapi_fileshare_layout;
 
 extern guint32 _wapi_fd_reserve;
-extern mono_mutex_t *_wapi_global_signal_mutex;
-extern pthread_cond_t *_wapi_global_signal_cond;
 extern int _wapi_sem_id;
 extern gboolean _wapi_has_shut_down;
 
@@ -79,8 +77,6 @@ extern gboolean _wapi_handle_count_signalled_handles (guint32 numhandles,
 						      guint32 *lowest);
 extern void _wapi_handle_unlock_handles (guint32 numhandles,
 					 gpointer *handles);
-extern int _wapi_handle_wait_signal (gboolean poll);
-extern int _wapi_handle_timedwait_signal (struct timespec *timeout, gboolean poll);
 extern int _wapi_handle_wait_signal_handle (gpointer handle, gboolean alertable);
 extern int _wapi_handle_timedwait_signal_handle (gpointer handle,
 												 struct timespec *timeout, gboolean alertable, gboolean poll);
@@ -106,6 +102,20 @@ void _wapi_free_share_info (_WapiFileShare *share_info);
 
 #define WAPI_SHARED_HANDLE_TYPED_DATA(handle, type) _wapi_shared_layout->handles[_WAPI_PRIVATE_HANDLES(GPOINTER_TO_UINT((handle))).u.shared.offset].u.type
 
+/*
+ * A thread waiting for several handles. It is linked into the waiters list of each
+ * private handle it waits for, so signalling a handle only wakes up the threads
+ * which wait for it, instead of every thread blocked in WaitForMultipleObjects ().
+ */
+typedef struct _WapiHandleWaiter {
+	/* The event of the waiting thread, see _wapi_thread_get_multiple_wait_event () */
+	gpointer wait_event;
+	struct _WapiHandleWaiter *prev, *next;
+} WapiHandleWaiter;
+
+extern void _wapi_handle_add_waiter (gpointer handle, WapiHandleWaiter *waiter);
+extern void _wapi_handle_remove_waiter (gpointer handle, WapiHandleWaiter *waiter);
+
 static inline WapiHandleType _wapi_handle_type (gpointer handle)
 {
 	guint32 idx = GPOINTER_TO_UINT(handle);
@@ -139,21 +149,14 @@ static inline void _wapi_handle_set_signal_state (gpointer handle,
 #endif
 
 	if (state == TRUE) {
-		/* Tell everyone blocking on a single handle */
-
-		/* The condition the global signal cond is waiting on is the signalling of
-		 * _any_ handle. So lock it before setting the signalled state.
-		 */
-		thr_ret = mono_mutex_lock (_wapi_global_signal_mutex);
-		if (thr_ret != 0)
-			g_warning ("Bad call to mono_mutex_lock result %d for global signal mutex", thr_ret);
-		g_assert (thr_ret == 0);
+		WapiHandleWaiter *waiter;
 
 		/* This function _must_ be called with
 		 * handle->signal_mutex locked
 		 */
 		handle_data->signalled=state;
 		
+		/* Tell everyone blocking on a single handle */
 		if (broadcast == TRUE) {
 			thr_ret = pthread_cond_broadcast (&handle_data->signal_cond);
 			if (thr_ret != 0)
@@ -166,18 +169,25 @@ static inline void _wapi_handle_set_signal_state (gpointer handle,
 			g_assert (thr_ret == 0);
 		}
 
-		/* Tell everyone blocking on multiple handles that something
-		 * was signalled
-		 */			
-		thr_ret = pthread_cond_broadcast (_wapi_global_signal_cond);
-		if (thr_ret != 0)
-			g_warning ("Bad call to pthread_cond_broadcast result %d for handle %p", thr_ret, handle);
-		g_assert (thr_ret == 0);
-			
-		thr_ret = mono_mutex_unlock (_wapi_global_signal_mutex);
-		if (thr_ret != 0)
-			g_warning ("Bad call to mono_mutex_unlock result %d for global signal mutex", thr_ret);
-		g_assert (thr_ret == 0);
+		/* Tell everyone blocking on multiple handles including
+		 * this one that it was signalled. They check the state of
+		 * their handles with their event mutex held, so they can't
+		 * miss the wakeup.
+		 */
+		for (waiter = handle_data->waiters; waiter; waiter = waiter->next) {
+			struct _WapiHandleUnshared *event_data = &_WAPI_PRIVATE_HANDLES (GPOINTER_TO_UINT (waiter->wait_event));
+
+			thr_ret = mono_mutex_lock (&event_data->signal_mutex);
+			g_assert (thr_ret == 0);
+
+			thr_ret = pthread_cond_broadcast (&event_data->signal_cond);
+			if (thr_ret != 0)
+				g_warning ("Bad call to pthread_cond_broadcast result %d for handle %p", thr_ret, waiter->wait_event);
+			g_assert (thr_ret == 0);
+
+			thr_ret = mono_mutex_unlock (&event_data->signal_mutex);
+			g_assert (thr_ret == 0);
+		}
 	} else {
 		handle_data->signalled=state;
 	}
@@ -224,25 +234,6 @@ static inline gboolean _wapi_handle_issignalled (gpointer handle)
 	}
 }
 
-static inline int _wapi_handle_lock_signal_mutex (void)
-{
-#ifdef DEBUG
-	g_message ("%s: lock global signal mutex", __func__);
-#endif
-
-	return(mono_mutex_lock (_wapi_global_signal_mutex));
-}
-
-/* the parameter makes it easier to call from a pthread cleanup handler */
-static inline int _wapi_handle_unlock_signal_mutex (void *unused)
-{
-#ifdef DEBUG
-	g_message ("%s: unlock global signal mutex", __func__);
-#endif
-
-	return(mono_mutex_unlock (_wapi_global_signal_mutex));
-}
-
 static inline int _wapi_handle_lock_handle (gpointer handle)
 {
 	guint32 idx = GPOINTER_TO_UINT(handle);
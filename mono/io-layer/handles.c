@@ -44,6 +44,7 @@
 #include <mono/io-layer/process-private.h>
 
 #include <mono/utils/mono-mutex.h>
+#include <mono/utils/mono-memory-model.h>
 #include <mono/utils/mono-proclib.h>
 #undef DEBUG_REFS
 
@@ -143,16 +144,14 @@ static mono_mutex_t file_share_hash_mutex;
 
 guint32 _wapi_fd_reserve;
 
-/* 
- * This is an internal handle which is used for handling waiting for multiple handles.
- * Threads which wait for multiple handles wait on this one handle, and when a handle
- * is signalled, this handle is signalled too.
+/*
+ * The unused private handles above _wapi_fd_reserve, linked through their next_free
+ * field. The low 32 bits are the index of the first one, or 0 if the list is empty,
+ * the high 32 bits are bumped on every change to avoid ABA problems. Handles are
+ * taken from and returned to the list without locking, scan_mutex is only needed to
+ * grow the handle array when the list is empty.
  */
-static gpointer _wapi_global_signal_handle;
-
-/* Point to the mutex/cond inside _wapi_global_signal_handle */
-mono_mutex_t *_wapi_global_signal_mutex;
-pthread_cond_t *_wapi_global_signal_cond;
+static volatile gint64 free_handles;
 
 int _wapi_sem_id;
 gboolean _wapi_has_shut_down = FALSE;
@@ -273,11 +272,6 @@ wapi_init (void)
 	_wapi_io_init ();
 	mono_mutex_init (&scan_mutex);
 
-	_wapi_global_signal_handle = _wapi_handle_new (WAPI_HANDLE_EVENT, NULL);
-
-	_wapi_global_signal_cond = &_WAPI_PRIVATE_HANDLES (GPOINTER_TO_UINT (_wapi_global_signal_handle)).signal_cond;
-	_wapi_global_signal_mutex = &_WAPI_PRIVATE_HANDLES (GPOINTER_TO_UINT (_wapi_global_signal_handle)).signal_mutex;
-
 	wapi_processes_init ();
 
 	/* Using atexit here instead of an explicit function call in
@@ -370,9 +364,9 @@ static void _wapi_handle_init (struct _WapiHandleUnshared *handle,
 	
 	g_assert (_wapi_has_shut_down == FALSE);
 	
-	handle->type = type;
 	handle->signalled = FALSE;
 	handle->ref = 1;
+	handle->waiters = NULL;
 	
 	if (!_WAPI_SHARED_HANDLE(type)) {
 		thr_ret = pthread_cond_init (&handle->signal_cond, NULL);
@@ -387,6 +381,13 @@ static void _wapi_handle_init (struct _WapiHandleUnshared *handle,
 				type_size);
 		}
 	}
+
+	/* Handles are allocated without holding scan_mutex, so make sure
+	 * _wapi_search_handle () and _wapi_handle_foreach () only see
+	 * initialized handles
+	 */
+	mono_memory_write_barrier ();
+	handle->type = type;
 }
 
 static guint32 _wapi_handle_new_shared (WapiHandleType type,
@@ -438,62 +439,90 @@ again:
 	return(0);
 }
 
+static void
+free_list_push (guint32 idx)
+{
+	gint64 old, new;
+
+	do {
+		old = InterlockedRead64 (&free_handles);
+		_WAPI_PRIVATE_HANDLES (idx).next_free = (guint32)old;
+		new = (gint64)((((guint64)old >> 32) + 1) << 32) | idx;
+	} while (InterlockedCompareExchange64 (&free_handles, new, old) != old);
+}
+
+static guint32
+free_list_pop (void)
+{
+	gint64 old, new;
+	guint32 idx;
+
+	do {
+		old = InterlockedRead64 (&free_handles);
+		idx = (guint32)old;
+		if (idx == 0)
+			return 0;
+		/* If IDX was taken in the meantime, the counter changed and the CAS fails */
+		new = (gint64)((((guint64)old >> 32) + 1) << 32) | _WAPI_PRIVATE_HANDLES (idx).next_free;
+	} while (InterlockedCompareExchange64 (&free_handles, new, old) != old);
+
+	return idx;
+}
+
 /*
  * _wapi_handle_new_internal:
  * @type: Init handle to this type
  *
- * Search for a free handle and initialize it. Return the handle on
- * success and 0 on failure.  This is only called from
- * _wapi_handle_new, and scan_mutex must be held.
+ * Take a free handle and initialize it, growing the handle array if
+ * needed. Return the handle on success and 0 on failure.
  */
 static guint32 _wapi_handle_new_internal (WapiHandleType type,
 					  gpointer handle_specific)
 {
-	guint32 i, k, count;
-	static guint32 last = 0;
-	gboolean retry = FALSE;
+	guint32 idx;
+	int thr_ret;
 	
 	g_assert (_wapi_has_shut_down == FALSE);
-	
-	/* A linear scan should be fast enough.  Start from the last
-	 * allocation, assuming that handles are allocated more often
-	 * than they're freed. Leave the space reserved for file
-	 * descriptors
-	 */
-	
-	if (last < _wapi_fd_reserve) {
-		last = _wapi_fd_reserve;
-	} else {
-		retry = TRUE;
-	}
 
-again:
-	count = last;
-	for(i = SLOT_INDEX (count); i < _wapi_private_handle_slot_count; i++) {
-		if (_wapi_private_handles [i]) {
-			for (k = SLOT_OFFSET (count); k < _WAPI_HANDLE_INITIAL_COUNT; k++) {
-				struct _WapiHandleUnshared *handle = &_wapi_private_handles [i][k];
+	while ((idx = free_list_pop ()) == 0) {
+		gboolean full = FALSE;
 
-				if(handle->type == WAPI_HANDLE_UNUSED) {
-					last = count + 1;
-			
-					_wapi_handle_init (handle, type, handle_specific);
-					return (count);
-				}
-				count++;
+		thr_ret = mono_mutex_lock (&scan_mutex);
+		g_assert (thr_ret == 0);
+
+		/* Somebody else might have grown the array already */
+		if ((guint32)InterlockedRead64 (&free_handles) == 0) {
+			int slot = SLOT_INDEX (_wapi_private_handle_count);
+
+			if (slot >= _WAPI_PRIVATE_MAX_SLOTS) {
+				full = TRUE;
+			} else {
+				guint32 i, first;
+
+				_wapi_private_handles [slot] = g_new0 (struct _WapiHandleUnshared,
+								       _WAPI_HANDLE_INITIAL_COUNT);
+
+				/* Push the new handles so the lowest is taken first. Leave
+				 * index 0 alone, it marks the end of the list.
+				 */
+				first = MAX (_wapi_private_handle_count, 1);
+				for (i = _wapi_private_handle_count + _WAPI_HANDLE_INITIAL_COUNT; i > first; i--)
+					free_list_push (i - 1);
+
+				_wapi_private_handle_count += _WAPI_HANDLE_INITIAL_COUNT;
+				_wapi_private_handle_slot_count ++;
 			}
 		}
-	}
 
-	if(retry && last > _wapi_fd_reserve) {
-		/* Try again from the beginning */
-		last = _wapi_fd_reserve;
-		goto again;
-	}
+		thr_ret = mono_mutex_unlock (&scan_mutex);
+		g_assert (thr_ret == 0);
 
-	/* Will need to expand the array.  The caller will sort it out */
+		if (full)
+			return 0;
+	}
 
-	return(0);
+	_wapi_handle_init (&_WAPI_PRIVATE_HANDLES (idx), type, handle_specific);
+	return idx;
 }
 
 gpointer 
@@ -501,7 +530,6 @@ _wapi_handle_new (WapiHandleType type, gpointer handle_specific)
 {
 	guint32 handle_idx = 0;
 	gpointer handle;
-	int thr_ret;
 
 	g_assert (_wapi_has_shut_down == FALSE);
 		
@@ -510,26 +538,7 @@ _wapi_handle_new (WapiHandleType type, gpointer handle_specific)
 
 	g_assert(!_WAPI_FD_HANDLE(type));
 	
-	thr_ret = mono_mutex_lock (&scan_mutex);
-	g_assert (thr_ret == 0);
-		
-	while ((handle_idx = _wapi_handle_new_internal (type, handle_specific)) == 0) {
-		/* Try and expand the array, and have another go */
-		int idx = SLOT_INDEX (_wapi_private_handle_count);
-		if (idx >= _WAPI_PRIVATE_MAX_SLOTS) {
-			break;
-		}
-
-		_wapi_private_handles [idx] = g_new0 (struct _WapiHandleUnshared,
-						_WAPI_HANDLE_INITIAL_COUNT);
-
-		_wapi_private_handle_count += _WAPI_HANDLE_INITIAL_COUNT;
-		_wapi_private_handle_slot_count ++;
-	}
-	
-	thr_ret = mono_mutex_unlock (&scan_mutex);
-	g_assert (thr_ret == 0);
-
+	handle_idx = _wapi_handle_new_internal (type, handle_specific);
 	if (handle_idx == 0) {
 		/* We ran out of slots */
 		handle = _WAPI_HANDLE_INVALID;
@@ -638,22 +647,13 @@ first_pass_done:
 		goto done;
 	}
 	
-	thr_ret = mono_mutex_lock (&scan_mutex);
-	g_assert (thr_ret == 0);
-	
-	while ((handle_idx = _wapi_handle_new_internal (type, NULL)) == 0) {
-		/* Try and expand the array, and have another go */
-		int idx = SLOT_INDEX (_wapi_private_handle_count);
-		_wapi_private_handles [idx] = g_new0 (struct _WapiHandleUnshared,
-						_WAPI_HANDLE_INITIAL_COUNT);
-
-		_wapi_private_handle_count += _WAPI_HANDLE_INITIAL_COUNT;
-		_wapi_private_handle_slot_count ++;
+	handle_idx = _wapi_handle_new_internal (type, NULL);
+	if (handle_idx == 0) {
+		/* We ran out of slots */
+		handle = INVALID_HANDLE_VALUE;
+		goto done;
 	}
 		
-	thr_ret = mono_mutex_unlock (&scan_mutex);
-	g_assert (thr_ret == 0);
-		
 	/* Make sure we left the space for fd mappings */
 	g_assert (handle_idx >= _wapi_fd_reserve);
 	
@@ -1163,6 +1163,10 @@ static void _wapi_handle_unref_full (gpointer handle, gboolean ignore_private_bu
 		if (is_shared) {
 			_wapi_handle_unlock_shared_handles ();
 		}
+
+		/* fd handles are not allocated from the free list */
+		if (idx >= _wapi_fd_reserve)
+			free_list_push (idx);
 		
 		if (close_func != NULL) {
 			if (is_shared) {
@@ -1536,14 +1540,41 @@ static int timedwait_signal_poll_cond (pthread_cond_t *cond, mono_mutex_t *mutex
 	return(ret);
 }
 
-int _wapi_handle_wait_signal (gboolean poll)
+void _wapi_handle_add_waiter (gpointer handle, WapiHandleWaiter *waiter)
 {
-	return _wapi_handle_timedwait_signal_handle (_wapi_global_signal_handle, NULL, TRUE, poll);
+	struct _WapiHandleUnshared *handle_data = &_WAPI_PRIVATE_HANDLES (GPOINTER_TO_UINT (handle));
+	int thr_ret;
+
+	thr_ret = mono_mutex_lock (&handle_data->signal_mutex);
+	g_assert (thr_ret == 0);
+
+	waiter->prev = NULL;
+	waiter->next = handle_data->waiters;
+	if (waiter->next)
+		waiter->next->prev = waiter;
+	handle_data->waiters = waiter;
+
+	thr_ret = mono_mutex_unlock (&handle_data->signal_mutex);
+	g_assert (thr_ret == 0);
 }
 
-int _wapi_handle_timedwait_signal (struct timespec *timeout, gboolean poll)
+void _wapi_handle_remove_waiter (gpointer handle, WapiHandleWaiter *waiter)
 {
-	return _wapi_handle_timedwait_signal_handle (_wapi_global_signal_handle, timeout, TRUE, poll);
+	struct _WapiHandleUnshared *handle_data = &_WAPI_PRIVATE_HANDLES (GPOINTER_TO_UINT (handle));
+	int thr_ret;
+
+	thr_ret = mono_mutex_lock (&handle_data->signal_mutex);
+	g_assert (thr_ret == 0);
+
+	if (waiter->prev)
+		waiter->prev->next = waiter->next;
+	else
+		handle_data->waiters = waiter->next;
+	if (waiter->next)
+		waiter->next->prev = waiter->prev;
+
+	thr_ret = mono_mutex_unlock (&handle_data->signal_mutex);
+	g_assert (thr_ret == 0);
 }
 
 int _wapi_handle_wait_signal_handle (gpointer handle, gboolean alertable)
@@ -153,6 +153,21 @@ static volatile gint32 mono_processes_cleaning_up = 0;
 static mono_mutex_t mono_processes_mutex;
 static void mono_processes_cleanup (void);
 
+/* Exit statuses reaped by the sigchld handler for children which were not in
+ * mono_processes yet. A child can exit before CreateProcess () has added it to
+ * the list, so CreateProcess () looks for its pid here after adding it.
+ * Slots are claimed by swapping their pid with 0.
+ */
+#define EARLY_EXITS_SIZE 32
+
+typedef struct {
+	volatile gint32 pid;
+	int status;
+} EarlyExit;
+
+static EarlyExit early_exits [EARLY_EXITS_SIZE];
+static volatile gint32 early_exits_next;
+
 static gpointer current_process;
 static char *cli_launcher;
 
@@ -539,6 +554,112 @@ switch_dir_separators (char *path)
 	}
 }
 
+/*
+ * exec_child:
+ *
+ *   Runs in the child between fork ()/vfork () and exec (). When the child was
+ * created with vfork () it shares the memory of the parent, so this must only
+ * make system calls and must never return.
+ */
+static void G_GNUC_NORETURN
+exec_child (char **argv, char **env_strings, const char *dir, int in_fd, int out_fd, int err_fd, sigset_t *old_mask)
+{
+	int i;
+
+#if HAVE_SIGACTION
+	/* The handlers installed by the runtime must not run in the child, they
+	 * would clobber the state of the parent. Ignored signals stay ignored.
+	 */
+	for (i = 1; i < NSIG; i++) {
+		struct sigaction sa;
+
+		if (sigaction (i, NULL, &sa) == 0 && sa.sa_handler != SIG_IGN && sa.sa_handler != SIG_DFL) {
+			sa.sa_handler = SIG_DFL;
+			sa.sa_flags = 0;
+			sigemptyset (&sa.sa_mask);
+			sigaction (i, &sa, NULL);
+		}
+	}
+#endif
+	pthread_sigmask (SIG_SETMASK, old_mask, NULL);
+
+	/* should we detach from the process group? */
+
+	/* Connect stdin, stdout and stderr */
+	dup2 (in_fd, 0);
+	dup2 (out_fd, 1);
+	dup2 (err_fd, 2);
+
+	/* Close all file descriptors */
+	for (i = wapi_getdtablesize () - 1; i > 2; i--)
+		close (i);
+
+	/* set cwd */
+	if (dir != NULL && chdir (dir) == -1) {
+		/* set error */
+		_exit (-1);
+	}
+
+	/* exec */
+	execve (argv[0], argv, env_strings);
+
+	/* set error */
+	_exit (-1);
+}
+
+/*
+ * spawn_process:
+ *
+ *   Start ARGV in a new process and return its pid, or -1 on failure. Where
+ * available this uses vfork (), which doesn't copy the page tables of the
+ * parent, so the cost of a launch doesn't grow with the size of the heap.
+ * All signals are blocked in the calling thread until the child has exec'd.
+ */
+static pid_t
+spawn_process (char **argv, char **env_strings, const char *dir, int in_fd, int out_fd, int err_fd)
+{
+	sigset_t all_mask, old_mask;
+	pid_t pid;
+
+	sigfillset (&all_mask);
+	pthread_sigmask (SIG_SETMASK, &all_mask, &old_mask);
+
+#ifdef HAVE_VFORK
+	pid = vfork ();
+#else
+	pid = fork ();
+#endif
+	if (pid == 0)
+		exec_child (argv, env_strings, dir, in_fd, out_fd, err_fd, &old_mask);
+
+	pthread_sigmask (SIG_SETMASK, &old_mask, NULL);
+	return pid;
+}
+
+/*
+ * process_claim_early_exit:
+ *
+ *   Return TRUE and set STATUS if the sigchld handler reaped PID before it
+ * was added to mono_processes.
+ */
+static gboolean
+process_claim_early_exit (pid_t pid, int *status)
+{
+	int i;
+
+	for (i = 0; i < EARLY_EXITS_SIZE; i++) {
+		if (early_exits [i].pid == pid) {
+			int s = early_exits [i].status;
+
+			if (InterlockedCompareExchange (&early_exits [i].pid, 0, pid) == pid) {
+				*status = s;
+				return TRUE;
+			}
+		}
+	}
+	return FALSE;
+}
+
 gboolean CreateProcess (const gunichar2 *appname, const gunichar2 *cmdline,
 			WapiSecurityAttributes *process_attrs G_GNUC_UNUSED,
 			WapiSecurityAttributes *thread_attrs G_GNUC_UNUSED,
@@ -557,8 +678,7 @@ gboolean CreateProcess (const gunichar2 *appname, const gunichar2 *cmdline,
 	int in_fd, out_fd, err_fd;
 	pid_t pid;
 	int thr_ret;
-	int startup_pipe [2] = {-1, -1};
-	int dummy;
+	int status;
 	struct MonoProcess *mono_process;
 	gboolean fork_failed = FALSE;
 
@@ -942,72 +1062,30 @@ gboolean CreateProcess (const gunichar2 *appname, const gunichar2 *cmdline,
 		}
 	}
 
-	/* Create a pipe to make sure the child doesn't exit before 
-	 * we can add the process to the linked list of mono_processes */
-	if (pipe (startup_pipe) == -1) {
-		/* Could not create the pipe to synchroniz process startup. We'll just not synchronize.
-		 * This is just for a very hard to hit race condition in the first place */
-		startup_pipe [0] = startup_pipe [1] = -1;
-		DEBUG ("%s: new process startup not synchronized. We may not notice if the newly created process exits immediately.", __func__);
-	}
+#ifdef DEBUG_ENABLED
+	DEBUG ("%s: exec()ing [%s] in dir [%s]", __func__, cmd,
+		   dir == NULL?".":dir);
+	for (i = 0; argv[i] != NULL; i++)
+		g_message ("arg %d: [%s]", i, argv[i]);
+
+	for (i = 0; env_strings[i] != NULL; i++)
+		g_message ("env %d: [%s]", i, env_strings[i]);
+#endif
 
 	thr_ret = _wapi_handle_lock_shared_handles ();
 	g_assert (thr_ret == 0);
-	
-	pid = fork ();
+
+	/* Statuses left over from earlier launches can't belong to the new child */
+	for (i = 0; i < EARLY_EXITS_SIZE; i++)
+		early_exits [i].pid = 0;
+
+	pid = spawn_process (argv, env_strings, dir, in_fd, out_fd, err_fd);
 	if (pid == -1) {
 		/* Error */
 		SetLastError (ERROR_OUTOFMEMORY);
 		ret = FALSE;
 		fork_failed = TRUE;
 		goto cleanup;
-	} else if (pid == 0) {
-		/* Child */
-		
-		if (startup_pipe [0] != -1) {
-			/* Wait until the parent has updated it's internal data */
-			ssize_t _i G_GNUC_UNUSED = read (startup_pipe [0], &dummy, 1);
-			DEBUG ("%s: child: parent has completed its setup", __func__);
-			close (startup_pipe [0]);
-			close (startup_pipe [1]);
-		}
-		
-		/* should we detach from the process group? */
-
-		/* Connect stdin, stdout and stderr */
-		dup2 (in_fd, 0);
-		dup2 (out_fd, 1);
-		dup2 (err_fd, 2);
-
-		if (inherit_handles != TRUE) {
-			/* FIXME: do something here */
-		}
-		
-		/* Close all file descriptors */
-		for (i = wapi_getdtablesize () - 1; i > 2; i--)
-			close (i);
-
-#ifdef DEBUG_ENABLED
-		DEBUG ("%s: exec()ing [%s] in dir [%s]", __func__, cmd,
-			   dir == NULL?".":dir);
-		for (i = 0; argv[i] != NULL; i++)
-			g_message ("arg %d: [%s]", i, argv[i]);
-		
-		for (i = 0; env_strings[i] != NULL; i++)
-			g_message ("env %d: [%s]", i, env_strings[i]);
-#endif
-
-		/* set cwd */
-		if (dir != NULL && chdir (dir) == -1) {
-			/* set error */
-			_exit (-1);
-		}
-		
-		/* exec */
-		execve (argv[0], argv, env_strings);
-		
-		/* set error */
-		_exit (-1);
 	}
 	/* parent */
 	
@@ -1043,6 +1121,15 @@ gboolean CreateProcess (const gunichar2 *appname, const gunichar2 *cmdline,
 		mono_process->next = mono_processes;
 		mono_processes = mono_process;
 		mono_mutex_unlock (&mono_processes_mutex);
+
+		/* The child might have exited before it was added to the list */
+		mono_memory_barrier ();
+		if (process_claim_early_exit (pid, &status)) {
+			DEBUG ("%s: child %d exited before it was added to the list", __func__, pid);
+			mono_process->pid = 0;
+			mono_process->status = status;
+			MONO_SEM_POST (&mono_process->exit_sem);
+		}
 	}
 	
 	if (process_info != NULL) {
@@ -1062,13 +1149,6 @@ cleanup:
 	if (fork_failed)
 		_wapi_handle_unref (handle);
 
-	if (startup_pipe [1] != -1) {
-		/* Write 1 byte, doesn't matter what */
-		ssize_t _i G_GNUC_UNUSED = write (startup_pipe [1], startup_pipe, 1);
-		close (startup_pipe [0]);
-		close (startup_pipe [1]);
-	}
-
 free_strings:
 	if (cmd)
 		g_free (cmd);
@@ -2572,6 +2652,26 @@ MONO_SIGNAL_HANDLER_FUNC (static, mono_sigchld_signal_handler, (int _dummy, sigi
 			}
 			p = p->next;
 		}
+
+		if (p == NULL) {
+			/* CreateProcess () might not have added it yet, see process_claim_early_exit () */
+			EarlyExit *slot = &early_exits [(guint32)InterlockedIncrement (&early_exits_next) % EARLY_EXITS_SIZE];
+
+			slot->status = status;
+			InterlockedExchange (&slot->pid, pid);
+
+			/* Check again, in case it was added while we weren't looking */
+			for (p = mono_processes; p != NULL; p = p->next) {
+				if (p->pid == pid) {
+					if (InterlockedCompareExchange (&slot->pid, 0, pid) == pid) {
+						p->pid = 0;
+						p->status = status;
+						MONO_SEM_POST (&p->exit_sem);
+					}
+					break;
+				}
+			}
+		}
 	} while (1);
 
 	InterlockedDecrement (&mono_processes_read_lock);
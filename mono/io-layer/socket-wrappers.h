@@ -49,6 +49,12 @@
 
 #define WSA_FLAG_OVERLAPPED           0x01
 
+/* Layout compatible with struct mmsghdr, so it can be passed to recvmmsg ()/sendmmsg () */
+typedef struct {
+	struct msghdr msg_hdr;
+	unsigned int msg_len;
+} WapiMMsgHdr;
+
 extern guint32 _wapi_accept(guint32 handle, struct sockaddr *addr,
 			    socklen_t *addrlen);
 extern int _wapi_bind(guint32 handle, struct sockaddr *my_addr,
@@ -71,6 +77,10 @@ extern int _wapi_send(guint32 handle, const void *msg, size_t len,
 extern int _wapi_sendto(guint32 handle, const void *msg, size_t len,
 			int send_flags, const struct sockaddr *to,
 			socklen_t tolen);
+extern int _wapi_recvmmsg(guint32 handle, WapiMMsgHdr *msgs, guint32 count,
+			  int recv_flags);
+extern int _wapi_sendmmsg(guint32 handle, WapiMMsgHdr *msgs, guint32 count,
+			  int send_flags);
 extern int _wapi_setsockopt(guint32 handle, int level, int optname,
 			    const void *optval, socklen_t optlen);
 extern int _wapi_shutdown(guint32 handle, int how);
@@ -481,6 +481,28 @@ int _wapi_listen(guint32 fd, int backlog)
 	return(0);
 }
 
+/*
+ * socket_set_last_error:
+ *
+ *   Set the last socket error after the ERRNUM failure of a socket call on FD.
+ * The receive functions issue the system call directly on the fd, since the handle
+ * of a socket is its file descriptor, and only consult the handle table once the
+ * call failed, so handles of another type still fail with WSAENOTSOCK. A handle
+ * which is gone was closed during the call, callers rely on seeing the error of
+ * the call itself then, like WSAEINTR.
+ */
+static void
+socket_set_last_error (guint32 fd, gint errnum, const gchar *function_name)
+{
+	WapiHandleType type = _wapi_handle_type (GUINT_TO_POINTER (fd));
+
+	if (errnum != EINTR && type != WAPI_HANDLE_SOCKET && type != WAPI_HANDLE_UNUSED)
+		errnum = WSAENOTSOCK;
+	else
+		errnum = errno_to_WSA (errnum, function_name);
+	WSASetLastError (errnum);
+}
+
 int _wapi_recv(guint32 fd, void *buf, size_t len, int recv_flags)
 {
 	return(_wapi_recvfrom (fd, buf, len, recv_flags, NULL, 0));
@@ -494,11 +516,6 @@ int _wapi_recvfrom(guint32 fd, void *buf, size_t len, int recv_flags,
 	gboolean ok;
 	int ret;
 	
-	if (_wapi_handle_type (handle) != WAPI_HANDLE_SOCKET) {
-		WSASetLastError (WSAENOTSOCK);
-		return(SOCKET_ERROR);
-	}
-	
 	do {
 		ret = recvfrom (fd, buf, len, recv_flags, from, fromlen);
 	} while (ret == -1 && errno == EINTR &&
@@ -535,8 +552,7 @@ int _wapi_recvfrom(guint32 fd, void *buf, size_t len, int recv_flags,
 		gint errnum = errno;
 		DEBUG ("%s: recv error: %s", __func__, strerror(errno));
 
-		errnum = errno_to_WSA (errnum, __func__);
-		WSASetLastError (errnum);
+		socket_set_last_error (fd, errnum, __func__);
 		
 		return(SOCKET_ERROR);
 	}
@@ -583,12 +599,63 @@ _wapi_recvmsg(guint32 fd, struct msghdr *msg, int recv_flags)
 	return(ret);
 }
 
+/*
+ * _wapi_recvmmsg:
+ *
+ *   Receive up to COUNT datagrams into MSGS with a single recvmmsg () call where
+ * available, setting the msg_len field of each received message. Blocks until the
+ * first datagram arrives, then only takes the ones which are already queued.
+ * Returns the number of messages received, or SOCKET_ERROR if none could be. If a
+ * later datagram fails, the partial count is returned and its error is left as the
+ * last error.
+ */
+int _wapi_recvmmsg(guint32 fd, WapiMMsgHdr *msgs, guint32 count, int recv_flags)
+{
+	guint32 i;
+	int ret;
+
+#ifdef HAVE_RECVMMSG
+	static gboolean recvmmsg_unsupported;
+
+	if (!recvmmsg_unsupported) {
+		do {
+			ret = recvmmsg (fd, (struct mmsghdr *)msgs, count, recv_flags | MSG_WAITFORONE, NULL);
+		} while (ret == -1 && errno == EINTR &&
+			 !_wapi_thread_cur_apc_pending ());
+
+		if (ret != -1 || errno != ENOSYS) {
+			if (ret == -1) {
+				gint errnum = errno;
+				DEBUG ("%s: recvmmsg error: %s", __func__, strerror (errno));
+
+				socket_set_last_error (fd, errnum, __func__);
+				return(SOCKET_ERROR);
+			}
+			return(ret);
+		}
+		recvmmsg_unsupported = TRUE;
+	}
+#endif
+
+	/* Fall back to one recvmsg () per datagram */
+	for (i = 0; i < count; ++i) {
+		ret = _wapi_recvmsg (fd, &msgs [i].msg_hdr, i == 0 ? recv_flags : recv_flags | MSG_DONTWAIT);
+		if (ret == SOCKET_ERROR) {
+			if (i == 0)
+				return(SOCKET_ERROR);
+			break;
+		}
+		msgs [i].msg_len = ret;
+	}
+	return(i);
+}
+
 int _wapi_send(guint32 fd, const void *msg, size_t len, int send_flags)
 {
-	gpointer handle = GUINT_TO_POINTER (fd);
 	int ret;
 	
-	if (_wapi_handle_type (handle) != WAPI_HANDLE_SOCKET) {
+	/* A closed socket's fd can be reused by a file, don't write to it */
+	if (_wapi_handle_type (GUINT_TO_POINTER (fd)) != WAPI_HANDLE_SOCKET) {
 		WSASetLastError (WSAENOTSOCK);
 		return(SOCKET_ERROR);
 	}
@@ -611,8 +678,7 @@ int _wapi_send(guint32 fd, const void *msg, size_t len, int send_flags)
 				errnum = ETIMEDOUT;
 		}
 #endif /* O_NONBLOCK */
-		errnum = errno_to_WSA (errnum, __func__);
-		WSASetLastError (errnum);
+		socket_set_last_error (fd, errnum, __func__);
 		
 		return(SOCKET_ERROR);
 	}
@@ -622,14 +688,13 @@ int _wapi_send(guint32 fd, const void *msg, size_t len, int send_flags)
 int _wapi_sendto(guint32 fd, const void *msg, size_t len, int send_flags,
 		 const struct sockaddr *to, socklen_t tolen)
 {
-	gpointer handle = GUINT_TO_POINTER (fd);
 	int ret;
 	
-	if (_wapi_handle_type (handle) != WAPI_HANDLE_SOCKET) {
+	if (_wapi_handle_type (GUINT_TO_POINTER (fd)) != WAPI_HANDLE_SOCKET) {
 		WSASetLastError (WSAENOTSOCK);
 		return(SOCKET_ERROR);
 	}
-	
+
 	do {
 		ret = sendto (fd, msg, len, send_flags, to, tolen);
 	} while (ret == -1 && errno == EINTR &&
@@ -639,8 +704,7 @@ int _wapi_sendto(guint32 fd, const void *msg, size_t len, int send_flags,
 		gint errnum = errno;
 		DEBUG ("%s: send error: %s", __func__, strerror (errno));
 
-		errnum = errno_to_WSA (errnum, __func__);
-		WSASetLastError (errnum);
+		socket_set_last_error (fd, errnum, __func__);
 		
 		return(SOCKET_ERROR);
 	}
@@ -675,6 +739,56 @@ _wapi_sendmsg(guint32 fd,  const struct msghdr *msg, int send_flags)
 	return(ret);
 }
 
+/*
+ * _wapi_sendmmsg:
+ *
+ *   Send the COUNT datagrams in MSGS with a single sendmmsg () call where available,
+ * setting the msg_len field of each sent message. Returns the number of messages
+ * sent, which can be less than COUNT, or SOCKET_ERROR if none could be. If a later
+ * datagram fails, the partial count is returned and its error is left as the last
+ * error.
+ */
+int _wapi_sendmmsg(guint32 fd, WapiMMsgHdr *msgs, guint32 count, int send_flags)
+{
+	guint32 i;
+	int ret;
+
+#ifdef HAVE_SENDMMSG
+	static gboolean sendmmsg_unsupported;
+
+	if (!sendmmsg_unsupported) {
+		do {
+			ret = sendmmsg (fd, (struct mmsghdr *)msgs, count, send_flags);
+		} while (ret == -1 && errno == EINTR &&
+			 !_wapi_thread_cur_apc_pending ());
+
+		if (ret != -1 || errno != ENOSYS) {
+			if (ret == -1) {
+				gint errnum = errno;
+				DEBUG ("%s: sendmmsg error: %s", __func__, strerror (errno));
+
+				socket_set_last_error (fd, errnum, __func__);
+				return(SOCKET_ERROR);
+			}
+			return(ret);
+		}
+		sendmmsg_unsupported = TRUE;
+	}
+#endif
+
+	/* Fall back to one sendmsg () per datagram */
+	for (i = 0; i < count; ++i) {
+		ret = _wapi_sendmsg (fd, &msgs [i].msg_hdr, send_flags);
+		if (ret == SOCKET_ERROR) {
+			if (i == 0)
+				return(SOCKET_ERROR);
+			break;
+		}
+		msgs [i].msg_len = ret;
+	}
+	return(i);
+}
+
 int _wapi_setsockopt(guint32 fd, int level, int optname,
 		     const void *optval, socklen_t optlen)
 {
@@ -946,77 +1060,271 @@ static gboolean wapi_disconnectex (guint32 fd, WapiOverlapped *overlapped,
 }
 
 #define SF_BUFFER_SIZE	16384
-static gint
-wapi_sendfile (guint32 socket, gpointer fd, guint32 bytes_to_write, guint32 bytes_per_send, guint32 flags)
+
+static void
+sendfile_set_last_error (void)
 {
-#if defined(HAVE_SENDFILE) && (defined(__linux__) || defined(DARWIN))
-	gint file = GPOINTER_TO_INT (fd);
-	gint n;
-	gint errnum;
-	gssize res;
-	struct stat statbuf;
+	gint errnum = errno;
 
-	n = fstat (file, &statbuf);
-	if (n == -1) {
-		errnum = errno;
-		errnum = errno_to_WSA (errnum, __func__);
-		WSASetLastError (errnum);
-		return SOCKET_ERROR;
-	}
-	do {
-#ifdef __linux__
-		res = sendfile (socket, file, NULL, statbuf.st_size);
-#elif defined(DARWIN)
-		/* TODO: header/tail could be sent in the 5th argument */
-		/* TODO: Might not send the entire file for non-blocking sockets */
-		res = sendfile (file, socket, 0, &statbuf.st_size, NULL, 0);
-#endif
-	} while (res != -1 && (errno == EINTR || errno == EAGAIN) && !_wapi_thread_cur_apc_pending ());
-	if (res == -1) {
-		errnum = errno;
-		errnum = errno_to_WSA (errnum, __func__);
-		WSASetLastError (errnum);
-		return SOCKET_ERROR;
+	errnum = errno_to_WSA (errnum, __func__);
+	WSASetLastError (errnum);
+}
+
+/*
+ * send_all:
+ *
+ *   Send LEN bytes from BUF, looping over partial sends.
+ */
+static gint
+send_all (guint32 socket, const guint8 *buf, gsize len)
+{
+	while (len > 0) {
+		gint ret = _wapi_send (socket, buf, len, 0);
+		if (ret == SOCKET_ERROR)
+			return SOCKET_ERROR;
+		buf += ret;
+		len -= ret;
 	}
-#else
-	/* Default implementation */
-	gint file = GPOINTER_TO_INT (fd);
+	return 0;
+}
+
+/*
+ * sendfile_copy:
+ *
+ *   Send LENGTH bytes of FILE starting at OFFSET by reading them into a buffer, or
+ * until the end of the file if LENGTH is -1.
+ */
+static gint
+sendfile_copy (guint32 socket, gint file, gint64 offset, gint64 length)
+{
 	gchar *buffer;
-	gint n;
+	gssize n;
 
 	buffer = g_malloc (SF_BUFFER_SIZE);
-	do {
+	while (length != 0) {
+		gsize to_read = length == -1 ? SF_BUFFER_SIZE : MIN (length, SF_BUFFER_SIZE);
+
 		do {
-			n = read (file, buffer, SF_BUFFER_SIZE);
+			n = offset == -1 ? read (file, buffer, to_read) : pread (file, buffer, to_read, offset);
 		} while (n == -1 && errno == EINTR && !_wapi_thread_cur_apc_pending ());
-		if (n == -1)
+		if (n == -1) {
+			sendfile_set_last_error ();
+			g_free (buffer);
+			return SOCKET_ERROR;
+		}
+		if (n == 0)
 			break;
-		if (n == 0) {
+
+		if (send_all (socket, (guint8 *) buffer, n) == SOCKET_ERROR) {
 			g_free (buffer);
-			return 0; /* We're done reading */
+			return SOCKET_ERROR;
 		}
-		do {
-			n = send (socket, buffer, n, 0); /* short sends? enclose this in a loop? */
-		} while (n == -1 && errno == EINTR && !_wapi_thread_cur_apc_pending ());
-	} while (n != -1);
+		if (offset != -1)
+			offset += n;
+		if (length != -1)
+			length -= n;
+	}
+	g_free (buffer);
+	return 0;
+}
 
-	if (n == -1) {
-		gint errnum = errno;
-		errnum = errno_to_WSA (errnum, __func__);
-		WSASetLastError (errnum);
-		g_free (buffer);
+#if defined(HAVE_SPLICE) && defined(__linux__)
+#define SPLICE_CHUNK_SIZE (SF_BUFFER_SIZE * 4)
+
+static gssize
+splice_noeintr (gint in_fd, gint out_fd, gsize len, guint flags)
+{
+	gssize n;
+
+	do {
+		n = splice (in_fd, NULL, out_fd, NULL, len, flags);
+	} while (n == -1 && errno == EINTR && !_wapi_thread_cur_apc_pending ());
+	return n;
+}
+
+/*
+ * sendfile_splice:
+ *
+ *   Move LENGTH bytes (-1 for everything) of a non-regular FILE, like a pipe or a
+ * character device, to the socket without copying them through user space. Data
+ * which isn't read from a pipe goes through an intermediate pipe, since splice ()
+ * needs a pipe on one end. Returns 1 if FILE can't be spliced and nothing was sent.
+ */
+static gint
+sendfile_splice (guint32 socket, gint file, gboolean is_pipe, gint64 length)
+{
+	gint pipefd [2];
+	gboolean sent = FALSE;
+	gint ret = 0;
+
+	if (!is_pipe && pipe (pipefd) == -1)
+		return 1;
+
+	while (length != 0) {
+		gsize chunk = length == -1 ? SPLICE_CHUNK_SIZE : MIN (length, SPLICE_CHUNK_SIZE);
+		guint more = length == -1 || length > chunk ? SPLICE_F_MORE : 0;
+		gssize n, moved, pending;
+
+		n = moved = splice_noeintr (file, is_pipe ? socket : pipefd [1], chunk, SPLICE_F_MOVE | more);
+		if (n == 0)
+			break;
+		if (n == -1) {
+			if (!sent && errno == EINVAL) {
+				ret = 1;
+			} else {
+				sendfile_set_last_error ();
+				ret = SOCKET_ERROR;
+			}
+			break;
+		}
+
+		sent = TRUE;
+		if (!is_pipe) {
+			for (pending = moved; pending > 0; pending -= n) {
+				n = splice_noeintr (pipefd [0], socket, pending, SPLICE_F_MOVE | more);
+				if (n <= 0)
+					break;
+			}
+			if (pending > 0) {
+				if (n == 0)
+					errno = EPIPE;
+				sendfile_set_last_error ();
+				ret = SOCKET_ERROR;
+				break;
+			}
+		}
+		if (length != -1)
+			length -= moved;
+	}
+
+	if (!is_pipe) {
+		close (pipefd [0]);
+		close (pipefd [1]);
+	}
+	return ret;
+}
+#endif
+
+static gint
+wapi_sendfile (guint32 socket, gpointer fd, gint64 offset, gint64 length)
+{
+	gint file = GPOINTER_TO_INT (fd);
+	struct stat statbuf;
+#if defined(HAVE_SENDFILE) && defined(__linux__)
+	gboolean sent;
+#endif
+
+	if (fstat (file, &statbuf) == -1) {
+		sendfile_set_last_error ();
 		return SOCKET_ERROR;
 	}
-	g_free (buffer);
+
+	if (!S_ISREG (statbuf.st_mode)) {
+#if defined(HAVE_SPLICE) && defined(__linux__)
+		gint ret = sendfile_splice (socket, file, S_ISFIFO (statbuf.st_mode), length);
+		if (ret != 1)
+			return ret;
 #endif
+		return sendfile_copy (socket, file, -1, length);
+	}
+
+	if (offset > statbuf.st_size)
+		offset = statbuf.st_size;
+	if (length == -1 || length > statbuf.st_size - offset)
+		length = statbuf.st_size - offset;
+
+#if defined(HAVE_SENDFILE) && defined(__linux__)
+	sent = FALSE;
+	while (length > 0) {
+		off_t off = offset;
+		gssize res;
+
+		do {
+			res = sendfile (socket, file, &off, MIN (length, G_MAXINT32));
+		} while (res == -1 && errno == EINTR && !_wapi_thread_cur_apc_pending ());
+		if (res == -1) {
+			/* Not every file system supports sendfile () */
+			if (!sent && (errno == EINVAL || errno == ENOSYS))
+				return sendfile_copy (socket, file, offset, length);
+			sendfile_set_last_error ();
+			return SOCKET_ERROR;
+		}
+		/* The file was truncated */
+		if (res == 0)
+			break;
+		sent = TRUE;
+		offset += res;
+		length -= res;
+	}
+	return 0;
+#elif defined(HAVE_SENDFILE) && defined(DARWIN)
+	while (length > 0) {
+		off_t len = length;
+		gint res;
+
+		res = sendfile (file, socket, offset, &len, NULL, 0);
+		if (res == -1 && errno != EINTR && errno != EAGAIN) {
+			sendfile_set_last_error ();
+			return SOCKET_ERROR;
+		}
+		if (res == -1 && errno == EINTR && _wapi_thread_cur_apc_pending ()) {
+			sendfile_set_last_error ();
+			return SOCKET_ERROR;
+		}
+		if (res == 0 && len == 0)
+			break;
+		offset += len;
+		length -= len;
+	}
 	return 0;
+#else
+	return sendfile_copy (socket, file, offset, length);
+#endif
 }
 
+/*
+ * set_cork:
+ *
+ *   Enable or disable TCP_CORK (TCP_NOPUSH on BSD) on SOCKET, so the head, the file
+ * data and the tail of a TransmitFile () go out in full segments. Returns whether
+ * the option was set before.
+ */
+static gboolean
+set_cork (guint32 socket, gboolean cork)
+{
+#if defined(TCP_CORK) || defined(TCP_NOPUSH)
+#ifdef TCP_CORK
+	int option = TCP_CORK;
+#else
+	int option = TCP_NOPUSH;
+#endif
+	int old = 0, val = cork;
+	socklen_t len = sizeof (old);
+
+	if (getsockopt (socket, IPPROTO_TCP, option, &old, &len) == -1)
+		return FALSE;
+	if ((old != 0) != cork)
+		setsockopt (socket, IPPROTO_TCP, option, &val, sizeof (val));
+	return old != 0;
+#else
+	return FALSE;
+#endif
+}
+
+/*
+ * TransmitFile:
+ *
+ *   Send BYTES_TO_WRITE bytes of FILE, or the rest of the file if it is 0, preceded
+ * and followed by the head and tail of BUFFERS. As on Windows, the data is sent from
+ * the offset in OL, or from the current file position if OL is NULL.
+ */
 gboolean
 TransmitFile (guint32 socket, gpointer file, guint32 bytes_to_write, guint32 bytes_per_send, WapiOverlapped *ol,
 		WapiTransmitFileBuffers *buffers, guint32 flags)
 {
 	gpointer sock = GUINT_TO_POINTER (socket);
+	gint64 offset = 0;
+	gboolean corked = FALSE, has_buffers;
 	gint ret;
 
 	if (_wapi_handle_type (sock) != WAPI_HANDLE_SOCKET) {
@@ -1024,28 +1332,48 @@ TransmitFile (guint32 socket, gpointer file, guint32 bytes_to_write, guint32 byt
 		return FALSE;
 	}
 
+	if (ol != NULL) {
+		offset = ((gint64) ol->OffsetHigh << 32) | ol->Offset;
+	} else {
+		offset = lseek (GPOINTER_TO_INT (file), 0, SEEK_CUR);
+		if (offset == -1)
+			offset = 0;
+	}
+
+	has_buffers = buffers != NULL && ((buffers->Head != NULL && buffers->HeadLength > 0) || (buffers->Tail != NULL && buffers->TailLength > 0));
+	if (has_buffers)
+		corked = set_cork (socket, TRUE);
+
 	/* Write the header */
 	if (buffers != NULL && buffers->Head != NULL && buffers->HeadLength > 0) {
-		ret = _wapi_send (socket, buffers->Head, buffers->HeadLength, 0);
+		ret = send_all (socket, buffers->Head, buffers->HeadLength);
 		if (ret == SOCKET_ERROR)
-			return FALSE;
+			goto error;
 	}
 
-	ret = wapi_sendfile (socket, file, bytes_to_write, bytes_per_send, flags);
+	ret = wapi_sendfile (socket, file, offset, bytes_to_write ? bytes_to_write : -1);
 	if (ret == SOCKET_ERROR)
-		return FALSE;
+		goto error;
 
 	/* Write the tail */
 	if (buffers != NULL && buffers->Tail != NULL && buffers->TailLength > 0) {
-		ret = _wapi_send (socket, buffers->Tail, buffers->TailLength, 0);
+		ret = send_all (socket, buffers->Tail, buffers->TailLength);
 		if (ret == SOCKET_ERROR)
-			return FALSE;
+			goto error;
 	}
 
+	if (has_buffers && !corked)
+		set_cork (socket, FALSE);
+
 	if ((flags & TF_DISCONNECT) == TF_DISCONNECT)
 		closesocket (socket);
 
 	return TRUE;
+
+error:
+	if (has_buffers && !corked)
+		set_cork (socket, FALSE);
+	return FALSE;
 }
 
 static struct 
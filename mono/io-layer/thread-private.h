@@ -33,6 +33,8 @@ struct _WapiHandle_thread
 	 * This also acts as a reference for the handle.
 	 */
 	gpointer wait_handle;
+	/* Event this thread blocks on in WaitForMultipleObjectsEx (), created on first use */
+	gpointer multiple_wait_event;
 };
 
 typedef struct _WapiHandle_thread WapiHandle_thread;
@@ -42,5 +44,6 @@ extern gboolean _wapi_thread_cur_apc_pending (void);
 extern void _wapi_thread_own_mutex (gpointer mutex);
 extern void _wapi_thread_disown_mutex (gpointer mutex);
 extern void _wapi_thread_cleanup (void);
+extern gpointer _wapi_thread_get_multiple_wait_event (void);
 
 #endif /* _WAPI_THREAD_PRIVATE_H_ */
@@ -456,6 +456,15 @@ static gboolean test_and_own (guint32 numobjects, gpointer *handles,
 	return(done);
 }
 
+/* Whether the state of HANDLE has to be polled, as signalling it doesn't wake up waiters */
+static gboolean
+poll_handle (gpointer handle)
+{
+	WapiHandleType type = _wapi_handle_type (handle);
+
+	return type == WAPI_HANDLE_PROCESS || _WAPI_SHARED_HANDLE (type);
+}
+
 /**
  * WaitForMultipleObjectsEx:
  * @numobjects: The number of objects in @handles. The maximum allowed
@@ -500,6 +509,8 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 	guint32 retval;
 	gboolean poll;
 	gpointer sorted_handles [MAXIMUM_WAIT_OBJECTS];
+	WapiHandleWaiter waiters [MAXIMUM_WAIT_OBJECTS];
+	gpointer wait_event;
 	
 	if (current_thread == NULL) {
 		SetLastError (ERROR_INVALID_HANDLE);
@@ -571,7 +582,7 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 
 	poll = FALSE;
 	for (i = 0; i < numobjects; ++i)
-		if (_wapi_handle_type (handles [i]) == WAPI_HANDLE_PROCESS || _WAPI_SHARED_HANDLE (_wapi_handle_type (handles[i]))) 
+		if (poll_handle (handles [i]))
 			/* Can't wait for a process handle + another handle without polling */
 			poll = TRUE;
 
@@ -592,6 +603,10 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 
 	if (alertable && _wapi_thread_apc_pending (current_thread))
 		return WAIT_IO_COMPLETION;
+
+	wait_event = _wapi_thread_get_multiple_wait_event ();
+	if (wait_event == NULL)
+		return WAIT_FAILED;
 	
 	for (i = 0; i < numobjects; i++) {
 		/* Add a reference, as we need to ensure the handle wont
@@ -599,6 +614,13 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 		 * (not lock, as we don't want exclusive access here)
 		 */
 		_wapi_handle_ref (handles[i]);
+
+		/* Ask to be woken up when the handle is signalled. Shared
+		 * and process handles are polled instead.
+		 */
+		waiters [i].wait_event = wait_event;
+		if (!poll_handle (handles [i]))
+			_wapi_handle_add_waiter (handles [i], &waiters [i]);
 	}
 
 	while(1) {
@@ -613,9 +635,12 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 			}
 		}
 		
-		DEBUG ("%s: locking signal mutex", __func__);
+		DEBUG ("%s: locking wait event", __func__);
 
-		thr_ret = _wapi_handle_lock_signal_mutex ();
+		/* A handle signalled after it is checked below will
+		 * broadcast the wait event once we're waiting on it
+		 */
+		thr_ret = _wapi_handle_lock_handle (wait_event);
 		g_assert (thr_ret == 0);
 
 		/* Check the signalled state of handles inside the critical section */
@@ -634,18 +659,18 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 		if (!done) {
 			/* Enter the wait */
 			if (timeout == INFINITE) {
-				ret = _wapi_handle_wait_signal (poll);
+				ret = _wapi_handle_timedwait_signal_handle (wait_event, NULL, TRUE, poll);
 			} else {
-				ret = _wapi_handle_timedwait_signal (&abstime, poll);
+				ret = _wapi_handle_timedwait_signal_handle (wait_event, &abstime, TRUE, poll);
 			}
 		} else {
 			/* No need to wait */
 			ret = 0;
 		}
 
-		DEBUG ("%s: unlocking signal mutex", __func__);
+		DEBUG ("%s: unlocking wait event", __func__);
 
-		thr_ret = _wapi_handle_unlock_signal_mutex (NULL);
+		thr_ret = _wapi_handle_unlock_handle (wait_event);
 		g_assert (thr_ret == 0);
 		
 		if (alertable && _wapi_thread_apc_pending (current_thread)) {
@@ -679,6 +704,9 @@ guint32 WaitForMultipleObjectsEx(guint32 numobjects, gpointer *handles,
 	}
 
 	for (i = 0; i < numobjects; i++) {
+		if (!poll_handle (handles [i]))
+			_wapi_handle_remove_waiter (handles [i], &waiters [i]);
+
 		/* Unref everything we reffed above */
 		_wapi_handle_unref (handles[i]);
 	}
@@ -118,6 +118,8 @@ struct _WapiHandle_shared_ref
 
 #define _WAPI_HANDLE_INITIAL_COUNT 256
 
+struct _WapiHandleWaiter;
+
 struct _WapiHandleUnshared
 {
 	WapiHandleType type;
@@ -125,6 +127,10 @@ struct _WapiHandleUnshared
 	gboolean signalled;
 	mono_mutex_t signal_mutex;
 	pthread_cond_t signal_cond;
+	/* Threads waiting for several handles including this one, protected by signal_mutex */
+	struct _WapiHandleWaiter *waiters;
+	/* The next unused handle, while this one is on the free list */
+	guint32 next_free;
 	
 	union 
 	{
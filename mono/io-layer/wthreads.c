@@ -102,6 +102,28 @@ get_current_thread (void)
 	return lookup_thread (handle);
 }
 
+/*
+ * _wapi_thread_get_multiple_wait_event:
+ *
+ *   Return the event the current thread blocks on while waiting for several
+ * handles, or NULL if it can't be created. Signalling one of the handles
+ * broadcasts the condition of this event.
+ */
+gpointer
+_wapi_thread_get_multiple_wait_event (void)
+{
+	WapiHandle_thread *thread = get_current_thread ();
+
+	if (!thread->multiple_wait_event) {
+		gpointer event = _wapi_handle_new (WAPI_HANDLE_EVENT, NULL);
+
+		if (event == _WAPI_HANDLE_INVALID)
+			return NULL;
+		thread->multiple_wait_event = event;
+	}
+	return thread->multiple_wait_event;
+}
+
 void
 wapi_thread_handle_set_exited (gpointer handle, guint32 exitstatus)
 {
@@ -131,6 +153,11 @@ wapi_thread_handle_set_exited (gpointer handle, guint32 exitstatus)
 		_wapi_thread_disown_mutex (mutex);
 	}
 	g_ptr_array_free (thread_handle->owned_mutexes, TRUE);
+
+	if (thread_handle->multiple_wait_event) {
+		_wapi_handle_unref (thread_handle->multiple_wait_event);
+		thread_handle->multiple_wait_event = NULL;
+	}
 	
 	thr_ret = _wapi_handle_lock_handle (handle);
 	g_assert (thr_ret == 0);
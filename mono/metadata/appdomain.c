@@ -224,6 +224,7 @@ mono_runtime_init (MonoDomain *domain, MonoThreadStartCB start_cb,
 	mono_gc_base_init ();
 	mono_monitor_init ();
 	mono_thread_pool_init ();
+	mono_file_io_uring_init ();
 	mono_marshal_init ();
 
 	mono_install_assembly_preload_hook (mono_domain_assembly_preload, GUINT_TO_POINTER (FALSE));
@@ -37,6 +37,9 @@
 #include <mono/utils/mono-io-portability.h>
 #include <mono/utils/atomic.h>
 #include <mono/utils/mono-mutex.h>
+#include <mono/utils/mono-threads.h>
+#include <mono/utils/mono-semaphore.h>
+#include <mono/utils/mono-counters.h>
 
 #ifndef HOST_WIN32
 #include <sys/types.h>
@@ -2765,24 +2768,18 @@ mono_assembly_apply_binding (MonoAssemblyName *aname, MonoAssemblyName *dest_nam
 	return dest_name;
 }
 
-/**
- * mono_assembly_load_from_gac
+/*
+ * gac_subpath:
  *
- * @aname: The assembly name object
+ *   Return the path of FILENAME for the assembly ANAME relative to the root of a GAC.
  */
-static MonoAssembly*
-mono_assembly_load_from_gac (MonoAssemblyName *aname,  gchar *filename, MonoImageOpenStatus *status, MonoBoolean refonly)
+static gchar*
+gac_subpath (MonoAssemblyName *aname, gchar *filename)
 {
-	MonoAssembly *result = NULL;
-	gchar *name, *version, *culture, *fullpath, *subpath;
+	gchar *name, *version, *culture, *subpath;
 	gint32 len;
-	gchar **paths;
 	char *pubtok;
 
-	if (aname->public_key_token [0] == 0) {
-		return NULL;
-	}
-
 	if (strstr (aname->name, ".dll")) {
 		len = strlen (filename) - 4;
 		name = g_malloc (len);
@@ -2808,6 +2805,27 @@ mono_assembly_load_from_gac (MonoAssemblyName *aname,  gchar *filename, MonoImag
 	g_free (version);
 	g_free (culture);
 
+	return subpath;
+}
+
+/**
+ * mono_assembly_load_from_gac
+ *
+ * @aname: The assembly name object
+ */
+static MonoAssembly*
+mono_assembly_load_from_gac (MonoAssemblyName *aname,  gchar *filename, MonoImageOpenStatus *status, MonoBoolean refonly)
+{
+	MonoAssembly *result = NULL;
+	gchar *fullpath, *subpath;
+	gchar **paths;
+
+	if (aname->public_key_token [0] == 0) {
+		return NULL;
+	}
+
+	subpath = gac_subpath (aname, filename);
+
 	if (extra_gac_paths) {
 		paths = extra_gac_paths;
 		while (!result && *paths) {
@@ -3163,6 +3181,273 @@ mono_assembly_foreach (GFunc func, gpointer user_data)
 	g_list_free (copy);
 }
 
+/*
+ * Assembly prefetching
+ *
+ * When MONO_PREFETCH_ASSEMBLIES is set to a number of threads, the runtime walks the
+ * AssemblyRef graph of the entry assembly on that many background threads, and opens
+ * the images of the referenced assemblies ahead of demand. Opening an image maps it,
+ * loads its metadata and runs the metadata verifier if it is enabled, so this work is
+ * taken off the main thread. The images are registered in the loaded images hash, so
+ * the normal load path finds them there when it opens the same file.
+ * The prefetch threads only probe the GAC, the directory of the entry assembly, MONO_PATH
+ * and the default path, they don't apply assembly bindings or invoke preload hooks, so
+ * some prefetched images might never be used.
+ */
+
+#define MAX_PREFETCH_THREADS 16
+
+static mono_mutex_t prefetch_mutex;
+static gboolean prefetch_inited;
+/* Set at shutdown, tells the prefetch threads to exit */
+static gboolean prefetch_stop;
+/* Posted by each prefetch thread when it exits */
+static MonoSemType prefetch_exited_sem;
+/* Queue of MonoAssemblyName*s whose images still need to be prefetched */
+static GQueue *prefetch_queue;
+/* Full names of the assemblies which were already queued */
+static GHashTable *prefetch_seen;
+/* Images opened by the prefetch threads, we hold a reference to each of them */
+static GSList *prefetch_images;
+static char *prefetch_basedir;
+static int prefetch_max_threads, prefetch_threads, prefetch_threads_started;
+static gint32 prefetch_images_opened;
+
+static MonoImage*
+prefetch_try_open (const char *fullpath)
+{
+	MonoImageOpenStatus status;
+	MonoImage *image;
+
+	if (!g_file_test (fullpath, G_FILE_TEST_IS_REGULAR))
+		return NULL;
+	image = mono_image_open_full (fullpath, &status, FALSE);
+	if (image && !image->tables [MONO_TABLE_ASSEMBLY].rows) {
+		/* Modules are loaded by the assembly which contains them */
+		mono_image_close (image);
+		image = NULL;
+	}
+	return image;
+}
+
+static MonoImage*
+prefetch_open (MonoAssemblyName *aname)
+{
+	MonoImage *image = NULL;
+	gchar *filename, *fullpath, *subpath;
+	gchar **paths;
+	int i, ext_index;
+
+	for (ext_index = 0; !image && ext_index < 2; ext_index ++) {
+		filename = g_strconcat (aname->name, ext_index == 0 ? ".dll" : ".exe", NULL);
+
+		if (aname->public_key_token [0]) {
+			subpath = gac_subpath (aname, filename);
+			for (paths = extra_gac_paths; !image && paths && *paths; paths++) {
+				fullpath = g_build_path (G_DIR_SEPARATOR_S, *paths, "lib", "mono", "gac", subpath, NULL);
+				image = prefetch_try_open (fullpath);
+				g_free (fullpath);
+			}
+			if (!image) {
+				fullpath = g_build_path (G_DIR_SEPARATOR_S, mono_assembly_getrootdir (), "mono", "gac", subpath, NULL);
+				image = prefetch_try_open (fullpath);
+				g_free (fullpath);
+			}
+			g_free (subpath);
+		}
+
+		if (!image && prefetch_basedir) {
+			fullpath = g_build_filename (prefetch_basedir, filename, NULL);
+			image = prefetch_try_open (fullpath);
+			g_free (fullpath);
+		}
+
+		for (paths = assemblies_path; !image && paths && *paths; paths++) {
+			fullpath = g_build_filename (*paths, filename, NULL);
+			image = prefetch_try_open (fullpath);
+			g_free (fullpath);
+		}
+
+		for (i = 0; !image && default_path [i]; ++i) {
+			fullpath = g_build_filename (default_path [i], filename, NULL);
+			image = prefetch_try_open (fullpath);
+			g_free (fullpath);
+		}
+
+		g_free (filename);
+	}
+
+	return image;
+}
+
+static void prefetch_start_thread (void);
+
+/*
+ * prefetch_queue_references:
+ *
+ *   Queue the assemblies referenced by IMAGE which were not seen yet.
+ * LOCKING: Assumes the prefetch lock is held.
+ */
+static void
+prefetch_queue_references (MonoImage *image)
+{
+	MonoAssemblyName aname, maped_aname, *name;
+	char *fullname;
+	int i;
+
+	if (prefetch_stop)
+		return;
+
+	for (i = 0; i < image->tables [MONO_TABLE_ASSEMBLYREF].rows; ++i) {
+		mono_assembly_get_assemblyref (image, i, &aname);
+		name = mono_assembly_remap_version (&aname, &maped_aname);
+		if (!strcmp (name->name, "mscorlib"))
+			continue;
+		/* Different versions of an assembly can live in different places */
+		fullname = mono_stringify_assembly_name (name);
+		if (g_hash_table_lookup (prefetch_seen, fullname)) {
+			g_free (fullname);
+			continue;
+		}
+
+		/* The assembly name points into the metadata of IMAGE, which stays open */
+		name = g_memdup (name, sizeof (MonoAssemblyName));
+		g_hash_table_insert (prefetch_seen, fullname, name);
+		g_queue_push_tail (prefetch_queue, name);
+		if (prefetch_threads < prefetch_max_threads && prefetch_threads < prefetch_queue->length)
+			prefetch_start_thread ();
+	}
+}
+
+static gsize
+prefetch_thread (gpointer unused)
+{
+	MonoAssemblyName *aname;
+	MonoImage *image;
+
+	while (TRUE) {
+		mono_mutex_lock (&prefetch_mutex);
+		aname = prefetch_stop ? NULL : g_queue_pop_head (prefetch_queue);
+		if (!aname) {
+			prefetch_threads--;
+			mono_mutex_unlock (&prefetch_mutex);
+			break;
+		}
+		mono_mutex_unlock (&prefetch_mutex);
+
+		image = prefetch_open (aname);
+		if (!image)
+			continue;
+
+		mono_trace (G_LOG_LEVEL_INFO, MONO_TRACE_ASSEMBLY, "Prefetched image '%s' for assembly '%s'.", image->name, aname->name);
+		InterlockedIncrement (&prefetch_images_opened);
+
+		mono_mutex_lock (&prefetch_mutex);
+		prefetch_images = g_slist_prepend (prefetch_images, image);
+		prefetch_queue_references (image);
+		mono_mutex_unlock (&prefetch_mutex);
+	}
+
+	/* The thread must not touch any runtime data after this */
+	MONO_SEM_POST (&prefetch_exited_sem);
+	return 0;
+}
+
+/*
+ * prefetch_start_thread:
+ *
+ * LOCKING: Assumes the prefetch lock is held.
+ */
+static void
+prefetch_start_thread (void)
+{
+	MonoNativeThreadId tid;
+
+	if (mono_native_thread_create (&tid, prefetch_thread, NULL)) {
+#ifndef HOST_WIN32
+		/* Nobody joins them, mono_assembly_prefetch_cleanup () waits on prefetch_exited_sem instead */
+		pthread_detach (tid);
+#endif
+		prefetch_threads++;
+		prefetch_threads_started++;
+	}
+}
+
+/*
+ * mono_assembly_prefetch_references:
+ *
+ *   Start opening the images of the assemblies referenced directly or indirectly by
+ * ASSEMBLY on background threads, if enabled by the MONO_PREFETCH_ASSEMBLIES environment
+ * variable. This should be called once, with the entry assembly.
+ */
+void
+mono_assembly_prefetch_references (MonoAssembly *assembly)
+{
+	const char *env;
+
+	if (prefetch_inited || !assembly || image_is_dynamic (assembly->image))
+		return;
+
+	env = g_getenv ("MONO_PREFETCH_ASSEMBLIES");
+	if (!env)
+		return;
+	prefetch_max_threads = atoi (env);
+	if (prefetch_max_threads <= 0)
+		return;
+	prefetch_max_threads = MIN (prefetch_max_threads, MAX_PREFETCH_THREADS);
+
+	mono_mutex_init (&prefetch_mutex);
+	MONO_SEM_INIT (&prefetch_exited_sem, 0);
+	prefetch_queue = g_queue_new ();
+	prefetch_seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	prefetch_basedir = g_strdup (assembly->basedir);
+	prefetch_inited = TRUE;
+
+	mono_counters_register ("Prefetched images", MONO_COUNTER_METADATA | MONO_COUNTER_INT, &prefetch_images_opened);
+
+	mono_mutex_lock (&prefetch_mutex);
+	prefetch_queue_references (assembly->image);
+	mono_mutex_unlock (&prefetch_mutex);
+}
+
+/*
+ * mono_assembly_prefetch_cleanup:
+ *
+ *   Stop the prefetch threads, wait for them to exit, and close the images they opened.
+ * This needs to be called before the loader and the image hash are torn down, since the
+ * threads might be in the middle of opening an image.
+ */
+void
+mono_assembly_prefetch_cleanup (void)
+{
+	GSList *l;
+	int i, started;
+
+	if (!prefetch_inited)
+		return;
+
+	mono_mutex_lock (&prefetch_mutex);
+	/* No threads are started after this */
+	prefetch_stop = TRUE;
+	started = prefetch_threads_started;
+	mono_mutex_unlock (&prefetch_mutex);
+
+	/* Each thread posts the semaphore once on exit, including the ones which already exited */
+	for (i = 0; i < started; ++i)
+		MONO_SEM_WAIT_UNITERRUPTIBLE (&prefetch_exited_sem);
+
+	for (l = prefetch_images; l; l = l->next)
+		mono_image_close (l->data);
+	g_slist_free (prefetch_images);
+	prefetch_images = NULL;
+	g_queue_free (prefetch_queue);
+	g_hash_table_destroy (prefetch_seen);
+	g_free (prefetch_basedir);
+	MONO_SEM_DESTROY (&prefetch_exited_sem);
+	mono_mutex_destroy (&prefetch_mutex);
+	prefetch_inited = FALSE;
+}
+
 /**
  * mono_assemblies_cleanup:
  *
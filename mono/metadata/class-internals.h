@@ -227,6 +227,28 @@ typedef struct {
 
 #define MONO_CLASS_PROP_EXCEPTION_DATA 0
 
+/*
+ * Perfect hash mapping interface ids to interface offsets, built for classes which
+ * implement many interfaces. An interface id IID is stored at index
+ * (IID * MULT) >> SHIFT, so a lookup is a single probe instead of a binary search
+ * of interfaces_packed.
+ */
+typedef struct {
+	guint16 iid;
+	guint16 offset;
+} MonoInterfaceHashEntry;
+
+#define MONO_INTERFACE_HASH_EMPTY 0xffff
+#define MONO_INTERFACE_HASH_MIN_COUNT 8
+
+typedef struct {
+	guint32 mult;
+	guint8 shift;
+	MonoInterfaceHashEntry entries [MONO_ZERO_LEN_ARRAY];
+} MonoInterfaceHash;
+
+#define MONO_SIZEOF_INTERFACE_HASH (sizeof (MonoInterfaceHash) - MONO_ZERO_LEN_ARRAY * sizeof (MonoInterfaceHashEntry))
+
 /* 
  * This structure contains the rarely used fields of MonoClass
  * Since using just one field causes the whole structure to be allocated, it should
@@ -354,6 +376,8 @@ struct _MonoClass {
 #define COMPRESSED_INTERFACE_BITMAP 1
 #endif
 	guint8     *interface_bitmap;
+	/* Only set if the class implements at least MONO_INTERFACE_HASH_MIN_COUNT interfaces */
+	MonoInterfaceHash *interface_hash;
 
 	MonoClass **interfaces;
 
@@ -739,6 +763,8 @@ typedef struct {
 	size_t imt_max_collisions_in_slot;
 	size_t imt_method_count_when_max_collisions;
 	size_t imt_thunks_size;
+	size_t imt_thunks_profiled;
+	size_t imt_thunks_with_hot_entries;
 	size_t jit_info_table_insert_count;
 	size_t jit_info_table_remove_count;
 	size_t jit_info_table_lookup_count;
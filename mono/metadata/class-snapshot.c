@@ -0,0 +1,323 @@
+/*
+ * class-snapshot.c: On-disk snapshots of per-image class lookup tables
+ *
+ * Building image->name_cache requires decoding every row of the TypeDef and
+ * ExportedType tables of an image, and every process repeats this for the same
+ * assemblies at startup. When the MONO_CLASS_SNAPSHOT_DIR environment variable
+ * is set, the runtime saves the name cache of each image to a file in that
+ * directory. Later processes memory map the file and look class names up in it
+ * directly, without building the name cache at all.
+ *
+ * Snapshots are keyed on the image GUID (its MVID) and the runtime version, and
+ * are checked against the table sizes of the image, so stale snapshots are
+ * ignored and rewritten.
+ *
+ * Precomputed class layouts and vtables are not stored here, those are
+ * provided by AOT images through mono_aot_get_cached_class_info ().
+ *
+ * Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+
+#include <mono/metadata/class-snapshot.h>
+#include <mono/metadata/metadata-internals.h>
+#include <mono/metadata/tabledefs.h>
+#include <mono/utils/mono-mmap.h>
+#include <mono/utils/mono-logger-internal.h>
+
+#define SNAPSHOT_MAGIC "MONOCSN"
+#define SNAPSHOT_FORMAT_VERSION 1
+
+typedef struct {
+	char magic [8];
+	guint32 format_version;
+	char runtime_version [32];
+	char guid [40];
+	guint32 typedef_rows;
+	guint32 exported_type_rows;
+	guint32 num_entries;
+} SnapshotHeader;
+
+/* Sorted by hash, then by token */
+typedef struct {
+	guint32 hash;
+	guint32 token;
+} SnapshotEntry;
+
+struct _MonoClassSnapshot {
+	MonoFileMap *file;
+	gpointer map;
+	gpointer map_handle;
+	const SnapshotHeader *header;
+	const SnapshotEntry *entries;
+};
+
+static const char *snapshot_dir;
+static gboolean snapshot_dir_inited;
+
+static const char*
+get_snapshot_dir (void)
+{
+	if (!snapshot_dir_inited) {
+		snapshot_dir = g_getenv ("MONO_CLASS_SNAPSHOT_DIR");
+		snapshot_dir_inited = TRUE;
+	}
+	return snapshot_dir;
+}
+
+static gboolean
+image_can_have_snapshot (MonoImage *image)
+{
+	return get_snapshot_dir () && !image_is_dynamic (image) && image->guid && strlen (image->guid) < 40;
+}
+
+static char*
+snapshot_path (MonoImage *image)
+{
+	char *fname, *res;
+
+	fname = g_strdup_printf ("%s-%s.names", image->guid, VERSION);
+	res = g_build_filename (get_snapshot_dir (), fname, NULL);
+	g_free (fname);
+	return res;
+}
+
+static guint32
+name_hash (const char *name_space, const char *name)
+{
+	return mono_metadata_str_hash (name_space) * 31 + mono_metadata_str_hash (name);
+}
+
+static void
+init_header (MonoImage *image, SnapshotHeader *header, guint32 num_entries)
+{
+	memset (header, 0, sizeof (SnapshotHeader));
+	memcpy (header->magic, SNAPSHOT_MAGIC, sizeof (header->magic));
+	header->format_version = SNAPSHOT_FORMAT_VERSION;
+	g_strlcpy (header->runtime_version, VERSION, sizeof (header->runtime_version));
+	g_strlcpy (header->guid, image->guid, sizeof (header->guid));
+	header->typedef_rows = image->tables [MONO_TABLE_TYPEDEF].rows;
+	header->exported_type_rows = image->tables [MONO_TABLE_EXPORTEDTYPE].rows;
+	header->num_entries = num_entries;
+}
+
+static MonoClassSnapshot*
+load_snapshot (MonoImage *image)
+{
+	MonoClassSnapshot *snapshot;
+	SnapshotHeader expected;
+	const SnapshotHeader *header;
+	MonoFileMap *file;
+	gpointer map, map_handle;
+	guint64 size;
+	char *path;
+
+	path = snapshot_path (image);
+	file = mono_file_map_open (path);
+	g_free (path);
+	if (!file)
+		return NULL;
+
+	size = mono_file_map_size (file);
+	if (size < sizeof (SnapshotHeader) || size > G_MAXINT32) {
+		mono_file_map_close (file);
+		return NULL;
+	}
+
+	map = mono_file_map (size, MONO_MMAP_READ | MONO_MMAP_PRIVATE, mono_file_map_fd (file), 0, &map_handle);
+	if (!map) {
+		mono_file_map_close (file);
+		return NULL;
+	}
+
+	header = map;
+	init_header (image, &expected, header->num_entries);
+	if (memcmp (header, &expected, sizeof (SnapshotHeader)) != 0 ||
+		size != sizeof (SnapshotHeader) + (guint64)header->num_entries * sizeof (SnapshotEntry)) {
+		mono_trace (G_LOG_LEVEL_INFO, MONO_TRACE_ASSEMBLY, "Ignoring stale class snapshot for image '%s'.", image->name);
+		mono_file_unmap (map, map_handle);
+		mono_file_map_close (file);
+		return NULL;
+	}
+
+	snapshot = g_new0 (MonoClassSnapshot, 1);
+	snapshot->file = file;
+	snapshot->map = map;
+	snapshot->map_handle = map_handle;
+	snapshot->header = header;
+	snapshot->entries = (const SnapshotEntry*)(header + 1);
+	mono_trace (G_LOG_LEVEL_INFO, MONO_TRACE_ASSEMBLY, "Loaded class snapshot with %d names for image '%s'.", header->num_entries, image->name);
+	return snapshot;
+}
+
+static gboolean
+token_matches (MonoImage *image, guint32 token, const char *name_space, const char *name)
+{
+	MonoTableInfo *t;
+	guint32 idx = mono_metadata_token_index (token);
+	guint32 name_col, nspace_col;
+
+	if (mono_metadata_token_table (token) == MONO_TABLE_EXPORTEDTYPE) {
+		t = &image->tables [MONO_TABLE_EXPORTEDTYPE];
+		name_col = MONO_EXP_TYPE_NAME;
+		nspace_col = MONO_EXP_TYPE_NAMESPACE;
+	} else {
+		t = &image->tables [MONO_TABLE_TYPEDEF];
+		name_col = MONO_TYPEDEF_NAME;
+		nspace_col = MONO_TYPEDEF_NAMESPACE;
+	}
+	if (idx == 0 || idx > t->rows)
+		return FALSE;
+
+	return !strcmp (name, mono_metadata_string_heap (image, mono_metadata_decode_row_col (t, idx - 1, name_col))) &&
+		!strcmp (name_space, mono_metadata_string_heap (image, mono_metadata_decode_row_col (t, idx - 1, nspace_col)));
+}
+
+/*
+ * mono_class_snapshot_lookup_name:
+ *
+ *   Look up the class named NAME_SPACE.NAME in the snapshot of IMAGE's name cache.
+ * Returns FALSE if there is no usable snapshot for IMAGE, in which case the caller
+ * should use image->name_cache. Otherwise, sets TOKEN to the TypeDef or ExportedType
+ * token of the class, or 0 if it is not found, and returns TRUE.
+ * LOCKING: Assumes the image lock is held.
+ */
+gboolean
+mono_class_snapshot_lookup_name (MonoImage *image, const char *name_space, const char *name, guint32 *token)
+{
+	MonoClassSnapshot *snapshot;
+	guint32 hash, lo, hi;
+
+	if (!image->class_snapshot_checked) {
+		if (image_can_have_snapshot (image))
+			image->class_snapshot = load_snapshot (image);
+		image->class_snapshot_checked = TRUE;
+	}
+
+	snapshot = image->class_snapshot;
+	if (!snapshot)
+		return FALSE;
+
+	hash = name_hash (name_space, name);
+	lo = 0;
+	hi = snapshot->header->num_entries;
+	while (lo < hi) {
+		guint32 mid = lo + (hi - lo) / 2;
+		if (snapshot->entries [mid].hash < hash)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	*token = 0;
+	for (; lo < snapshot->header->num_entries && snapshot->entries [lo].hash == hash; ++lo) {
+		if (token_matches (image, snapshot->entries [lo].token, name_space, name)) {
+			*token = snapshot->entries [lo].token;
+			break;
+		}
+	}
+	return TRUE;
+}
+
+typedef struct {
+	const char *name_space;
+	GArray *entries;
+} CollectData;
+
+static void
+collect_name (gpointer key, gpointer value, gpointer user_data)
+{
+	CollectData *data = user_data;
+	SnapshotEntry entry;
+
+	entry.hash = name_hash (data->name_space, key);
+	entry.token = GPOINTER_TO_UINT (value);
+	/* Tokens in the name cache are stored as TypeDef indexes */
+	if (!mono_metadata_token_table (entry.token))
+		entry.token = mono_metadata_make_token (MONO_TABLE_TYPEDEF, entry.token);
+	g_array_append_val (data->entries, entry);
+}
+
+static void
+collect_namespace (gpointer key, gpointer value, gpointer user_data)
+{
+	CollectData *data = user_data;
+
+	data->name_space = key;
+	g_hash_table_foreach (value, collect_name, data);
+}
+
+static int
+compare_entries (const void *a, const void *b)
+{
+	const SnapshotEntry *e1 = a;
+	const SnapshotEntry *e2 = b;
+
+	if (e1->hash != e2->hash)
+		return e1->hash < e2->hash ? -1 : 1;
+	if (e1->token != e2->token)
+		return e1->token < e2->token ? -1 : 1;
+	return 0;
+}
+
+/*
+ * mono_class_snapshot_save_name_cache:
+ *
+ *   Write the contents of image->name_cache to the snapshot directory, if snapshots
+ * are enabled and IMAGE has no snapshot yet.
+ * LOCKING: Assumes the image lock is held.
+ */
+void
+mono_class_snapshot_save_name_cache (MonoImage *image)
+{
+	SnapshotHeader header;
+	CollectData data;
+	GByteArray *buf;
+	GError *error = NULL;
+	char *path;
+
+	if (image->class_snapshot || !image->name_cache || !image_can_have_snapshot (image))
+		return;
+
+	data.name_space = NULL;
+	data.entries = g_array_new (FALSE, FALSE, sizeof (SnapshotEntry));
+	g_hash_table_foreach (image->name_cache, collect_namespace, &data);
+	qsort (data.entries->data, data.entries->len, sizeof (SnapshotEntry), compare_entries);
+
+	init_header (image, &header, data.entries->len);
+	buf = g_byte_array_new ();
+	g_byte_array_append (buf, (guint8*)&header, sizeof (SnapshotHeader));
+	g_byte_array_append (buf, (guint8*)data.entries->data, data.entries->len * sizeof (SnapshotEntry));
+
+#ifndef HOST_WIN32
+	g_mkdir_with_parents (get_snapshot_dir (), 0755);
+#else
+	/* eglib has no g_mkdir_with_parents () on windows, the directory needs to exist */
+#endif
+	path = snapshot_path (image);
+	if (!g_file_set_contents (path, (const gchar*)buf->data, buf->len, &error)) {
+		mono_trace (G_LOG_LEVEL_INFO, MONO_TRACE_ASSEMBLY, "Unable to save class snapshot to '%s': %s.", path, error->message);
+		g_error_free (error);
+	}
+
+	g_free (path);
+	g_byte_array_free (buf, TRUE);
+	g_array_free (data.entries, TRUE);
+}
+
+void
+mono_class_snapshot_free (MonoImage *image)
+{
+	MonoClassSnapshot *snapshot = image->class_snapshot;
+
+	if (!snapshot)
+		return;
+
+	mono_file_unmap (snapshot->map, snapshot->map_handle);
+	mono_file_map_close (snapshot->file);
+	g_free (snapshot);
+	image->class_snapshot = NULL;
+}
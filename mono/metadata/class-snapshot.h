@@ -0,0 +1,25 @@
+/*
+ * class-snapshot.h: On-disk snapshots of per-image class lookup tables
+ *
+ * Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+ */
+
+#ifndef __MONO_METADATA_CLASS_SNAPSHOT_H__
+#define __MONO_METADATA_CLASS_SNAPSHOT_H__
+
+#include <glib.h>
+#include <mono/metadata/image.h>
+#include <mono/utils/mono-compiler.h>
+
+typedef struct _MonoClassSnapshot MonoClassSnapshot;
+
+gboolean
+mono_class_snapshot_lookup_name (MonoImage *image, const char *name_space, const char *name, guint32 *token) MONO_INTERNAL;
+
+void
+mono_class_snapshot_save_name_cache (MonoImage *image) MONO_INTERNAL;
+
+void
+mono_class_snapshot_free (MonoImage *image) MONO_INTERNAL;
+
+#endif /* __MONO_METADATA_CLASS_SNAPSHOT_H__ */
@@ -24,6 +24,7 @@
 #include <mono/metadata/tabledefs.h>
 #include <mono/metadata/tokentype.h>
 #include <mono/metadata/class-internals.h>
+#include <mono/metadata/class-snapshot.h>
 #include <mono/metadata/object.h>
 #include <mono/metadata/appdomain.h>
 #include <mono/metadata/mono-endian.h>
@@ -51,6 +52,7 @@ gboolean mono_print_vtable = FALSE;
 /* Statistics */
 guint32 inflated_classes, inflated_classes_size, inflated_methods_size;
 guint32 classes_size, class_ext_size;
+static guint32 classes_interface_hash, classes_interface_hash_failed, interface_hash_size;
 
 /* Low level lock which protects data structures in this module */
 static mono_mutex_t classes_mutex;
@@ -2839,7 +2841,17 @@ compare_interface_ids (const void *p_key, const void *p_element) {
 /*FIXME verify all callers if they should switch to mono_class_interface_offset_with_variance*/
 int
 mono_class_interface_offset (MonoClass *klass, MonoClass *itf) {
-	MonoClass **result = mono_binary_search (
+	MonoClass **result;
+	MonoInterfaceHash *hash = klass->interface_hash;
+
+	if (hash) {
+		MonoInterfaceHashEntry *entry = &hash->entries [((guint32)itf->interface_id * hash->mult) >> hash->shift];
+		if (entry->iid == itf->interface_id && entry->offset != MONO_INTERFACE_HASH_EMPTY)
+			return entry->offset;
+		return -1;
+	}
+
+	result = mono_binary_search (
 			itf,
 			klass->interfaces_packed,
 			klass->interface_offsets_count,
@@ -3422,6 +3434,94 @@ mono_class_interface_match (const uint8_t *bitmap, int id)
 }
 #endif
 
+#define INTERFACE_HASH_MAX_ATTEMPTS 32
+
+/*
+ * interface_hash_try_mult:
+ *
+ *   Return TRUE if MULT maps the ids of all the COUNT interfaces in INTERFACES to
+ * distinct slots of a table with 2^BITS entries. @used is a scratch buffer of that
+ * many bytes.
+ */
+static gboolean
+interface_hash_try_mult (MonoClass **interfaces, int count, guint32 mult, int bits, guint8 *used)
+{
+	int i;
+
+	memset (used, 0, 1 << bits);
+	for (i = 0; i < count; ++i) {
+		guint32 idx = ((guint32)interfaces [i]->interface_id * mult) >> (32 - bits);
+		if (used [idx])
+			return FALSE;
+		used [idx] = 1;
+	}
+	return TRUE;
+}
+
+/*
+ * build_interface_hash:
+ *
+ *   Compute a perfect hash mapping the ids of the COUNT interfaces in INTERFACES to
+ * the corresponding OFFSETS, allocated from @class. It is used by
+ * mono_class_interface_offset () instead of a binary search of interfaces_packed.
+ * We try a few multipliers with table sizes up to 8 times the number of interfaces, and
+ * give up if none of them is collision free. Returns NULL if no hash could be built, or
+ * if the class implements too few interfaces for it to pay off.
+ */
+static MonoInterfaceHash*
+build_interface_hash (MonoClass *class, MonoClass **interfaces, guint16 *offsets, int count)
+{
+	MonoInterfaceHash *hash;
+	guint8 *used;
+	guint32 mult = 0;
+	int i, bits, min_bits;
+	gboolean found = FALSE;
+
+	if (count < MONO_INTERFACE_HASH_MIN_COUNT)
+		return NULL;
+
+	for (min_bits = 1; (1 << min_bits) < count; ++min_bits)
+		;
+	/* Start with a load factor of at most 0.5 */
+	min_bits ++;
+
+	used = g_malloc (1 << (min_bits + 2));
+	for (bits = min_bits; bits <= min_bits + 2; ++bits) {
+		for (i = 0; i < INTERFACE_HASH_MAX_ATTEMPTS; ++i) {
+			/* Odd multipliers derived from the golden ratio */
+			mult = (0x9e3779b1U + (guint32)i * 0x6a09e668U) | 1;
+			if (interface_hash_try_mult (interfaces, count, mult, bits, used)) {
+				found = TRUE;
+				break;
+			}
+		}
+		if (found)
+			break;
+	}
+	g_free (used);
+
+	if (!found) {
+		++classes_interface_hash_failed;
+		return NULL;
+	}
+
+	hash = mono_class_alloc (class, MONO_SIZEOF_INTERFACE_HASH + sizeof (MonoInterfaceHashEntry) * (1 << bits));
+	hash->mult = mult;
+	hash->shift = 32 - bits;
+	for (i = 0; i < (1 << bits); ++i) {
+		hash->entries [i].iid = MONO_INTERFACE_HASH_EMPTY;
+		hash->entries [i].offset = MONO_INTERFACE_HASH_EMPTY;
+	}
+	for (i = 0; i < count; ++i) {
+		guint32 idx = ((guint32)interfaces [i]->interface_id * mult) >> hash->shift;
+		hash->entries [idx].iid = interfaces [i]->interface_id;
+		hash->entries [idx].offset = offsets [i];
+	}
+	++classes_interface_hash;
+	interface_hash_size += MONO_SIZEOF_INTERFACE_HASH + sizeof (MonoInterfaceHashEntry) * (1 << bits);
+	return hash;
+}
+
 /*
  * LOCKING: this is supposed to be called with the loader lock held.
  * Return -1 on failure and set exception_type
@@ -3615,9 +3715,10 @@ setup_interface_offsets (MonoClass *class, int cur_slot, gboolean overwrite)
 	} else {
 		uint8_t *bitmap;
 		int bsize;
-		class->interface_offsets_count = interface_offsets_count;
-		class->interfaces_packed = mono_class_alloc (class, sizeof (MonoClass*) * interface_offsets_count);
-		class->interface_offsets_packed = mono_class_alloc (class, sizeof (guint16) * interface_offsets_count);
+		MonoClass **interfaces_packed;
+		guint16 *interface_offsets_packed;
+		interfaces_packed = mono_class_alloc (class, sizeof (MonoClass*) * interface_offsets_count);
+		interface_offsets_packed = mono_class_alloc (class, sizeof (guint16) * interface_offsets_count);
 		bsize = (sizeof (guint8) * ((max_iid + 1) >> 3)) + (((max_iid + 1) & 7)? 1 :0);
 #ifdef COMPRESSED_INTERFACE_BITMAP
 		bitmap = g_malloc0 (bsize);
@@ -3627,8 +3728,8 @@ setup_interface_offsets (MonoClass *class, int cur_slot, gboolean overwrite)
 		for (i = 0; i < interface_offsets_count; i++) {
 			int id = interfaces_full [i]->interface_id;
 			bitmap [id >> 3] |= (1 << (id & 7));
-			class->interfaces_packed [i] = interfaces_full [i];
-			class->interface_offsets_packed [i] = interface_offsets_full [i];
+			interfaces_packed [i] = interfaces_full [i];
+			interface_offsets_packed [i] = interface_offsets_full [i];
 			/*if (num_array_interfaces)
 			  g_print ("type %s has %s offset at %d\n", mono_type_get_name_full (&class->byval_arg, 0), mono_type_get_name_full (&interfaces_full [i]->byval_arg, 0), interface_offsets_full [i]);*/
 		}
@@ -3640,6 +3741,15 @@ setup_interface_offsets (MonoClass *class, int cur_slot, gboolean overwrite)
 #else
 		class->interface_bitmap = bitmap;
 #endif
+		/*
+		 * Readers use the hash without looking at interfaces_packed, so publish it first:
+		 * a reader must not see the new interfaces_packed together with the old hash.
+		 */
+		class->interface_hash = build_interface_hash (class, interfaces_packed, interface_offsets_packed, interface_offsets_count);
+		mono_memory_barrier ();
+		class->interface_offsets_count = interface_offsets_count;
+		class->interface_offsets_packed = interface_offsets_packed;
+		class->interfaces_packed = interfaces_packed;
 	}
 
 end:
@@ -7485,6 +7595,9 @@ mono_image_init_name_cache (MonoImage *image)
 	}
 
 	g_hash_table_destroy (name_cache2);
+
+	mono_class_snapshot_save_name_cache (image);
+
 	mono_image_unlock (image);
 }
 
@@ -7718,13 +7831,15 @@ mono_class_from_name (MonoImage *image, const char* name_space, const char *name
 
 	mono_image_lock (image);
 
-	if (!image->name_cache)
-		mono_image_init_name_cache (image);
+	if (!mono_class_snapshot_lookup_name (image, name_space, name, &token)) {
+		if (!image->name_cache)
+			mono_image_init_name_cache (image);
 
-	nspace_table = g_hash_table_lookup (image->name_cache, name_space);
+		nspace_table = g_hash_table_lookup (image->name_cache, name_space);
 
-	if (nspace_table)
-		token = GPOINTER_TO_UINT (g_hash_table_lookup (nspace_table, name));
+		if (nspace_table)
+			token = GPOINTER_TO_UINT (g_hash_table_lookup (nspace_table, name));
+	}
 
 	mono_image_unlock (image);
 
@@ -9696,6 +9811,12 @@ mono_classes_init (void)
 							MONO_COUNTER_METADATA | MONO_COUNTER_INT, &classes_size);
 	mono_counters_register ("MonoClassExt size",
 							MONO_COUNTER_METADATA | MONO_COUNTER_INT, &class_ext_size);
+	mono_counters_register ("Interface hashes",
+							MONO_COUNTER_METADATA | MONO_COUNTER_INT, &classes_interface_hash);
+	mono_counters_register ("Interface hashes failed",
+							MONO_COUNTER_METADATA | MONO_COUNTER_INT, &classes_interface_hash_failed);
+	mono_counters_register ("Interface hashes size",
+							MONO_COUNTER_METADATA | MONO_COUNTER_INT, &interface_hash_size);
 }
 
 /**
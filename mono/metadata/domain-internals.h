@@ -11,8 +11,10 @@
 #include <mono/utils/mono-codeman.h>
 #include <mono/utils/mono-mutex.h>
 #include <mono/metadata/mono-hash.h>
+#include <mono/metadata/string-intern.h>
 #include <mono/utils/mono-compiler.h>
 #include <mono/utils/mono-internal-hash.h>
+#include <mono/utils/mono-conc-hashtable.h>
 #include <mono/io-layer/io-layer.h>
 #include <mono/metadata/mempool-internals.h>
 
@@ -316,7 +318,7 @@ struct _MonoDomain {
 	 */
 #define MONO_DOMAIN_FIRST_GC_TRACKED env
 	MonoGHashTable     *env;
-	MonoGHashTable     *ldstr_table;
+	MonoInternTable    *ldstr_table;
 	/* hashtables for Reflection handles */
 	MonoGHashTable     *type_hash;
 	MonoGHashTable     *refobject_hash;
@@ -380,6 +382,12 @@ struct _MonoDomain {
 
 	GHashTable     *generic_virtual_thunks;
 
+	/* Maps IMT slot addresses to the call profile used to build their thunk */
+	GHashTable     *imt_slot_profiles;
+
+	/* Maps MonoMethod -> how mono_runtime_invoke_array () unpacks its arguments */
+	MonoConcurrentHashTable *invoke_plan_hash;
+
 	/* Information maintained by the JIT engine */
 	gpointer runtime_info;
 
@@ -435,7 +435,7 @@ mono_domain_create (void)
 	domain->proxy_vtable_hash = g_hash_table_new ((GHashFunc)mono_ptrarray_hash, (GCompareFunc)mono_ptrarray_equal);
 	domain->static_data_array = NULL;
 	mono_jit_code_hash_init (&domain->jit_code_hash);
-	domain->ldstr_table = mono_g_hash_table_new_type ((GHashFunc)mono_string_hash, (GCompareFunc)mono_string_equal, MONO_HASH_KEY_VALUE_GC);
+	domain->ldstr_table = mono_intern_table_new ();
 	domain->num_jit_info_tables = 1;
 	domain->jit_info_table = mono_jit_info_table_new (domain);
 	domain->jit_info_free_queue = NULL;
@@ -448,6 +448,7 @@ mono_domain_create (void)
 	mono_mutex_init_recursive (&domain->finalizable_objects_hash_lock);
 
 	domain->method_rgctx_hash = NULL;
+	domain->invoke_plan_hash = mono_conc_hashtable_new_full (&domain->lock, mono_aligned_addr_hash, NULL, NULL, g_free);
 
 	mono_appdomains_lock ();
 	domain_id_alloc (domain);
@@ -911,6 +912,8 @@ mono_init_version (const char *domain_name, const char *version)
 void
 mono_cleanup (void)
 {
+	/* The prefetch threads use the loader and the image hash */
+	mono_assembly_prefetch_cleanup ();
 	mono_close_exe_image ();
 
 	mono_defaults.corlib = NULL;
@@ -1114,7 +1117,7 @@ mono_domain_free (MonoDomain *domain, gboolean force)
 	 * no more such references, or we'll crash if a collection
 	 * occurs.
 	 */
-	mono_g_hash_table_destroy (domain->ldstr_table);
+	mono_intern_table_destroy (domain->ldstr_table);
 	domain->ldstr_table = NULL;
 
 	mono_g_hash_table_destroy (domain->env);
@@ -1267,10 +1270,16 @@ mono_domain_free (MonoDomain *domain, gboolean force)
 		g_hash_table_destroy (domain->generic_virtual_thunks);
 		domain->generic_virtual_thunks = NULL;
 	}
+	if (domain->imt_slot_profiles) {
+		g_hash_table_destroy (domain->imt_slot_profiles);
+		domain->imt_slot_profiles = NULL;
+	}
 	if (domain->ftnptrs_hash) {
 		g_hash_table_destroy (domain->ftnptrs_hash);
 		domain->ftnptrs_hash = NULL;
 	}
+	mono_conc_hashtable_destroy (domain->invoke_plan_hash);
+	domain->invoke_plan_hash = NULL;
 
 	mono_mutex_destroy (&domain->finalizable_objects_hash_lock);
 	mono_mutex_destroy (&domain->assemblies_lock);
@@ -0,0 +1,443 @@
+/*
+ * file-io-uring.c: Asynchronous file I/O through io_uring
+ *
+ * Asynchronous FileStream reads and writes are submitted to an io_uring ring shared
+ * by the whole process, instead of occupying a threadpool thread for the duration of
+ * a blocking ReadFile ()/WriteFile () call. A single completion thread reaps the
+ * results and queues the managed completion callbacks to the IO threadpool.
+ *
+ * MonoIO.SubmitAsync () returns FALSE when io_uring is not available (not Linux, an
+ * older kernel, seccomp filters, or MONO_DISABLE_IO_URING is set), when the ring is
+ * full, or when the kernel refuses the submission, and the caller then falls back to
+ * the synchronous path on a threadpool thread.
+ *
+ * Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+
+#include <mono/metadata/object.h>
+#include <mono/metadata/file-io.h>
+#include <mono/metadata/exception.h>
+#include <mono/metadata/object-internals.h>
+#include <mono/metadata/threadpool-internals.h>
+#include <mono/metadata/threads-types.h>
+#include <mono/metadata/appdomain.h>
+#include <mono/io-layer/io-layer.h>
+#include <mono/utils/atomic.h>
+#include <mono/utils/mono-mutex.h>
+#include <mono/utils/mono-counters.h>
+#include <mono/utils/mono-memory-model.h>
+#include <mono/utils/mono-semaphore.h>
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define HAVE_IO_URING 1
+#endif
+
+#ifdef HAVE_IO_URING
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#define URING_ENTRIES 256
+#define URING_STACK_SIZE (128 * (sizeof (gpointer) / 4) * 1024)
+#define URING_REAP_BATCH 64
+/* user_data of the NOP which wakes up the completion thread at shutdown */
+#define URING_WAKEUP_DATA G_MAXUINT64
+
+typedef struct {
+	struct iovec iov;
+	/* Pinned handle to the managed buffer, the kernel accesses it until completion */
+	guint32 buffer_handle;
+	/* Handle to the threadpool job which runs the managed completion callback */
+	guint32 job_handle;
+	int next_free;
+} UringRequest;
+
+typedef struct {
+	int fd;
+	unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+	struct io_uring_sqe *sqes;
+	unsigned *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_cqe *cqes;
+	/* One slot per CQ entry but one, kept for the wakeup NOP, so the completion queue can't overflow */
+	UringRequest *requests;
+	int free_request;
+} Uring;
+
+enum {
+	URING_UNINITIALIZED,
+	URING_AVAILABLE,
+	URING_UNAVAILABLE
+};
+
+static Uring ring;
+static gint32 uring_state = URING_UNINITIALIZED;
+static mono_mutex_t uring_mutex;
+
+static volatile gboolean uring_stopping;
+static MonoSemType uring_exited_sem;
+
+static gint32 uring_submitted, uring_completed, uring_ring_full, uring_submit_failed;
+
+static int
+sys_io_uring_setup (unsigned entries, struct io_uring_params *p)
+{
+	return syscall (__NR_io_uring_setup, entries, p);
+}
+
+static int
+sys_io_uring_enter (int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return syscall (__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static gboolean
+uring_map (struct io_uring_params *p)
+{
+	size_t sq_size, cq_size;
+	guint8 *sq_ptr, *cq_ptr;
+	gpointer sqes;
+	int i;
+
+	sq_size = p->sq_off.array + p->sq_entries * sizeof (unsigned);
+	cq_size = p->cq_off.cqes + p->cq_entries * sizeof (struct io_uring_cqe);
+	if (p->features & IORING_FEAT_SINGLE_MMAP)
+		sq_size = cq_size = MAX (sq_size, cq_size);
+
+	sq_ptr = mmap (NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+	if (sq_ptr == MAP_FAILED)
+		return FALSE;
+	if (p->features & IORING_FEAT_SINGLE_MMAP) {
+		cq_ptr = sq_ptr;
+	} else {
+		cq_ptr = mmap (NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+		if (cq_ptr == MAP_FAILED)
+			return FALSE;
+	}
+	sqes = mmap (NULL, p->sq_entries * sizeof (struct io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+		return FALSE;
+
+	ring.sq_head = (unsigned *)(sq_ptr + p->sq_off.head);
+	ring.sq_tail = (unsigned *)(sq_ptr + p->sq_off.tail);
+	ring.sq_mask = (unsigned *)(sq_ptr + p->sq_off.ring_mask);
+	ring.sq_array = (unsigned *)(sq_ptr + p->sq_off.array);
+	ring.sqes = sqes;
+	ring.cq_head = (unsigned *)(cq_ptr + p->cq_off.head);
+	ring.cq_tail = (unsigned *)(cq_ptr + p->cq_off.tail);
+	ring.cq_mask = (unsigned *)(cq_ptr + p->cq_off.ring_mask);
+	ring.cqes = (struct io_uring_cqe *)(cq_ptr + p->cq_off.cqes);
+
+	ring.requests = g_new0 (UringRequest, p->cq_entries - 1);
+	for (i = 0; i < p->cq_entries - 1; ++i)
+		ring.requests [i].next_free = i + 1 < p->cq_entries - 1 ? i + 1 : -1;
+	ring.free_request = 0;
+
+	return TRUE;
+}
+
+/*
+ * uring_complete:
+ *
+ *   Store the result RES of the request in slot INDEX into its managed request object, and
+ * return the threadpool job which runs its completion callback.
+ */
+static MonoObject*
+uring_complete (int index, int res)
+{
+	UringRequest *req = &ring.requests [index];
+	MonoAsyncResult *job;
+	MonoIOAsyncRequest *request;
+
+	job = (MonoAsyncResult *) mono_gchandle_get_target (req->job_handle);
+	request = (MonoIOAsyncRequest *) job->async_state;
+	if (res >= 0) {
+		request->bytes_transferred = res;
+		request->error = ERROR_SUCCESS;
+	} else {
+		request->bytes_transferred = 0;
+		request->error = _wapi_get_win32_file_error (-res);
+	}
+
+	mono_gchandle_free (req->buffer_handle);
+	mono_gchandle_free (req->job_handle);
+
+	mono_mutex_lock (&uring_mutex);
+	req->next_free = ring.free_request;
+	ring.free_request = index;
+	mono_mutex_unlock (&uring_mutex);
+
+	return (MonoObject *) job;
+}
+
+/*
+ * uring_submit:
+ *
+ *   Submit the SQE the caller filled in at index TAIL of the submission queue. Entries
+ * are only consumed by the io_uring_enter () calls made here, with uring_mutex held, so
+ * every earlier entry is already consumed. Returns FALSE if the kernel didn't take the
+ * entry, in which case it is removed from the ring again.
+ */
+static gboolean
+uring_submit (unsigned tail)
+{
+	int ret;
+
+	ring.sq_array [tail & *ring.sq_mask] = tail & *ring.sq_mask;
+	mono_memory_write_barrier ();
+	*ring.sq_tail = tail + 1;
+
+	do {
+		ret = sys_io_uring_enter (ring.fd, tail + 1 - *ring.sq_head, 0, 0);
+		mono_memory_read_barrier ();
+		/* Once consumed, the result is reported by a CQE even if the call failed */
+		if (*ring.sq_head == tail + 1)
+			return TRUE;
+	} while (ret == -1 && errno == EINTR);
+
+	/*
+	 * EAGAIN/EBUSY mean the kernel is out of resources or has completions backed up,
+	 * which the completion thread can't reap while uring_mutex is held, so don't wait.
+	 */
+	*ring.sq_tail = tail;
+	InterlockedIncrement (&uring_submit_failed);
+	return FALSE;
+}
+
+static void
+uring_completion_thread (gpointer unused)
+{
+	MonoObject *jobs [URING_REAP_BATCH];
+	unsigned head, tail;
+	int njobs, ret;
+
+	while (!uring_stopping) {
+		ret = sys_io_uring_enter (ring.fd, 0, 1, IORING_ENTER_GETEVENTS);
+		if (ret == -1 && errno != EINTR && errno != EAGAIN) {
+			g_warning ("io_uring_enter () failed: %s", g_strerror (errno));
+			break;
+		}
+
+		head = *ring.cq_head;
+		tail = *ring.cq_tail;
+		mono_memory_read_barrier ();
+
+		njobs = 0;
+		while (head != tail) {
+			struct io_uring_cqe *cqe = &ring.cqes [head & *ring.cq_mask];
+
+			head ++;
+			if (cqe->user_data == URING_WAKEUP_DATA)
+				continue;
+			jobs [njobs ++] = uring_complete ((int) cqe->user_data, cqe->res);
+			if (njobs == URING_REAP_BATCH) {
+				threadpool_append_async_io_jobs (jobs, njobs);
+				njobs = 0;
+			}
+		}
+		mono_memory_barrier ();
+		*ring.cq_head = head;
+
+		if (njobs)
+			threadpool_append_async_io_jobs (jobs, njobs);
+		InterlockedAdd (&uring_completed, njobs);
+	}
+
+	MONO_SEM_POST (&uring_exited_sem);
+}
+
+static gboolean
+uring_init (void)
+{
+	struct io_uring_params params;
+	MonoInternalThread *thread;
+
+	if (g_getenv ("MONO_DISABLE_IO_URING"))
+		return FALSE;
+
+	memset (&params, 0, sizeof (params));
+	ring.fd = sys_io_uring_setup (URING_ENTRIES, &params);
+	if (ring.fd == -1) {
+		if (g_getenv ("MONO_DEBUG"))
+			g_message ("io_uring_setup () failed: %d %s", errno, g_strerror (errno));
+		return FALSE;
+	}
+
+	if (!uring_map (&params)) {
+		if (g_getenv ("MONO_DEBUG"))
+			g_message ("Unable to map the io_uring rings: %d %s", errno, g_strerror (errno));
+		close (ring.fd);
+		return FALSE;
+	}
+
+	mono_counters_register ("Async file I/O submitted", MONO_COUNTER_INT | MONO_COUNTER_RUNTIME, &uring_submitted);
+	mono_counters_register ("Async file I/O completed", MONO_COUNTER_INT | MONO_COUNTER_RUNTIME, &uring_completed);
+	mono_counters_register ("Async file I/O ring full", MONO_COUNTER_INT | MONO_COUNTER_RUNTIME, &uring_ring_full);
+	mono_counters_register ("Async file I/O submit failed", MONO_COUNTER_INT | MONO_COUNTER_RUNTIME, &uring_submit_failed);
+
+	thread = mono_thread_create_internal (mono_get_root_domain (), uring_completion_thread, NULL, TRUE, URING_STACK_SIZE);
+	thread->flags |= MONO_THREAD_FLAG_DONT_MANAGE;
+	return TRUE;
+}
+
+static gboolean
+uring_available (void)
+{
+	if (uring_state == URING_UNINITIALIZED) {
+		mono_mutex_lock (&uring_mutex);
+		if (uring_state == URING_UNINITIALIZED)
+			uring_state = uring_init () ? URING_AVAILABLE : URING_UNAVAILABLE;
+		mono_mutex_unlock (&uring_mutex);
+	}
+	return uring_state == URING_AVAILABLE;
+}
+
+MonoBoolean
+ves_icall_System_IO_MonoIO_SubmitAsync (HANDLE handle, MonoArray *buffer,
+					gint32 offset, gint32 count, gint64 position,
+					MonoBoolean write, MonoObject *request,
+					MonoObject *callback)
+{
+	struct io_uring_sqe *sqe;
+	UringRequest *req;
+	MonoObject *job;
+	unsigned tail;
+	int index;
+
+	MONO_CHECK_ARG_NULL (buffer);
+	MONO_CHECK_ARG_NULL (request);
+	MONO_CHECK_ARG_NULL (callback);
+
+	if (offset < 0 || count < 0 || offset > mono_array_length (buffer) - count)
+		mono_raise_exception (mono_get_exception_argument ("array", "array too small. numBytes/offset wrong."));
+
+	if (!uring_available () || GetFileType (handle) != FILE_TYPE_DISK)
+		return FALSE;
+
+	job = mono_thread_pool_new_io_job (callback, request);
+
+	mono_mutex_lock (&uring_mutex);
+
+	if (uring_state != URING_AVAILABLE) {
+		/* Shut down in the meantime */
+		mono_mutex_unlock (&uring_mutex);
+		return FALSE;
+	}
+
+	tail = *ring.sq_tail;
+	if (ring.free_request == -1 || tail - *ring.sq_head >= *ring.sq_mask + 1) {
+		mono_mutex_unlock (&uring_mutex);
+		InterlockedIncrement (&uring_ring_full);
+		return FALSE;
+	}
+
+	index = ring.free_request;
+	req = &ring.requests [index];
+	ring.free_request = req->next_free;
+
+	req->iov.iov_base = mono_array_addr (buffer, guint8, offset);
+	req->iov.iov_len = count;
+	req->buffer_handle = mono_gchandle_new ((MonoObject *) buffer, TRUE);
+	req->job_handle = mono_gchandle_new (job, FALSE);
+
+	sqe = &ring.sqes [tail & *ring.sq_mask];
+	memset (sqe, 0, sizeof (struct io_uring_sqe));
+	sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+	sqe->fd = GPOINTER_TO_INT (handle);
+	sqe->addr = (guint64)(gsize) &req->iov;
+	sqe->len = 1;
+	sqe->off = position;
+	sqe->user_data = index;
+
+	if (!uring_submit (tail)) {
+		/* The caller does the I/O synchronously instead */
+		mono_gchandle_free (req->buffer_handle);
+		mono_gchandle_free (req->job_handle);
+		req->next_free = ring.free_request;
+		ring.free_request = index;
+		mono_mutex_unlock (&uring_mutex);
+		return FALSE;
+	}
+
+	mono_mutex_unlock (&uring_mutex);
+
+	InterlockedIncrement (&uring_submitted);
+	return TRUE;
+}
+
+void
+mono_file_io_uring_init (void)
+{
+	mono_mutex_init (&uring_mutex);
+	MONO_SEM_INIT (&uring_exited_sem, 0);
+}
+
+/*
+ * mono_file_io_uring_cleanup:
+ *
+ *   Stop the completion thread, before the threadpool it queues jobs to is shut down.
+ * Requests which are still in flight are never completed.
+ */
+void
+mono_file_io_uring_cleanup (void)
+{
+	struct io_uring_sqe *sqe;
+	unsigned tail;
+	gboolean woken;
+
+	mono_mutex_lock (&uring_mutex);
+	if (uring_state != URING_AVAILABLE) {
+		uring_state = URING_UNAVAILABLE;
+		mono_mutex_unlock (&uring_mutex);
+		return;
+	}
+	uring_state = URING_UNAVAILABLE;
+	uring_stopping = TRUE;
+
+	/* The completion thread blocks in io_uring_enter () until a CQE arrives */
+	tail = *ring.sq_tail;
+	sqe = &ring.sqes [tail & *ring.sq_mask];
+	memset (sqe, 0, sizeof (struct io_uring_sqe));
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = URING_WAKEUP_DATA;
+	woken = uring_submit (tail);
+	mono_mutex_unlock (&uring_mutex);
+
+	if (woken)
+		MONO_SEM_WAIT_UNITERRUPTIBLE (&uring_exited_sem);
+	else
+		g_warning ("Unable to wake up the io_uring completion thread");
+}
+
+#else
+
+MonoBoolean
+ves_icall_System_IO_MonoIO_SubmitAsync (HANDLE handle, MonoArray *buffer,
+					gint32 offset, gint32 count, gint64 position,
+					MonoBoolean write, MonoObject *request,
+					MonoObject *callback)
+{
+	return FALSE;
+}
+
+void
+mono_file_io_uring_init (void)
+{
+}
+
+void
+mono_file_io_uring_cleanup (void)
+{
+}
+
+#endif /* HAVE_IO_URING */
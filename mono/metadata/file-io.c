@@ -24,6 +24,13 @@
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
 #endif
+#ifdef HAVE_DIRENT_H
+#include <dirent.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#include <fcntl.h>
 
 #include <mono/metadata/object.h>
 #include <mono/io-layer/io-layer.h>
@@ -512,6 +519,296 @@ ves_icall_System_IO_MonoIO_FindClose (gpointer handle)
 	return error;
 }
 
+#if !defined(HOST_WIN32) && defined(HAVE_DIRENT_H)
+
+#if defined(__linux__) && defined(HAVE_SYS_SYSCALL_H) && defined(SYS_getdents64)
+#define USE_GETDENTS64 1
+
+struct linux_dirent64 {
+	guint64 d_ino;
+	gint64 d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name [];
+};
+#endif
+
+#define DIRECTORY_READER_BUFFER_SIZE 32768
+
+/*
+ * Reads the entries of a directory in the batches returned by the kernel, instead of
+ * globbing the whole directory up front like FindFirstFile () does. The type of an
+ * entry usually comes with it, so only symlinks and entries on file systems which
+ * don't report types need a stat () call. Everything else about an entry, like the
+ * read-only flag, is only looked up when managed code asks for it.
+ */
+typedef struct {
+#ifdef USE_GETDENTS64
+	int fd;
+	int buf_pos, buf_len;
+	char buf [DIRECTORY_READER_BUFFER_SIZE];
+#else
+	DIR *dir;
+#endif
+	/* The UTF-16 directory name, ending in a separator */
+	gunichar2 *prefix;
+	int prefix_len;
+	/* The UTF-8 directory name, ending in a separator, used for stat () */
+	GString *utf8_path;
+	int utf8_path_len;
+	/* An error hit after some entries were returned, reported by the next read */
+	gint32 pending_error;
+} DirectoryReader;
+
+/*
+ * directory_entry_attributes:
+ *
+ *   Compute the type attributes (directory, normal, hidden and reparse point) of the
+ * entry NAME, or return -1 if it was removed in the meantime.
+ */
+static gint32
+directory_entry_attributes (DirectoryReader *reader, const char *name, unsigned char type)
+{
+	struct stat buf, lbuf;
+	gint32 attrs;
+
+	switch (type) {
+	case DT_DIR:
+		attrs = FILE_ATTRIBUTE_DIRECTORY;
+		break;
+	case DT_REG:
+	case DT_FIFO:
+	case DT_CHR:
+	case DT_BLK:
+	case DT_SOCK:
+		attrs = FILE_ATTRIBUTE_NORMAL;
+		break;
+	default:
+		/* Symlinks are reported with the type of their target, like FindNextFile () does */
+		g_string_truncate (reader->utf8_path, reader->utf8_path_len);
+		g_string_append (reader->utf8_path, name);
+		if (lstat (reader->utf8_path->str, &lbuf) == -1)
+			return -1;
+
+		attrs = 0;
+		if (S_ISLNK (lbuf.st_mode)) {
+			attrs = FILE_ATTRIBUTE_REPARSE_POINT;
+			if (stat (reader->utf8_path->str, &buf) == 0)
+				lbuf = buf;
+		}
+		attrs |= S_ISDIR (lbuf.st_mode) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+		break;
+	}
+
+	if (name [0] == '.') {
+		attrs &= ~FILE_ATTRIBUTE_NORMAL;
+		attrs |= FILE_ATTRIBUTE_HIDDEN;
+	}
+	return attrs;
+}
+
+/*
+ * directory_reader_next:
+ *
+ *   Return the name and the type of the next entry, or NULL at the end of the
+ * directory or on error, in which case *ERROR is set.
+ */
+static const char *
+directory_reader_next (DirectoryReader *reader, unsigned char *type, gint32 *error)
+{
+#ifdef USE_GETDENTS64
+	struct linux_dirent64 *ent;
+
+	if (reader->buf_pos >= reader->buf_len) {
+		int n;
+
+		do {
+			n = syscall (SYS_getdents64, reader->fd, reader->buf, DIRECTORY_READER_BUFFER_SIZE);
+		} while (n == -1 && errno == EINTR);
+		if (n <= 0) {
+			if (n == -1)
+				*error = _wapi_get_win32_file_error (errno);
+			return NULL;
+		}
+		reader->buf_pos = 0;
+		reader->buf_len = n;
+	}
+
+	ent = (struct linux_dirent64 *) (reader->buf + reader->buf_pos);
+	reader->buf_pos += ent->d_reclen;
+	*type = ent->d_type;
+	return ent->d_name;
+#else
+	struct dirent *ent;
+
+	errno = 0;
+	ent = readdir (reader->dir);
+	if (!ent) {
+		if (errno)
+			*error = _wapi_get_win32_file_error (errno);
+		return NULL;
+	}
+#ifdef DT_UNKNOWN
+	*type = ent->d_type;
+#else
+	*type = 0;
+#endif
+	return ent->d_name;
+#endif
+}
+
+gpointer
+ves_icall_System_IO_MonoIO_OpenDirectory (MonoString *path, gint32 *error)
+{
+	DirectoryReader *reader;
+	gchar *utf8_path;
+	int len;
+
+	*error = ERROR_SUCCESS;
+
+	/* Let the FindFirstFile () path deal with case-insensitive file names */
+	if (IS_PORTABILITY_SET) {
+		*error = ERROR_NOT_SUPPORTED;
+		return NULL;
+	}
+
+	utf8_path = mono_unicode_to_external (mono_string_chars (path));
+	if (!utf8_path) {
+		*error = ERROR_INVALID_NAME;
+		return NULL;
+	}
+
+	reader = g_new0 (DirectoryReader, 1);
+#ifdef USE_GETDENTS64
+	reader->fd = open (utf8_path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (reader->fd == -1) {
+#else
+	reader->dir = opendir (utf8_path);
+	if (!reader->dir) {
+#endif
+		*error = _wapi_get_win32_file_error (errno);
+		g_free (utf8_path);
+		g_free (reader);
+		return NULL;
+	}
+
+	reader->utf8_path = g_string_new (utf8_path);
+	if (reader->utf8_path->len == 0 || reader->utf8_path->str [reader->utf8_path->len - 1] != G_DIR_SEPARATOR)
+		g_string_append_c (reader->utf8_path, G_DIR_SEPARATOR);
+	reader->utf8_path_len = reader->utf8_path->len;
+	g_free (utf8_path);
+
+	len = mono_string_length (path);
+	reader->prefix = g_new (gunichar2, len + 1);
+	memcpy (reader->prefix, mono_string_chars (path), len * sizeof (gunichar2));
+	if (len == 0 || reader->prefix [len - 1] != G_DIR_SEPARATOR)
+		reader->prefix [len++] = G_DIR_SEPARATOR;
+	reader->prefix_len = len;
+
+	return reader;
+}
+
+/*
+ * ves_icall_System_IO_MonoIO_ReadDirectory:
+ *
+ *   Store the full names and the type attributes (directory, normal, hidden and
+ * reparse point) of the next entries of the directory in NAMES and ATTRS. Returns the
+ * number of entries stored, 0 at the end of the directory or on error. An error hit
+ * after some entries were stored is reported by the next call.
+ */
+gint32
+ves_icall_System_IO_MonoIO_ReadDirectory (gpointer handle, MonoArray *names, MonoArray *attrs, gint32 *error)
+{
+	DirectoryReader *reader = handle;
+	MonoDomain *domain = mono_domain_get ();
+	const char *name;
+	unsigned char type;
+	gint32 count = 0, max;
+
+	*error = ERROR_SUCCESS;
+	if (reader->pending_error != ERROR_SUCCESS) {
+		*error = reader->pending_error;
+		return 0;
+	}
+
+	max = MIN (mono_array_length (names), mono_array_length (attrs));
+
+	while (count < max && (name = directory_reader_next (reader, &type, error))) {
+		MonoString *full_name;
+		gunichar2 *utf16_name;
+		glong utf16_len;
+		gint32 entry_attrs;
+
+		if ((name [0] == '.' && name [1] == 0) || (name [0] == '.' && name [1] == '.' && name [2] == 0))
+			continue;
+
+		entry_attrs = directory_entry_attributes (reader, name, type);
+		/* The entry was removed while reading the directory */
+		if (entry_attrs == -1)
+			continue;
+
+		utf16_name = mono_unicode_from_external (name, NULL);
+		if (!utf16_name)
+			continue;
+		for (utf16_len = 0; utf16_name [utf16_len]; ++utf16_len)
+			;
+
+		full_name = mono_string_new_size (domain, reader->prefix_len + utf16_len);
+		memcpy (mono_string_chars (full_name), reader->prefix, reader->prefix_len * sizeof (gunichar2));
+		memcpy (mono_string_chars (full_name) + reader->prefix_len, utf16_name, utf16_len * sizeof (gunichar2));
+		g_free (utf16_name);
+
+		mono_array_setref (names, count, full_name);
+		mono_array_set (attrs, gint32, count, entry_attrs);
+		count ++;
+	}
+
+	if (count > 0 && *error != ERROR_SUCCESS) {
+		reader->pending_error = *error;
+		*error = ERROR_SUCCESS;
+	}
+	return count;
+}
+
+void
+ves_icall_System_IO_MonoIO_CloseDirectory (gpointer handle)
+{
+	DirectoryReader *reader = handle;
+
+#ifdef USE_GETDENTS64
+	close (reader->fd);
+#else
+	closedir (reader->dir);
+#endif
+	g_string_free (reader->utf8_path, TRUE);
+	g_free (reader->prefix);
+	g_free (reader);
+}
+
+#else
+
+gpointer
+ves_icall_System_IO_MonoIO_OpenDirectory (MonoString *path, gint32 *error)
+{
+	/* Managed code falls back to FindFirst/FindNext */
+	*error = ERROR_NOT_SUPPORTED;
+	return NULL;
+}
+
+gint32
+ves_icall_System_IO_MonoIO_ReadDirectory (gpointer handle, MonoArray *names, MonoArray *attrs, gint32 *error)
+{
+	*error = ERROR_NOT_SUPPORTED;
+	return 0;
+}
+
+void
+ves_icall_System_IO_MonoIO_CloseDirectory (gpointer handle)
+{
+}
+
+#endif
+
 MonoString *
 ves_icall_System_IO_MonoIO_GetCurrentDirectory (gint32 *error)
 {
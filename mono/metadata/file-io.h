@@ -111,6 +111,13 @@ typedef struct _MonoFSAsyncResult {
 	MonoDelegate *real_cb;
 } MonoFSAsyncResult;
 */
+/* This is a copy of System.IO.MonoIOAsyncRequest */
+typedef struct _MonoIOAsyncRequest {
+	MonoObject obj;
+	gint32 bytes_transferred;
+	gint32 error;
+} MonoIOAsyncRequest;
+
 /* System.IO.MonoIO */
 
 extern MonoBoolean
@@ -137,6 +144,15 @@ ves_icall_System_IO_MonoIO_FindNext (gpointer handle, gint32 *result_mask, gint3
 extern int
 ves_icall_System_IO_MonoIO_FindClose (gpointer handle) MONO_INTERNAL;
 
+extern gpointer
+ves_icall_System_IO_MonoIO_OpenDirectory (MonoString *path, gint32 *error) MONO_INTERNAL;
+
+extern gint32
+ves_icall_System_IO_MonoIO_ReadDirectory (gpointer handle, MonoArray *names, MonoArray *attrs, gint32 *error) MONO_INTERNAL;
+
+extern void
+ves_icall_System_IO_MonoIO_CloseDirectory (gpointer handle) MONO_INTERNAL;
+
 extern MonoString *
 ves_icall_System_IO_MonoIO_GetCurrentDirectory (gint32 *error) MONO_INTERNAL;
 
@@ -187,6 +203,12 @@ ves_icall_System_IO_MonoIO_Write (HANDLE handle, MonoArray *src,
 				  gint32 src_offset, gint32 count,
 				  gint32 *error) MONO_INTERNAL;
 
+extern MonoBoolean
+ves_icall_System_IO_MonoIO_SubmitAsync (HANDLE handle, MonoArray *buffer,
+					gint32 offset, gint32 count, gint64 position,
+					MonoBoolean write, MonoObject *request,
+					MonoObject *callback) MONO_INTERNAL;
+
 extern gint64 
 ves_icall_System_IO_MonoIO_Seek (HANDLE handle, gint64 offset, gint32 origin,
 				 gint32 *error) MONO_INTERNAL;
@@ -251,6 +273,12 @@ ves_icall_System_IO_MonoIO_ReplaceFile (MonoString *sourceFileName, MonoString *
 					MonoString *destinationBackupFileName, MonoBoolean ignoreMetadataErrors,
 					gint32 *error) MONO_INTERNAL;
 
+extern void
+mono_file_io_uring_init (void) MONO_INTERNAL;
+
+extern void
+mono_file_io_uring_cleanup (void) MONO_INTERNAL;
+
 extern gint64
 mono_filesize_from_path (MonoString *path);
 
@@ -43,12 +43,17 @@ typedef struct {
 	size_t capacity;
 	char *name;
 	int fd;
+	int options;
 } MmapHandle;
 
 typedef struct {
 	void *address;
 	void *free_handle;
 	size_t length;
+	/* offset of the start of the view from address */
+	size_t view_offset;
+	/* copy-on-write view, its writes live only in its private pages */
+	gboolean is_private;
 } MmapInstance;
 
 enum {
@@ -81,6 +86,21 @@ enum {
 	MMAP_FILE_ACCESS_READ_WRITE_EXECUTE = 5,
 };
 
+/* Mono specific MemoryMappedFileOptions, see MemoryMappedFileHints */
+enum {
+	MMAP_OPTIONS_POPULATE = 1 << 0,
+	MMAP_OPTIONS_HUGE_PAGES = 1 << 1,
+};
+
+/* Keep in sync with MemoryMappedViewAdvice */
+enum {
+	MMAP_ADVICE_NORMAL = 0,
+	MMAP_ADVICE_SEQUENTIAL = 1,
+	MMAP_ADVICE_RANDOM = 2,
+	MMAP_ADVICE_WILL_NEED = 3,
+	MMAP_ADVICE_DONT_NEED = 4,
+};
+
 #ifdef DEFFILEMODE
 #define DEFAULT_FILEMODE DEFFILEMODE
 #else
@@ -221,7 +241,7 @@ is_special_zero_size_file (struct stat *buf)
 }
 
 /*
-XXX implement options
+Only the mono specific hints in OPTIONS are implemented, they are applied by mono_mmap_map ().
 */
 static void*
 open_file_map (MonoString *path, int input_fd, int mode, gint64 *capacity, int access, int options, int *error)
@@ -288,6 +308,7 @@ open_file_map (MonoString *path, int input_fd, int mode, gint64 *capacity, int a
 	handle->ref_count = 1;
 	handle->capacity = *capacity;
 	handle->fd = fd;
+	handle->options = options;
 
 done:
 	g_free (c_path);
@@ -357,6 +378,7 @@ open_memory_map (MonoString *mapName, int mode, gint64 *capacity, int access, in
 		handle->ref_count = 1;
 		handle->capacity = *capacity;
 		handle->fd = fd;
+		handle->options = options;
 		handle->name = g_strdup (c_mapName);
 
 		g_hash_table_insert (named_regions, handle->name, handle);
@@ -477,6 +499,7 @@ mono_mmap_map (void *handle, gint64 offset, gint64 *size, int access, void **mma
 	MmapInstance res = { 0 };
 	size_t eff_size = *size;
 	struct stat buf = { 0 };
+	int flags;
 	fstat (fh->fd, &buf); //FIXME error handling
 
 	if (offset > buf.st_size || ((eff_size + offset) > buf.st_size && !is_special_zero_size_file (&buf)))
@@ -492,11 +515,21 @@ mono_mmap_map (void *handle, gint64 offset, gint64 *size, int access, void **mma
 
 	mmap_offset = align_down_to_page_size (offset);
 	eff_size += (offset - mmap_offset);
+	flags = acess_to_mmap_flags (access);
+	if (fh->options & MMAP_OPTIONS_POPULATE)
+		flags |= MONO_MMAP_POPULATE;
 	//FIXME translate some interesting errno values
-	res.address = mono_file_map ((size_t)eff_size, acess_to_mmap_flags (access), fh->fd, mmap_offset, &res.free_handle);
+	res.address = mono_file_map ((size_t)eff_size, flags, fh->fd, mmap_offset, &res.free_handle);
 	res.length = eff_size;
+	res.view_offset = offset - mmap_offset;
+	res.is_private = (flags & MONO_MMAP_PRIVATE) != 0;
 
 	if (res.address) {
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+		/* This is only a hint, not every file system supports huge pages for file mappings */
+		if (fh->options & MMAP_OPTIONS_HUGE_PAGES)
+			madvise (res.address, res.length, MADV_HUGEPAGE);
+#endif
 		*mmap_handle = g_memdup (&res, sizeof (MmapInstance));
 		*base_address = (char*)res.address + (offset - mmap_offset);
 		return 0;
@@ -520,4 +553,83 @@ mono_mmap_unmap (void *mmap_handle)
 	return res == 0;
 }
 
+/*
+ * mono_mmap_advise:
+ *
+ *   Tell the kernel how the range [OFFSET, OFFSET + LENGTH) of the view MMAP_HANDLE
+ * will be accessed. OFFSET is relative to the start of the view, a LENGTH of 0 means
+ * up to the end of the view. This is only a hint, so it is a no-op where the OS
+ * doesn't support it.
+ */
+gboolean
+mono_mmap_advise (void *mmap_handle, gint64 offset, gint64 length, int advice)
+{
+	MmapInstance *h = mmap_handle;
+	gint64 start, end;
+	int res;
+
+	if (!h || offset < 0 || length < 0)
+		return FALSE;
+
+	start = h->view_offset + offset;
+	end = length ? start + length : h->length;
+	if (start > h->length || end > h->length)
+		return FALSE;
+	/* The range has to start at a page boundary */
+	start = align_down_to_page_size (start);
+	if (end <= start)
+		return TRUE;
+
+	/* Dropping the pages of a copy-on-write view would throw away its writes */
+	if (advice == MMAP_ADVICE_DONT_NEED && h->is_private)
+		return TRUE;
+
+#if defined(HAVE_MADVISE)
+	switch (advice) {
+	case MMAP_ADVICE_NORMAL:
+		advice = MADV_NORMAL;
+		break;
+	case MMAP_ADVICE_SEQUENTIAL:
+		advice = MADV_SEQUENTIAL;
+		break;
+	case MMAP_ADVICE_RANDOM:
+		advice = MADV_RANDOM;
+		break;
+	case MMAP_ADVICE_WILL_NEED:
+		advice = MADV_WILLNEED;
+		break;
+	case MMAP_ADVICE_DONT_NEED:
+		advice = MADV_DONTNEED;
+		break;
+	default:
+		return FALSE;
+	}
+	res = madvise ((char*)h->address + start, end - start, advice);
+#elif defined(HAVE_POSIX_MADVISE)
+	switch (advice) {
+	case MMAP_ADVICE_NORMAL:
+		advice = POSIX_MADV_NORMAL;
+		break;
+	case MMAP_ADVICE_SEQUENTIAL:
+		advice = POSIX_MADV_SEQUENTIAL;
+		break;
+	case MMAP_ADVICE_RANDOM:
+		advice = POSIX_MADV_RANDOM;
+		break;
+	case MMAP_ADVICE_WILL_NEED:
+		advice = POSIX_MADV_WILLNEED;
+		break;
+	case MMAP_ADVICE_DONT_NEED:
+		advice = POSIX_MADV_DONTNEED;
+		break;
+	default:
+		return FALSE;
+	}
+	res = posix_madvise ((char*)h->address + start, end - start, advice);
+#else
+	res = 0;
+#endif
+	return res == 0;
+}
+
 #endif
@@ -67,4 +67,11 @@ mono_mmap_unmap (void *mmap_handle)
 	return TRUE;
 }
 
+gboolean
+mono_mmap_advise (void *mmap_handle, gint64 offset, gint64 length, int advice)
+{
+	g_error ("No windows backend");
+	return FALSE;
+}
+
 #endif
@@ -31,4 +31,6 @@ extern int mono_mmap_map (void *handle, gint64 offset, gint64 *size, int access,
 
 extern gboolean mono_mmap_unmap (void *base_address) MONO_INTERNAL;
 
+extern gboolean mono_mmap_advise (void *mmap_handle, gint64 offset, gint64 length, int advice) MONO_INTERNAL;
+
 #endif /* _MONO_METADATA_FILE_MMAP_H_ */
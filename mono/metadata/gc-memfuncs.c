@@ -38,6 +38,13 @@
 
 #include "metadata/gc-internal.h"
 
+#if (defined(__i386__) || defined(__x86_64__)) && (defined(TARGET_X86) || defined(TARGET_AMD64)) && !defined(MONO_CROSS_COMPILE) && \
+	(defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define HAVE_SIMD_MEMFUNCS 1
+#include <immintrin.h>
+#include "utils/mono-hwcap-x86.h"
+#endif
+
 #define ptr_mask ((sizeof (void*) - 1))
 #define _toi(ptr) ((size_t)ptr)
 #define unaligned_bytes(ptr) (_toi(ptr) & ptr_mask)
@@ -51,6 +58,231 @@
 #error We only support 32 and 64 bit architectures.
 #endif
 
+#ifdef HAVE_SIMD_MEMFUNCS
+
+/*
+ * Vector versions of the word loops, used for blocks of at least SIMD_MIN_SIZE bytes.
+ *
+ * The destination is first brought to vector alignment with word stores, and the rest of
+ * the block is written with aligned 16 or 32 byte stores. Every naturally aligned word
+ * inside an aligned vector store is written atomically, which is all the GC needs. Loads
+ * can be unaligned, both pointers are word aligned so they don't split a word either.
+ *
+ * Each function handles a prefix (or for the _down variants, a suffix) of the block and
+ * returns its size, a multiple of the word size. The caller finishes the rest with the
+ * plain word loops.
+ */
+
+#define SIMD_MIN_SIZE 128
+
+typedef enum {
+	SIMD_NONE,
+	SIMD_SSE2,
+	SIMD_AVX2
+} SimdLevel;
+
+static inline SimdLevel
+get_simd_level (void)
+{
+	if (mono_hwcap_x86_has_avx2)
+		return SIMD_AVX2;
+#ifdef __SSE2__
+	return SIMD_SSE2;
+#else
+	return mono_hwcap_x86_has_sse2 ? SIMD_SSE2 : SIMD_NONE;
+#endif
+}
+
+#define WORD_COPY(d,s) (*(void* volatile*)(d) = *(void**)(s))
+
+static __attribute__((target("sse2"))) size_t
+bzero_sse2 (char *dest, size_t size)
+{
+	char *d = dest, *end = dest + size;
+	__m128i zero = _mm_setzero_si128 ();
+
+	while (_toi (d) & 15) {
+		*(void* volatile*)d = NULL;
+		d += sizeof (void*);
+	}
+	for (; end - d >= 64; d += 64) {
+		((volatile __m128i*)d) [0] = zero;
+		((volatile __m128i*)d) [1] = zero;
+		((volatile __m128i*)d) [2] = zero;
+		((volatile __m128i*)d) [3] = zero;
+	}
+	for (; end - d >= 16; d += 16)
+		*(volatile __m128i*)d = zero;
+	return d - dest;
+}
+
+static __attribute__((target("avx2"))) size_t
+bzero_avx2 (char *dest, size_t size)
+{
+	char *d = dest, *end = dest + size;
+	__m256i zero = _mm256_setzero_si256 ();
+
+	while (_toi (d) & 31) {
+		*(void* volatile*)d = NULL;
+		d += sizeof (void*);
+	}
+	for (; end - d >= 128; d += 128) {
+		((volatile __m256i*)d) [0] = zero;
+		((volatile __m256i*)d) [1] = zero;
+		((volatile __m256i*)d) [2] = zero;
+		((volatile __m256i*)d) [3] = zero;
+	}
+	for (; end - d >= 32; d += 32)
+		*(volatile __m256i*)d = zero;
+	return d - dest;
+}
+
+static __attribute__((target("sse2"))) size_t
+memmove_up_sse2 (char *dest, const char *src, size_t size)
+{
+	char *d = dest, *end = dest + size;
+	const char *s = src;
+
+	while (_toi (d) & 15) {
+		WORD_COPY (d, s);
+		d += sizeof (void*);
+		s += sizeof (void*);
+	}
+	/* Load a whole block before storing it, so overlapping moves work */
+	for (; end - d >= 64; d += 64, s += 64) {
+		__m128i v0 = _mm_loadu_si128 ((const __m128i*)s);
+		__m128i v1 = _mm_loadu_si128 ((const __m128i*)s + 1);
+		__m128i v2 = _mm_loadu_si128 ((const __m128i*)s + 2);
+		__m128i v3 = _mm_loadu_si128 ((const __m128i*)s + 3);
+		((volatile __m128i*)d) [0] = v0;
+		((volatile __m128i*)d) [1] = v1;
+		((volatile __m128i*)d) [2] = v2;
+		((volatile __m128i*)d) [3] = v3;
+	}
+	for (; end - d >= 16; d += 16, s += 16)
+		*(volatile __m128i*)d = _mm_loadu_si128 ((const __m128i*)s);
+	return d - dest;
+}
+
+static __attribute__((target("avx2"))) size_t
+memmove_up_avx2 (char *dest, const char *src, size_t size)
+{
+	char *d = dest, *end = dest + size;
+	const char *s = src;
+
+	while (_toi (d) & 31) {
+		WORD_COPY (d, s);
+		d += sizeof (void*);
+		s += sizeof (void*);
+	}
+	for (; end - d >= 128; d += 128, s += 128) {
+		__m256i v0 = _mm256_loadu_si256 ((const __m256i*)s);
+		__m256i v1 = _mm256_loadu_si256 ((const __m256i*)s + 1);
+		__m256i v2 = _mm256_loadu_si256 ((const __m256i*)s + 2);
+		__m256i v3 = _mm256_loadu_si256 ((const __m256i*)s + 3);
+		((volatile __m256i*)d) [0] = v0;
+		((volatile __m256i*)d) [1] = v1;
+		((volatile __m256i*)d) [2] = v2;
+		((volatile __m256i*)d) [3] = v3;
+	}
+	for (; end - d >= 32; d += 32, s += 32)
+		*(volatile __m256i*)d = _mm256_loadu_si256 ((const __m256i*)s);
+	return d - dest;
+}
+
+static __attribute__((target("sse2"))) size_t
+memmove_down_sse2 (char *dest, const char *src, size_t size)
+{
+	char *d = dest + size;
+	const char *s = src + size;
+
+	while (_toi (d) & 15) {
+		d -= sizeof (void*);
+		s -= sizeof (void*);
+		WORD_COPY (d, s);
+	}
+	for (; d - dest >= 64; d -= 64, s -= 64) {
+		__m128i v0 = _mm_loadu_si128 ((const __m128i*)s - 4);
+		__m128i v1 = _mm_loadu_si128 ((const __m128i*)s - 3);
+		__m128i v2 = _mm_loadu_si128 ((const __m128i*)s - 2);
+		__m128i v3 = _mm_loadu_si128 ((const __m128i*)s - 1);
+		((volatile __m128i*)d) [-4] = v0;
+		((volatile __m128i*)d) [-3] = v1;
+		((volatile __m128i*)d) [-2] = v2;
+		((volatile __m128i*)d) [-1] = v3;
+	}
+	for (; d - dest >= 16; d -= 16, s -= 16)
+		((volatile __m128i*)d) [-1] = _mm_loadu_si128 ((const __m128i*)s - 1);
+	return dest + size - d;
+}
+
+static __attribute__((target("avx2"))) size_t
+memmove_down_avx2 (char *dest, const char *src, size_t size)
+{
+	char *d = dest + size;
+	const char *s = src + size;
+
+	while (_toi (d) & 31) {
+		d -= sizeof (void*);
+		s -= sizeof (void*);
+		WORD_COPY (d, s);
+	}
+	for (; d - dest >= 128; d -= 128, s -= 128) {
+		__m256i v0 = _mm256_loadu_si256 ((const __m256i*)s - 4);
+		__m256i v1 = _mm256_loadu_si256 ((const __m256i*)s - 3);
+		__m256i v2 = _mm256_loadu_si256 ((const __m256i*)s - 2);
+		__m256i v3 = _mm256_loadu_si256 ((const __m256i*)s - 1);
+		((volatile __m256i*)d) [-4] = v0;
+		((volatile __m256i*)d) [-3] = v1;
+		((volatile __m256i*)d) [-2] = v2;
+		((volatile __m256i*)d) [-1] = v3;
+	}
+	for (; d - dest >= 32; d -= 32, s -= 32)
+		((volatile __m256i*)d) [-1] = _mm256_loadu_si256 ((const __m256i*)s - 1);
+	return dest + size - d;
+}
+
+static size_t
+bzero_simd (char *dest, size_t size)
+{
+	switch (get_simd_level ()) {
+	case SIMD_AVX2:
+		return bzero_avx2 (dest, size);
+	case SIMD_SSE2:
+		return bzero_sse2 (dest, size);
+	default:
+		return 0;
+	}
+}
+
+static size_t
+memmove_up_simd (char *dest, const char *src, size_t size)
+{
+	switch (get_simd_level ()) {
+	case SIMD_AVX2:
+		return memmove_up_avx2 (dest, src, size);
+	case SIMD_SSE2:
+		return memmove_up_sse2 (dest, src, size);
+	default:
+		return 0;
+	}
+}
+
+static size_t
+memmove_down_simd (char *dest, const char *src, size_t size)
+{
+	switch (get_simd_level ()) {
+	case SIMD_AVX2:
+		return memmove_down_avx2 (dest, src, size);
+	case SIMD_SSE2:
+		return memmove_down_sse2 (dest, src, size);
+	default:
+		return 0;
+	}
+}
+
+#endif /* HAVE_SIMD_MEMFUNCS */
+
 #define BZERO_WORDS(dest,words) do {			\
 		void * volatile *__d = (void* volatile*)(dest);		\
 		int __n = (words);			\
@@ -67,8 +299,6 @@
  *
  * Zero @size bytes starting at @dest.
  * The address of @dest MUST be aligned to word boundaries
- *
- * FIXME borrow faster code from some BSD libc or bionic
  */
 void
 mono_gc_bzero_aligned (void *dest, size_t size)
@@ -78,6 +308,14 @@ mono_gc_bzero_aligned (void *dest, size_t size)
 
 	g_assert (unaligned_bytes (dest) == 0);
 
+#ifdef HAVE_SIMD_MEMFUNCS
+	if (size >= SIMD_MIN_SIZE) {
+		size_t done = bzero_simd ((char*)d, size);
+		d += done;
+		size -= done;
+	}
+#endif
+
 	/* copy all words with memmove */
 	word_bytes = (size_t)align_down (size);
 	switch (word_bytes) {
@@ -188,6 +426,14 @@ mono_gc_memmove_aligned (void *dest, const void *src, size_t size)
 
 			word_start = align_up (start);
 			bytes_to_memmove = p - word_start;
+#ifdef HAVE_SIMD_MEMFUNCS
+			if (bytes_to_memmove >= SIMD_MIN_SIZE) {
+				size_t done = memmove_down_simd (word_start, s - bytes_to_memmove, bytes_to_memmove);
+				p -= done;
+				s -= done;
+				bytes_to_memmove -= done;
+			}
+#endif
 			p -= bytes_to_memmove;
 			s -= bytes_to_memmove;
 			MEMMOVE_WORDS_DOWNWARD (p, s, bytes_to_words (bytes_to_memmove));
@@ -196,6 +442,15 @@ mono_gc_memmove_aligned (void *dest, const void *src, size_t size)
 		const char *s = (const char*)src;
 		size_t tail_bytes;
 
+#ifdef HAVE_SIMD_MEMFUNCS
+		if (size >= SIMD_MIN_SIZE) {
+			size_t done = memmove_up_simd ((char*)d, s, size);
+			d += done;
+			s += done;
+			size -= done;
+		}
+#endif
+
 		/* copy all words with memmove */
 		MEMMOVE_WORDS_UPWARD (d, s, bytes_to_words (align_down (size)));
 
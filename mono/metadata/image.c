@@ -33,6 +33,7 @@
 #include <mono/utils/mono-io-portability.h>
 #include <mono/utils/atomic.h>
 #include <mono/metadata/class-internals.h>
+#include <mono/metadata/class-snapshot.h>
 #include <mono/metadata/assembly.h>
 #include <mono/metadata/object-internals.h>
 #include <mono/metadata/security-core-clr.h>
@@ -680,6 +681,7 @@ mono_image_init (MonoImage *image)
 				       class_key_extract,
 				       class_next_value);
 	image->field_cache = mono_conc_hashtable_new (&image->lock, NULL, NULL);
+	image->cattr_cache = mono_conc_hashtable_new (&image->lock, NULL, NULL);
 
 	image->typespec_cache = g_hash_table_new (NULL, NULL);
 	image->memberref_signatures = g_hash_table_new (NULL, NULL);
@@ -1604,6 +1606,7 @@ mono_image_close_except_pools (MonoImage *image)
 		g_hash_table_destroy (image->methodref_cache);
 	mono_internal_hash_table_destroy (&image->class_cache);
 	mono_conc_hashtable_destroy (image->field_cache);
+	mono_conc_hashtable_destroy (image->cattr_cache);
 	if (image->array_cache) {
 		g_hash_table_foreach (image->array_cache, free_array_cache_entry, NULL);
 		g_hash_table_destroy (image->array_cache);
@@ -1616,6 +1619,7 @@ mono_image_close_except_pools (MonoImage *image)
 		g_hash_table_foreach (image->name_cache, free_hash_table, NULL);
 		g_hash_table_destroy (image->name_cache);
 	}
+	mono_class_snapshot_free (image);
 
 	free_hash (image->native_wrapper_cache);
 	free_hash (image->native_func_wrapper_cache);
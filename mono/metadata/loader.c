@@ -45,6 +45,7 @@
 #include <mono/utils/mono-counters.h>
 #include <mono/utils/mono-error-internals.h>
 #include <mono/utils/mono-tls.h>
+#include <mono/utils/atomic.h>
 
 MonoDefaults mono_defaults;
 
@@ -63,6 +64,8 @@ static guint32 inflated_signatures_size;
 static guint32 memberref_sig_cache_size;
 static guint32 methods_size;
 static guint32 signatures_size;
+static guint32 loader_lock_acquisitions;
+static gint32 loader_lock_contentions;
 
 /*
  * This TLS variable contains the last type load error encountered by the loader.
@@ -111,6 +114,10 @@ mono_loader_init ()
 								MONO_COUNTER_METADATA | MONO_COUNTER_INT, &methods_size);
 		mono_counters_register ("MonoMethodSignature size",
 								MONO_COUNTER_METADATA | MONO_COUNTER_INT, &signatures_size);
+		mono_counters_register ("Loader lock acquisitions",
+								MONO_COUNTER_METADATA | MONO_COUNTER_INT, &loader_lock_acquisitions);
+		mono_counters_register ("Loader lock contentions",
+								MONO_COUNTER_METADATA | MONO_COUNTER_INT, &loader_lock_contentions);
 
 		inited = TRUE;
 	}
@@ -2454,7 +2461,14 @@ static gboolean loader_lock_track_ownership = FALSE;
 void
 mono_loader_lock (void)
 {
-	mono_locks_acquire (&loader_mutex, LoaderLock);
+	/* Try first so contention on the loader lock can be measured with the counters */
+	if (G_UNLIKELY (mono_mutex_trylock (&loader_mutex) != 0)) {
+		InterlockedIncrement (&loader_lock_contentions);
+		mono_mutex_lock (&loader_mutex);
+	}
+	mono_locks_lock_acquired (LoaderLock, &loader_mutex);
+	/* Protected by the lock */
+	loader_lock_acquisitions ++;
 	if (G_UNLIKELY (loader_lock_track_ownership)) {
 		mono_native_tls_set_value (loader_lock_nest_id, GUINT_TO_POINTER (GPOINTER_TO_UINT (mono_native_tls_get_value (loader_lock_nest_id)) + 1));
 	}
@@ -72,8 +72,30 @@ static MonoNativeTlsKey last_error_tls_id;
 
 static MonoNativeTlsKey load_type_info_tls_id;
 
+/* Holds a StringConvBuffer */
+static MonoNativeTlsKey string_conv_buffer_tls_id;
+
 static gboolean use_aot_wrappers;
 
+/*
+ * By-value string arguments converted to UTF-8 go into a buffer of this size on the
+ * stack of the wrapper if they fit, and into a buffer cached per thread otherwise.
+ */
+#define STRING_CONV_STACK_SIZE 256
+/* Larger buffers are freed after the call instead of being cached */
+#define STRING_CONV_MAX_CACHED_SIZE (1024 * 1024)
+
+typedef struct {
+	gsize size;
+	gsize pad;
+	char data [MONO_ZERO_LEN_ARRAY];
+} StringConvBuffer;
+
+/* Statistics */
+static gint64 string_bytes_to_native;
+static gint64 string_bytes_from_native;
+static gint32 strings_on_stack;
+
 static void
 delegate_hash_table_add (MonoDelegate *d);
 
@@ -104,6 +126,15 @@ mono_string_utf16_to_builder2 (gunichar2 *text);
 static MonoString*
 mono_string_new_len_wrapper (const char *text, guint length);
 
+static gpointer
+mono_marshal_string_to_utf8_buf (MonoString *s, char *stack_buf);
+
+static void
+mono_marshal_free_utf8_buf (gpointer ptr, char *stack_buf);
+
+static MonoString*
+mono_marshal_string_from_utf8 (const char *text);
+
 static MonoString *
 mono_string_from_byvalstr (const char *data, int len);
 
@@ -185,6 +216,12 @@ mono_marshal_init_tls (void)
 {
 	mono_native_tls_alloc (&last_error_tls_id, NULL);
 	mono_native_tls_alloc (&load_type_info_tls_id, NULL);
+#ifdef HOST_WIN32
+	/* No TLS destructors, the cached buffer of an exiting thread is leaked */
+	mono_native_tls_alloc (&string_conv_buffer_tls_id, NULL);
+#else
+	mono_native_tls_alloc (&string_conv_buffer_tls_id, g_free);
+#endif
 }
 
 void
@@ -208,6 +245,9 @@ mono_marshal_init (void)
 		register_icall (mono_string_new_len_wrapper, "mono_string_new_len_wrapper", "obj ptr int", FALSE);
 		register_icall (mono_string_to_utf8, "mono_string_to_utf8", "ptr obj", FALSE);
 		register_icall (mono_string_to_lpstr, "mono_string_to_lpstr", "ptr obj", FALSE);
+		register_icall (mono_marshal_string_to_utf8_buf, "mono_marshal_string_to_utf8_buf", "ptr obj ptr", FALSE);
+		register_icall (mono_marshal_free_utf8_buf, "mono_marshal_free_utf8_buf", "void ptr ptr", FALSE);
+		register_icall (mono_marshal_string_from_utf8, "mono_marshal_string_from_utf8", "obj ptr", FALSE);
 		register_icall (mono_string_to_ansibstr, "mono_string_to_ansibstr", "ptr object", FALSE);
 		register_icall (mono_string_builder_to_utf8, "mono_string_builder_to_utf8", "ptr object", FALSE);
 		register_icall (mono_string_builder_to_utf16, "mono_string_builder_to_utf16", "ptr object", FALSE);
@@ -246,6 +286,10 @@ mono_marshal_init (void)
 
 		mono_cominterop_init ();
 		mono_remoting_init ();
+
+		mono_counters_register ("String bytes marshalled to native", MONO_COUNTER_METADATA | MONO_COUNTER_LONG, &string_bytes_to_native);
+		mono_counters_register ("String bytes marshalled from native", MONO_COUNTER_METADATA | MONO_COUNTER_LONG, &string_bytes_from_native);
+		mono_counters_register ("Strings marshalled on the stack", MONO_COUNTER_METADATA | MONO_COUNTER_INT, &strings_on_stack);
 	}
 }
 
@@ -254,6 +298,7 @@ mono_marshal_cleanup (void)
 {
 	mono_cominterop_cleanup ();
 
+	mono_native_tls_free (string_conv_buffer_tls_id);
 	mono_native_tls_free (load_type_info_tls_id);
 	mono_native_tls_free (last_error_tls_id);
 	mono_mutex_destroy (&marshal_mutex);
@@ -1012,6 +1057,91 @@ mono_string_new_len_wrapper (const char *text, guint length)
 	return mono_string_new_len (mono_domain_get (), text, length);
 }
 
+static void
+release_string_conv_buffer (StringConvBuffer *buf)
+{
+	StringConvBuffer *cached = mono_native_tls_get_value (string_conv_buffer_tls_id);
+
+	if (buf->size > STRING_CONV_MAX_CACHED_SIZE || (cached && cached->size >= buf->size)) {
+		g_free (buf);
+		return;
+	}
+	g_free (cached);
+	mono_native_tls_set_value (string_conv_buffer_tls_id, buf);
+}
+
+/*
+ * mono_marshal_string_to_utf8_buf:
+ *
+ *   Convert S to UTF-8 for a by-value string argument of a native call. STACK_BUF
+ * points to STRING_CONV_STACK_SIZE bytes on the stack of the wrapper, which hold the
+ * result if it fits. Larger strings are converted into the buffer cached by the
+ * current thread, so converting the same large payload repeatedly doesn't allocate.
+ * The buffer is taken out of the cache while in use, since the native code can call
+ * back into managed code which marshals strings again. The result must be freed with
+ * mono_marshal_free_utf8_buf ().
+ */
+static gpointer
+mono_marshal_string_to_utf8_buf (MonoString *s, char *stack_buf)
+{
+	StringConvBuffer *buf;
+	glong len, size, res;
+
+	if (s == NULL)
+		return NULL;
+
+	len = mono_string_length (s);
+	if (len < STRING_CONV_STACK_SIZE) {
+		res = eg_utf16_to_utf8_buf (mono_string_chars (s), len, stack_buf, STRING_CONV_STACK_SIZE);
+		if (res >= 0) {
+			string_bytes_to_native += res;
+			strings_on_stack++;
+			return stack_buf;
+		}
+	}
+
+	/* Always enough, see eg_utf16_to_utf8_buf () */
+	size = len * 3 + 1;
+	buf = mono_native_tls_get_value (string_conv_buffer_tls_id);
+	if (buf && buf->size >= size) {
+		mono_native_tls_set_value (string_conv_buffer_tls_id, NULL);
+	} else {
+		buf = g_malloc (sizeof (StringConvBuffer) + size);
+		buf->size = size;
+	}
+
+	res = eg_utf16_to_utf8_buf (mono_string_chars (s), len, buf->data, size);
+	if (res < 0) {
+		/* Invalid UTF-16, let the regular conversion report the error */
+		release_string_conv_buffer (buf);
+		g_free (mono_string_to_utf8 (s));
+		g_assert_not_reached ();
+	}
+	string_bytes_to_native += res;
+	return buf->data;
+}
+
+static void
+mono_marshal_free_utf8_buf (gpointer ptr, char *stack_buf)
+{
+	if (!ptr || ptr == stack_buf)
+		return;
+	release_string_conv_buffer ((StringConvBuffer*)((char*)ptr - G_STRUCT_OFFSET (StringConvBuffer, data)));
+}
+
+static MonoString*
+mono_marshal_string_from_utf8 (const char *text)
+{
+	glong len;
+
+	if (!text)
+		return NULL;
+
+	len = strlen (text);
+	string_bytes_from_native += len;
+	return mono_string_new_len (mono_domain_get (), text, len);
+}
+
 #ifndef DISABLE_JIT
 
 /*
@@ -1440,7 +1570,7 @@ conv_to_icall (MonoMarshalConv conv)
 	case MONO_MARSHAL_CONV_LPTSTR_STR:
 		return mono_string_new_wrapper;
 	case MONO_MARSHAL_CONV_LPSTR_STR:
-		return mono_string_new_wrapper;
+		return mono_marshal_string_from_utf8;
 	case MONO_MARSHAL_CONV_STR_LPTSTR:
 #ifdef TARGET_WIN32
 		return mono_marshal_string_to_utf16;
@@ -4818,6 +4948,8 @@ emit_marshal_string (EmitMarshalContext *m, int argnum, MonoType *t,
 	MonoMethodBuilder *mb = m->mb;
 	MonoMarshalNative encoding = mono_marshal_get_string_encoding (m->piinfo, spec);
 	MonoMarshalConv conv = mono_marshal_get_string_to_ptr_conv (m->piinfo, spec);
+	/* By-value UTF-8 strings are converted into a temporary buffer, see mono_marshal_string_to_utf8_buf () */
+	gboolean use_conv_buf = !t->byref && conv != -1 && conv_to_icall (conv) == mono_string_to_lpstr;
 	gboolean need_free;
 
 	switch (action) {
@@ -4825,6 +4957,22 @@ emit_marshal_string (EmitMarshalContext *m, int argnum, MonoType *t,
 		*conv_arg_type = &mono_defaults.int_class->byval_arg;
 		conv_arg = mono_mb_add_local (mb, &mono_defaults.int_class->byval_arg);
 
+		if (use_conv_buf) {
+			/* Allocated right after CONV_ARG, CONV_OUT finds it at CONV_ARG + 1 */
+			int stack_buf = mono_mb_add_local (mb, &mono_defaults.int_class->byval_arg);
+
+			mono_mb_emit_icon (mb, STRING_CONV_STACK_SIZE);
+			mono_mb_emit_byte (mb, CEE_PREFIX1);
+			mono_mb_emit_byte (mb, CEE_LOCALLOC);
+			mono_mb_emit_stloc (mb, stack_buf);
+
+			mono_mb_emit_ldarg (mb, argnum);
+			mono_mb_emit_ldloc (mb, stack_buf);
+			mono_mb_emit_icall (mb, mono_marshal_string_to_utf8_buf);
+			mono_mb_emit_stloc (mb, conv_arg);
+			break;
+		}
+
 		if (t->byref) {
 			if (t->attrs & PARAM_ATTRIBUTE_OUT)
 				break;
@@ -4846,6 +4994,13 @@ emit_marshal_string (EmitMarshalContext *m, int argnum, MonoType *t,
 		break;
 
 	case MARSHAL_ACTION_CONV_OUT:
+		if (use_conv_buf) {
+			mono_mb_emit_ldloc (mb, conv_arg);
+			mono_mb_emit_ldloc (mb, conv_arg + 1);
+			mono_mb_emit_icall (mb, mono_marshal_free_utf8_buf);
+			break;
+		}
+
 		conv = mono_marshal_get_ptr_to_string_conv (m->piinfo, spec, &need_free);
 		if (conv == -1) {
 			char *msg = g_strdup_printf ("string marshalling conversion %d not implemented", encoding);
@@ -7127,6 +7282,118 @@ mono_marshal_emit_native_wrapper (MonoImage *image, MonoMethodBuilder *mb, MonoM
 #endif /* DISABLE_JIT */
 
 
+#ifndef DISABLE_JIT
+/*
+ * Whenever a value of type T is passed to and from native code unchanged.
+ */
+static gboolean
+is_direct_pinvoke_type (MonoType *t)
+{
+	if (t->byref)
+		return FALSE;
+
+handle_enum:
+	switch (t->type) {
+	case MONO_TYPE_I1:
+	case MONO_TYPE_U1:
+	case MONO_TYPE_I2:
+	case MONO_TYPE_U2:
+	case MONO_TYPE_I4:
+	case MONO_TYPE_U4:
+	case MONO_TYPE_I8:
+	case MONO_TYPE_U8:
+	case MONO_TYPE_I:
+	case MONO_TYPE_U:
+	case MONO_TYPE_R4:
+	case MONO_TYPE_R8:
+	case MONO_TYPE_PTR:
+	case MONO_TYPE_FNPTR:
+		return TRUE;
+	case MONO_TYPE_VALUETYPE:
+		if (t->data.klass->enumtype) {
+			t = mono_class_enum_basetype (t->data.klass);
+			goto handle_enum;
+		}
+		return FALSE;
+	default:
+		return FALSE;
+	}
+}
+
+/*
+ * can_use_direct_pinvoke_wrapper:
+ *
+ *   Return whenever METHOD can be called through a wrapper which only pushes the
+ * arguments and calls the native function. This is an opt-in, the method must be
+ * marked with an attribute named System.Runtime.InteropServices.SuppressGCTransitionAttribute,
+ * which can be defined in any assembly. The signature must consist of primitive types,
+ * enums and pointers, with no marshalling directives, and the method must not request
+ * SetLastError.
+ *
+ * The wrapper doesn't save an LMF, so the runtime can't unwind through the native
+ * call, and doesn't check for pending interruptions. The native function must return
+ * quickly, and must not call back into managed code or throw.
+ */
+static gboolean
+can_use_direct_pinvoke_wrapper (MonoMethod *method, MonoMethodSignature *sig, MonoMarshalSpec **mspecs)
+{
+	MonoMethodPInvoke *piinfo = (MonoMethodPInvoke *) method;
+	MonoCustomAttrInfo *cinfo;
+	gboolean found = FALSE;
+	int i;
+
+	if (sig->hasthis || sig->call_convention == MONO_CALL_VARARG || (piinfo->piflags & PINVOKE_ATTRIBUTE_SUPPORTS_LAST_ERROR))
+		return FALSE;
+	if (!MONO_TYPE_IS_VOID (sig->ret) && !is_direct_pinvoke_type (sig->ret))
+		return FALSE;
+	for (i = 0; i < sig->param_count; ++i) {
+		if (!is_direct_pinvoke_type (sig->params [i]))
+			return FALSE;
+	}
+	for (i = 0; i < sig->param_count + 1; ++i) {
+		if (mspecs [i])
+			return FALSE;
+	}
+
+	cinfo = mono_custom_attrs_from_method (method);
+	if (!cinfo)
+		return FALSE;
+	for (i = 0; i < cinfo->num_attrs; ++i) {
+		MonoClass *klass = cinfo->attrs [i].ctor ? cinfo->attrs [i].ctor->klass : NULL;
+
+		if (klass && !strcmp (klass->name, "SuppressGCTransitionAttribute") && !strcmp (klass->name_space, "System.Runtime.InteropServices")) {
+			found = TRUE;
+			break;
+		}
+	}
+	if (!cinfo->cached)
+		mono_custom_attrs_free (cinfo);
+	return found;
+}
+
+static void
+emit_direct_native_wrapper (MonoMethodBuilder *mb, MonoMethodSignature *sig, MonoMethodPInvoke *piinfo, gboolean aot)
+{
+	MonoMethodSignature *csig;
+	int i;
+
+	csig = signature_dup (mb->method->klass->image, sig);
+	csig->pinvoke = 1;
+
+	for (i = 0; i < sig->param_count; i++)
+		mono_mb_emit_ldarg (mb, i);
+
+	if (aot) {
+		mono_mb_emit_byte (mb, MONO_CUSTOM_PREFIX);
+		mono_mb_emit_op (mb, CEE_MONO_ICALL_ADDR, &piinfo->method);
+		mono_mb_emit_calli (mb, csig);
+	} else {
+		mono_mb_emit_native_call (mb, csig, piinfo->addr);
+	}
+	mono_mb_emit_byte (mb, CEE_RET);
+}
+#endif /* DISABLE_JIT */
+
 G_GNUC_UNUSED static void
 code_for (MonoMethod *method) {
 	MonoMethodHeader *header = mono_method_get_header (method);
@@ -7330,7 +7597,12 @@ mono_marshal_get_native_wrapper (MonoMethod *method, gboolean check_exceptions,
 	mspecs = g_new (MonoMarshalSpec*, sig->param_count + 1);
 	mono_method_get_marshal_info (method, mspecs);
 
-	mono_marshal_emit_native_wrapper (mb->method->klass->image, mb, sig, piinfo, mspecs, piinfo->addr, aot, check_exceptions, FALSE);
+	if (can_use_direct_pinvoke_wrapper (method, sig, mspecs)) {
+		mb->method->save_lmf = 0;
+		emit_direct_native_wrapper (mb, sig, piinfo, aot);
+	} else {
+		mono_marshal_emit_native_wrapper (mb->method->klass->image, mb, sig, piinfo, mspecs, piinfo->addr, aot, check_exceptions, FALSE);
+	}
 #endif
 	info = mono_wrapper_info_create (mb, WRAPPER_SUBTYPE_PINVOKE);
 	info->d.managed_to_native.method = method;
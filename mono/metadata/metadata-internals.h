@@ -227,6 +227,11 @@ struct _MonoImage {
 	 */
 	MonoConcurrentHashTable *field_cache; /*protected by the image lock*/
 
+	/*
+	 * Indexed by HasCustomAttribute coded indexes, see mono_custom_attrs_from_index ()
+	 */
+	MonoConcurrentHashTable *cattr_cache; /*protected by the image lock*/
+
 	/* indexed by typespec tokens. */
 	GHashTable *typespec_cache; /* protected by the image lock */
 	/* indexed by token */
@@ -241,6 +246,14 @@ struct _MonoImage {
 	 */
 	GHashTable *name_cache;  /*protected by the image lock*/
 
+	/* Memory mapped snapshot of name_cache, see class-snapshot.c */
+	struct _MonoClassSnapshot *class_snapshot; /*protected by the image lock*/
+	/*
+	 * Whenever we looked for a class snapshot for this image, protected by the image lock.
+	 * Not a bitfield, the other flags are set without that lock.
+	 */
+	gboolean class_snapshot_checked;
+
 	/*
 	 * Indexed by MonoClass
 	 */
@@ -714,6 +727,8 @@ MonoGenericInst * mono_metadata_inflate_generic_inst  (MonoGenericInst *ginst, M
 void mono_dynamic_stream_reset  (MonoDynamicStream* stream) MONO_INTERNAL;
 void mono_assembly_addref       (MonoAssembly *assembly) MONO_INTERNAL;
 void mono_assembly_load_friends (MonoAssembly* ass) MONO_INTERNAL;
+void mono_assembly_prefetch_references (MonoAssembly *assembly) MONO_INTERNAL;
+void mono_assembly_prefetch_cleanup (void) MONO_INTERNAL;
 gboolean mono_assembly_has_skip_verification (MonoAssembly* ass) MONO_INTERNAL;
 
 void mono_assembly_release_gc_roots (MonoAssembly *assembly) MONO_INTERNAL;
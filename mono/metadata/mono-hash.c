@@ -42,25 +42,34 @@
 #define mg_free(x)       g_free(x)
 #endif
 
-typedef struct _Slot Slot;
+/*
+ * This uses the same open addressing scheme as the eglib GHashTable, see
+ * eglib/src/ghashtable.c. Entries never move except when the table is resized,
+ * which happens while holding the GC lock so mono_g_hash_mark () never sees a
+ * half copied table. Removed entries are cleared, so the mark function can scan
+ * the entries array without looking at the hash codes.
+ */
 
-struct _Slot {
+typedef struct {
 	gpointer key;
 	gpointer value;
-	Slot    *next;
-};
+} Entry;
 
-static gpointer KEYMARKER_REMOVED = &KEYMARKER_REMOVED;
+#define HASH_EMPTY 0
+#define HASH_TOMBSTONE 1
+#define HASH_IS_LIVE(h) ((h) > HASH_TOMBSTONE)
+
+#define MIN_TABLE_SIZE 8
 
 struct _MonoGHashTable {
 	GHashFunc      hash_func;
 	GEqualFunc     key_equal_func;
 
-	Slot **table;
+	guint *hashes;
+	Entry *entries;
 	int   table_size;
 	int   in_use;
-	int   threshold;
-	int   last_rehash;
+	int   tombstones;
 	GDestroyNotify value_destroy_func, key_destroy_func;
 	MonoGHashGCType gc_type;
 };
@@ -70,67 +79,93 @@ static void *table_hash_descr = NULL;
 
 static void mono_g_hash_mark (void *addr, MonoGCMarkFunc mark_func, void *gc_data);
 
-static Slot*
-new_slot (MonoGHashTable *hash)
+static Entry*
+new_entries (MonoGHashTable *hash, int size)
 {
 	if (hash->gc_type == MONO_HASH_CONSERVATIVE_GC)
-		return mono_gc_alloc_fixed (sizeof (Slot), NULL);
+		return mono_gc_alloc_fixed (sizeof (Entry) * size, NULL);
 	else
-		return mg_new (Slot, 1);
+		return mg_new0 (Entry, size);
 }
 
 static void
-free_slot (MonoGHashTable *hash, Slot *slot)
+free_entries (MonoGHashTable *hash, Entry *entries)
 {
 	if (hash->gc_type == MONO_HASH_CONSERVATIVE_GC)
-		mono_gc_free_fixed (slot);
+		mono_gc_free_fixed (entries);
 	else
-		mg_free (slot);
+		mg_free (entries);
 }
 #else
-#define new_slot(h)	mg_new(Slot,1)
-#define free_slot(h,s)	mg_free((s))
+#define new_entries(h,size)	mg_new0(Entry,(size))
+#define free_entries(h,e)	mg_free((e))
 #endif
 
-#if UNUSED
-static gboolean
-test_prime (int x)
+/* See mix_hash () in eglib/src/ghashtable.c */
+static inline guint
+mix_hash (guint h)
 {
-	if ((x & 1) != 0) {
-		int n;
-		for (n = 3; n< (int)sqrt (x); n += 2) {
-			if ((x % n) == 0)
-				return FALSE;
-		}
-		return TRUE;
-	}
-	// There is only one even prime - 2.
-	return (x == 2);
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return HASH_IS_LIVE (h) ? h : h + 2;
 }
 
+static inline guint
+hash_key (MonoGHashTable *hash, gconstpointer key)
+{
+	return mix_hash (hash->hash_func == g_direct_hash ? GPOINTER_TO_UINT (key) : (*hash->hash_func) (key));
+}
+
+#define KEYS_EQUAL(hash,k1,k2) ((hash)->key_equal_func == g_direct_equal ? (k1) == (k2) : (*(hash)->key_equal_func) ((k1), (k2)))
+
 static int
-calc_prime (int x)
+table_size_for (int n)
 {
-	int i;
-	
-	for (i = (x & (~1))-1; i< G_MAXINT32; i += 2) {
-		if (test_prime (i))
-			return i;
-	}
-	return x;
+	int size = MIN_TABLE_SIZE;
+
+	while (size < n * 2)
+		size <<= 1;
+	return size;
 }
-#endif
 
-MonoGHashTable *
-mono_g_hash_table_new_type (GHashFunc hash_func, GEqualFunc key_equal_func, MonoGHashGCType type)
+static MonoGHashTable *
+mono_g_hash_table_new_internal (GHashFunc hash_func, GEqualFunc key_equal_func, MonoGHashGCType type)
 {
-	MonoGHashTable *hash = mono_g_hash_table_new (hash_func, key_equal_func);
+	MonoGHashTable *hash;
+
+	if (hash_func == NULL)
+		hash_func = g_direct_hash;
+	if (key_equal_func == NULL)
+		key_equal_func = g_direct_equal;
+	hash = mg_new0 (MonoGHashTable, 1);
 
+	hash->hash_func = hash_func;
+	hash->key_equal_func = key_equal_func;
 	hash->gc_type = type;
 
+	hash->table_size = MIN_TABLE_SIZE;
+	hash->hashes = mg_new0 (guint, hash->table_size);
+	hash->entries = new_entries (hash, hash->table_size);
+
+	return hash;
+}
+
+MonoGHashTable *
+mono_g_hash_table_new_type (GHashFunc hash_func, GEqualFunc key_equal_func, MonoGHashGCType type)
+{
+	MonoGHashTable *hash;
+
 #ifdef HAVE_SGEN_GC
 	if (type > MONO_HASH_KEY_VALUE_GC)
 		g_error ("wrong type for gc hashtable");
+#endif
+
+	hash = mono_g_hash_table_new_internal (hash_func, key_equal_func, type);
+
+#ifdef HAVE_SGEN_GC
 	/*
 	 * We use a user defined marking function to avoid having to register a GC root for
 	 * each hash node.
@@ -147,22 +182,7 @@ mono_g_hash_table_new_type (GHashFunc hash_func, GEqualFunc key_equal_func, Mono
 MonoGHashTable *
 mono_g_hash_table_new (GHashFunc hash_func, GEqualFunc key_equal_func)
 {
-	MonoGHashTable *hash;
-
-	if (hash_func == NULL)
-		hash_func = g_direct_hash;
-	if (key_equal_func == NULL)
-		key_equal_func = g_direct_equal;
-	hash = mg_new0 (MonoGHashTable, 1);
-
-	hash->hash_func = hash_func;
-	hash->key_equal_func = key_equal_func;
-
-	hash->table_size = g_spaced_primes_closest (1);
-	hash->table = mg_new0 (Slot *, hash->table_size);
-	hash->last_rehash = hash->table_size;
-	
-	return hash;
+	return mono_g_hash_table_new_internal (hash_func, key_equal_func, MONO_HASH_CONSERVATIVE_GC);
 }
 
 MonoGHashTable *
@@ -182,7 +202,8 @@ mono_g_hash_table_new_full (GHashFunc hash_func, GEqualFunc key_equal_func,
 typedef struct {
 	MonoGHashTable *hash;
 	int new_size;
-	Slot **table;
+	guint *hashes;
+	Entry *entries;
 } RehashData;
 
 static void*
@@ -190,50 +211,47 @@ do_rehash (void *_data)
 {
 	RehashData *data = _data;
 	MonoGHashTable *hash = data->hash;
-	int current_size, i;
-	Slot **table;
-
-	/* printf ("Resizing diff=%d slots=%d\n", hash->in_use - hash->last_rehash, hash->table_size); */
-	hash->last_rehash = hash->table_size;
-	current_size = hash->table_size;
-	hash->table_size = data->new_size;
-	/* printf ("New size: %d\n", hash->table_size); */
-	table = hash->table;
-	hash->table = data->table;
-
-	for (i = 0; i < current_size; i++){
-		Slot *s, *next;
-
-		for (s = table [i]; s != NULL; s = next){
-			guint hashcode = ((*hash->hash_func) (s->key)) % hash->table_size;
-			next = s->next;
+	guint mask = data->new_size - 1;
+	guint *hashes;
+	Entry *entries;
+	int i;
 
-			s->next = hash->table [hashcode];
-			hash->table [hashcode] = s;
-		}
+	for (i = 0; i < hash->table_size; i++){
+		guint j;
+
+		if (!HASH_IS_LIVE (hash->hashes [i]))
+			continue;
+		for (j = hash->hashes [i] & mask; data->hashes [j] != HASH_EMPTY; j = (j + 1) & mask)
+			;
+		data->hashes [j] = hash->hashes [i];
+		data->entries [j] = hash->entries [i];
 	}
-	return table;
+
+	/* Hand the old arrays back to the caller to free */
+	hashes = hash->hashes;
+	entries = hash->entries;
+	hash->hashes = data->hashes;
+	hash->entries = data->entries;
+	data->hashes = hashes;
+	data->entries = entries;
+	hash->table_size = data->new_size;
+	hash->tombstones = 0;
+	return NULL;
 }
 
 static void
-rehash (MonoGHashTable *hash)
+rehash (MonoGHashTable *hash, int new_size)
 {
-	int diff = ABS (hash->last_rehash - hash->in_use);
 	RehashData data;
-	void *old_table;
-
-	/* These are the factors to play with to change the rehashing strategy */
-	/* I played with them with a large range, and could not really get */
-	/* something that was too good, maybe the tests are not that great */
-	if (!(diff * 0.75 > hash->table_size * 2))
-		return;
 
 	data.hash = hash;
-	data.new_size = g_spaced_primes_closest (hash->in_use);
-	data.table = mg_new0 (Slot *, data.new_size);
+	data.new_size = new_size;
+	data.hashes = mg_new0 (guint, new_size);
+	data.entries = new_entries (hash, new_size);
 
-	old_table = mono_gc_invoke_with_gc_lock (do_rehash, &data);
-	mg_free (old_table);
+	mono_gc_invoke_with_gc_lock (do_rehash, &data);
+	mg_free (data.hashes);
+	free_entries (hash, data.entries);
 }
 
 guint
@@ -255,26 +273,33 @@ mono_g_hash_table_lookup (MonoGHashTable *hash, gconstpointer key)
 		return NULL;
 }
 
+static int
+find_slot (MonoGHashTable *hash, gconstpointer key)
+{
+	guint hashcode = hash_key (hash, key);
+	guint mask = hash->table_size - 1;
+	guint i;
+
+	for (i = hashcode & mask; hash->hashes [i] != HASH_EMPTY; i = (i + 1) & mask) {
+		if (hash->hashes [i] == hashcode && KEYS_EQUAL (hash, hash->entries [i].key, key))
+			return i;
+	}
+	return -1;
+}
+
 gboolean
 mono_g_hash_table_lookup_extended (MonoGHashTable *hash, gconstpointer key, gpointer *orig_key, gpointer *value)
 {
-	GEqualFunc equal;
-	Slot *s;
-	guint hashcode;
+	int i;
 	
 	g_return_val_if_fail (hash != NULL, FALSE);
-	equal = hash->key_equal_func;
 
-	hashcode = ((*hash->hash_func) (key)) % hash->table_size;
-	
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal)(s->key, key)){
-			*orig_key = s->key;
-			*value = s->value;
-			return TRUE;
-		}
-	}
-	return FALSE;
+	i = find_slot (hash, key);
+	if (i == -1)
+		return FALSE;
+	*orig_key = hash->entries [i].key;
+	*value = hash->entries [i].value;
+	return TRUE;
 }
 
 void
@@ -286,10 +311,8 @@ mono_g_hash_table_foreach (MonoGHashTable *hash, GHFunc func, gpointer user_data
 	g_return_if_fail (func != NULL);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s;
-
-		for (s = hash->table [i]; s != NULL; s = s->next)
-			(*func)(s->key, s->value, user_data);
+		if (HASH_IS_LIVE (hash->hashes [i]))
+			(*func)(hash->entries [i].key, hash->entries [i].value, user_data);
 	}
 }
 
@@ -302,44 +325,43 @@ mono_g_hash_table_find (MonoGHashTable *hash, GHRFunc predicate, gpointer user_d
 	g_return_val_if_fail (predicate != NULL, NULL);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s;
-
-		for (s = hash->table [i]; s != NULL; s = s->next)
-			if ((*predicate)(s->key, s->value, user_data))
-				return s->value;
+		if (HASH_IS_LIVE (hash->hashes [i]) && (*predicate)(hash->entries [i].key, hash->entries [i].value, user_data))
+			return hash->entries [i].value;
 	}
 	return NULL;
 }
 
+static void
+clear_slot (MonoGHashTable *hash, int i)
+{
+	if (hash->key_destroy_func != NULL)
+		(*hash->key_destroy_func)(hash->entries [i].key);
+	if (hash->value_destroy_func != NULL)
+		(*hash->value_destroy_func)(hash->entries [i].value);
+	/* A tombstone is only needed if a probe sequence can continue past this slot */
+	if (hash->hashes [(i + 1) & (hash->table_size - 1)] == HASH_EMPTY) {
+		hash->hashes [i] = HASH_EMPTY;
+	} else {
+		hash->hashes [i] = HASH_TOMBSTONE;
+		hash->tombstones++;
+	}
+	hash->entries [i].key = NULL;
+	hash->entries [i].value = NULL;
+	hash->in_use--;
+}
+
 gboolean
 mono_g_hash_table_remove (MonoGHashTable *hash, gconstpointer key)
 {
-	GEqualFunc equal;
-	Slot *s, *last;
-	guint hashcode;
+	int i;
 	
 	g_return_val_if_fail (hash != NULL, FALSE);
-	equal = hash->key_equal_func;
-
-	hashcode = ((*hash->hash_func)(key)) % hash->table_size;
-	last = NULL;
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal)(s->key, key)){
-			if (hash->key_destroy_func != NULL)
-				(*hash->key_destroy_func)(s->key);
-			if (hash->value_destroy_func != NULL)
-				(*hash->value_destroy_func)(s->value);
-			if (last == NULL)
-				hash->table [hashcode] = s->next;
-			else
-				last->next = s->next;
-			free_slot (hash, s);
-			hash->in_use--;
-			return TRUE;
-		}
-		last = s;
-	}
-	return FALSE;
+
+	i = find_slot (hash, key);
+	if (i == -1)
+		return FALSE;
+	clear_slot (hash, i);
+	return TRUE;
 }
 
 guint
@@ -352,36 +374,13 @@ mono_g_hash_table_foreach_remove (MonoGHashTable *hash, GHRFunc func, gpointer u
 	g_return_val_if_fail (func != NULL, 0);
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s, *last;
-
-		last = NULL;
-		for (s = hash->table [i]; s != NULL; ){
-			if ((*func)(s->key, s->value, user_data)){
-				Slot *n;
-
-				if (hash->key_destroy_func != NULL)
-					(*hash->key_destroy_func)(s->key);
-				if (hash->value_destroy_func != NULL)
-					(*hash->value_destroy_func)(s->value);
-				if (last == NULL){
-					hash->table [i] = s->next;
-					n = s->next;
-				} else  {
-					last->next = s->next;
-					n = last->next;
-				}
-				free_slot (hash, s);
-				hash->in_use--;
-				count++;
-				s = n;
-			} else {
-				last = s;
-				s = s->next;
-			}
+		if (HASH_IS_LIVE (hash->hashes [i]) && (*func)(hash->entries [i].key, hash->entries [i].value, user_data)){
+			clear_slot (hash, i);
+			count++;
 		}
 	}
-	if (count > 0)
-		rehash (hash);
+	if (count > 0 && hash->table_size > MIN_TABLE_SIZE && hash->in_use * 8 < hash->table_size)
+		rehash (hash, table_size_for (hash->in_use));
 	return count;
 }
 
@@ -397,54 +396,54 @@ mono_g_hash_table_destroy (MonoGHashTable *hash)
 #endif
 
 	for (i = 0; i < hash->table_size; i++){
-		Slot *s, *next;
-
-		for (s = hash->table [i]; s != NULL; s = next){
-			next = s->next;
-			
-			if (hash->key_destroy_func != NULL)
-				(*hash->key_destroy_func)(s->key);
-			if (hash->value_destroy_func != NULL)
-				(*hash->value_destroy_func)(s->value);
-			free_slot (hash, s);
-		}
+		if (!HASH_IS_LIVE (hash->hashes [i]))
+			continue;
+		if (hash->key_destroy_func != NULL)
+			(*hash->key_destroy_func)(hash->entries [i].key);
+		if (hash->value_destroy_func != NULL)
+			(*hash->value_destroy_func)(hash->entries [i].value);
 	}
-	mg_free (hash->table);
+	mg_free (hash->hashes);
+	free_entries (hash, hash->entries);
 	mg_free (hash);
 }
 
 static void
 mono_g_hash_table_insert_replace (MonoGHashTable *hash, gpointer key, gpointer value, gboolean replace)
 {
-	guint hashcode;
-	Slot *s;
-	GEqualFunc equal;
+	guint hashcode, mask, i;
+	int free_slot = -1;
 	
 	g_return_if_fail (hash != NULL);
 
-	equal = hash->key_equal_func;
-	if (hash->in_use >= hash->threshold)
-		rehash (hash);
+	if ((hash->in_use + hash->tombstones + 1) * 4 > hash->table_size * 3)
+		rehash (hash, table_size_for (hash->in_use + 1));
 
-	hashcode = ((*hash->hash_func) (key)) % hash->table_size;
-	for (s = hash->table [hashcode]; s != NULL; s = s->next){
-		if ((*equal) (s->key, key)){
+	hashcode = hash_key (hash, key);
+	mask = hash->table_size - 1;
+	for (i = hashcode & mask; hash->hashes [i] != HASH_EMPTY; i = (i + 1) & mask) {
+		if (hash->hashes [i] == HASH_TOMBSTONE) {
+			if (free_slot == -1)
+				free_slot = i;
+		} else if (hash->hashes [i] == hashcode && KEYS_EQUAL (hash, hash->entries [i].key, key)) {
 			if (replace){
 				if (hash->key_destroy_func != NULL)
-					(*hash->key_destroy_func)(s->key);
-				s->key = key;
+					(*hash->key_destroy_func)(hash->entries [i].key);
+				hash->entries [i].key = key;
 			}
 			if (hash->value_destroy_func != NULL)
-				(*hash->value_destroy_func) (s->value);
-			s->value = value;
+				(*hash->value_destroy_func) (hash->entries [i].value);
+			hash->entries [i].value = value;
 			return;
 		}
 	}
-	s = new_slot (hash);
-	s->key = key;
-	s->value = value;
-	s->next = hash->table [hashcode];
-	hash->table [hashcode] = s;
+	if (free_slot == -1)
+		free_slot = i;
+	else
+		hash->tombstones--;
+	hash->entries [free_slot].key = key;
+	hash->entries [free_slot].value = value;
+	hash->hashes [free_slot] = hashcode;
 	hash->in_use++;
 }
 
@@ -463,18 +462,18 @@ mono_g_hash_table_replace(MonoGHashTable *h, gpointer k, gpointer v)
 void
 mono_g_hash_table_print_stats (MonoGHashTable *table)
 {
-	int i, chain_size, max_chain_size;
-	Slot *node;
+	int i, probe_length, max_probe_length;
+	guint mask = table->table_size - 1;
 
-	max_chain_size = 0;
+	max_probe_length = 0;
 	for (i = 0; i < table->table_size; i++) {
-		chain_size = 0;
-		for (node = table->table [i]; node; node = node->next)
-			chain_size ++;
-		max_chain_size = MAX(max_chain_size, chain_size);
+		if (!HASH_IS_LIVE (table->hashes [i]))
+			continue;
+		probe_length = ((i - (table->hashes [i] & mask)) & mask) + 1;
+		max_probe_length = MAX(max_probe_length, probe_length);
 	}
 
-	printf ("Size: %d Table Size: %d Max Chain Length: %d\n", table->in_use, table->table_size, max_chain_size);
+	printf ("Size: %d Table Size: %d Tombstones: %d Max Probe Length: %d\n", table->in_use, table->table_size, table->tombstones, max_probe_length);
 }
 
 #ifdef HAVE_SGEN_GC
@@ -484,31 +483,29 @@ static void
 mono_g_hash_mark (void *addr, MonoGCMarkFunc mark_func, void *gc_data)
 {
 	MonoGHashTable *table = (MonoGHashTable*)addr;
-	Slot *node;
+	Entry *entry;
 	int i;
 
+	/* Free slots have NULL keys and values, so there is no need to look at the hash codes */
 	if (table->gc_type == MONO_HASH_KEY_GC) {
 		for (i = 0; i < table->table_size; i++) {
-			for (node = table->table [i]; node; node = node->next) {
-				if (node->key)
-					mark_func (&node->key, gc_data);
-			}
+			entry = &table->entries [i];
+			if (entry->key)
+				mark_func (&entry->key, gc_data);
 		}
 	} else if (table->gc_type == MONO_HASH_VALUE_GC) {
 		for (i = 0; i < table->table_size; i++) {
-			for (node = table->table [i]; node; node = node->next) {
-				if (node->value)
-					mark_func (&node->value, gc_data);
-			}
+			entry = &table->entries [i];
+			if (entry->value)
+				mark_func (&entry->value, gc_data);
 		}
 	} else if (table->gc_type == MONO_HASH_KEY_VALUE_GC) {
 		for (i = 0; i < table->table_size; i++) {
-			for (node = table->table [i]; node; node = node->next) {
-				if (node->key)
-					mark_func (&node->key, gc_data);
-				if (node->value)
-					mark_func (&node->value, gc_data);
-			}
+			entry = &table->entries [i];
+			if (entry->key)
+				mark_func (&entry->key, gc_data);
+			if (entry->value)
+				mark_func (&entry->value, gc_data);
 		}
 	}
 }
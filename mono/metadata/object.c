@@ -87,10 +87,6 @@ static char *
 mono_string_to_utf8_internal (MonoMemPool *mp, MonoImage *image, MonoString *s, gboolean ignore_error, MonoError *error);
 
 
-#define ldstr_lock() mono_mutex_lock (&ldstr_section)
-#define ldstr_unlock() mono_mutex_unlock (&ldstr_section)
-static mono_mutex_t ldstr_section;
-
 static gboolean profile_allocs = TRUE;
 
 void
@@ -190,7 +186,6 @@ mono_type_initialization_init (void)
 	mono_mutex_init_recursive (&type_initialization_section);
 	type_initialization_hash = g_hash_table_new (NULL, NULL);
 	blocked_thread_hash = g_hash_table_new (NULL, NULL);
-	mono_mutex_init_recursive (&ldstr_section);
 }
 
 void
@@ -204,7 +199,6 @@ mono_type_initialization_cleanup (void)
 	g_hash_table_destroy (type_initialization_hash);
 	type_initialization_hash = NULL;
 #endif
-	mono_mutex_destroy (&ldstr_section);
 	g_hash_table_destroy (blocked_thread_hash);
 	blocked_thread_hash = NULL;
 
@@ -518,6 +512,8 @@ static MonoTrampoline arch_create_jit_trampoline = default_trampoline;
 static MonoJumpTrampoline arch_create_jump_trampoline = default_jump_trampoline;
 static MonoDelegateTrampoline arch_create_delegate_trampoline = default_delegate_trampoline;
 static MonoImtThunkBuilder imt_thunk_builder = NULL;
+/* Set by MONO_DEBUG=imt, dumps the entries of colliding IMT slots */
+static gboolean imt_debug;
 #define ARCH_USE_IMT (imt_thunk_builder != NULL)
 #if (MONO_IMT_SIZE > 32)
 #error "MONO_IMT_SIZE cannot be larger than 32"
@@ -566,6 +562,12 @@ mono_install_imt_thunk_builder (MonoImtThunkBuilder func) {
 	imt_thunk_builder = func;
 }
 
+void
+mono_set_imt_debug (gboolean enable)
+{
+	imt_debug = enable;
+}
+
 static MonoCompileFunc default_mono_compile_method = NULL;
 
 /**
@@ -645,6 +647,8 @@ mono_runtime_free_method (MonoDomain *domain, MonoMethod *method)
 
 	mono_method_clear_object (domain, method);
 
+	mono_conc_hashtable_remove (domain->invoke_plan_hash, method);
+
 	mono_free_method (method);
 }
 
@@ -1148,6 +1152,61 @@ mono_method_get_imt_slot (MonoMethod *method)
 
 #define DEBUG_IMT 0
 
+/*
+ * Colliding IMT slots which are built lazily from the IMT trampoline are not
+ * turned into a thunk on the first call. Instead, the slot keeps pointing to
+ * the trampoline for the first IMT_PROFILE_CALLS calls, which records which of
+ * the colliding methods are called. The thunk is then built with the methods
+ * receiving at least 1/IMT_HOT_FRACTION of the calls checked first, before the
+ * binary search over the remaining entries.
+ */
+#define IMT_PROFILE_CALLS 64
+#define IMT_HOT_FRACTION 4
+#define IMT_MAX_HOT_ENTRIES 3
+
+typedef struct {
+	int calls;
+	/* Maps MonoMethod* to the number of calls */
+	GHashTable *counts;
+} ImtSlotProfile;
+
+
+static void
+imt_slot_profile_free (gpointer data)
+{
+	ImtSlotProfile *profile = data;
+
+	g_hash_table_destroy (profile->counts);
+	g_free (profile);
+}
+
+/*
+ * LOCKING: The domain lock must be held.
+ */
+static ImtSlotProfile*
+imt_slot_profile_record (MonoDomain *domain, gpointer *imt_slot, MonoMethod *method)
+{
+	ImtSlotProfile *profile;
+
+	if (!domain->imt_slot_profiles)
+		domain->imt_slot_profiles = g_hash_table_new_full (mono_aligned_addr_hash, NULL, NULL, imt_slot_profile_free);
+	profile = g_hash_table_lookup (domain->imt_slot_profiles, imt_slot);
+	if (!profile) {
+		profile = g_new0 (ImtSlotProfile, 1);
+		profile->counts = g_hash_table_new (NULL, NULL);
+		g_hash_table_insert (domain->imt_slot_profiles, imt_slot, profile);
+	}
+	profile->calls ++;
+	g_hash_table_insert (profile->counts, method, GINT_TO_POINTER (GPOINTER_TO_INT (g_hash_table_lookup (profile->counts, method)) + 1));
+	return profile;
+}
+
+static int
+imt_profile_count (ImtSlotProfile *profile, MonoImtBuilderEntry *entry)
+{
+	return profile ? GPOINTER_TO_INT (g_hash_table_lookup (profile->counts, entry->key)) : 0;
+}
+
 static void
 add_imt_builder_entry (MonoImtBuilderEntry **imt_builder, MonoMethod *method, guint32 *imt_collisions_bitmap, int vtable_slot, int slot_num) {
 	guint32 imt_slot = mono_method_get_imt_slot (method);
@@ -1241,8 +1300,57 @@ imt_emit_ir (MonoImtBuilderEntry **sorted_array, int start, int end, GPtrArray *
 	return chunk_start;
 }
 
+/*
+ * imt_emit_hot_ir:
+ *
+ *   Emit equality checks for the entries of SORTED_ARRAY which received most of the
+ * calls recorded in PROFILE, removing them from SORTED_ARRAY. The last check falls
+ * through to the IR emitted for the remaining entries. Returns the number of entries
+ * left in SORTED_ARRAY.
+ */
+static int
+imt_emit_hot_ir (MonoImtBuilderEntry **sorted_array, int number_of_entries, ImtSlotProfile *profile, GPtrArray *out_array)
+{
+	int i, j, nhot;
+
+	for (nhot = 0; nhot < IMT_MAX_HOT_ENTRIES; ++nhot) {
+		MonoIMTCheckItem *item;
+		int best = -1, best_count = 0;
+
+		for (i = 0; i < number_of_entries; ++i) {
+			int count = imt_profile_count (profile, sorted_array [i]);
+			if (count > best_count) {
+				best = i;
+				best_count = count;
+			}
+		}
+		if (best == -1 || best_count * IMT_HOT_FRACTION < profile->calls)
+			break;
+
+		item = g_new0 (MonoIMTCheckItem, 1);
+		item->key = sorted_array [best]->key;
+		item->value = sorted_array [best]->value;
+		item->has_target_code = sorted_array [best]->has_target_code;
+		item->is_equals = TRUE;
+		g_ptr_array_add (out_array, item);
+
+		/* Keep the rest sorted */
+		for (j = best; j < number_of_entries - 1; ++j)
+			sorted_array [j] = sorted_array [j + 1];
+		number_of_entries --;
+		/* The last hot entry doesn't need a check if nothing follows it */
+		item->check_target_idx = number_of_entries ? out_array->len : 0;
+		if (!number_of_entries)
+			break;
+	}
+	if (nhot)
+		mono_stats.imt_thunks_with_hot_entries++;
+
+	return number_of_entries;
+}
+
 static GPtrArray*
-imt_sort_slot_entries (MonoImtBuilderEntry *entries) {
+imt_sort_slot_entries (MonoImtBuilderEntry *entries, ImtSlotProfile *profile) {
 	int number_of_entries = entries->children + 1;
 	MonoImtBuilderEntry **sorted_array = malloc (sizeof (MonoImtBuilderEntry*) * number_of_entries);
 	GPtrArray *result = g_ptr_array_new ();
@@ -1258,14 +1366,32 @@ imt_sort_slot_entries (MonoImtBuilderEntry *entries) {
 		print_imt_entry (" sorted array:", sorted_array [i], i);
 	}*/
 
-	imt_emit_ir (sorted_array, 0, number_of_entries, result);
+	if (profile)
+		number_of_entries = imt_emit_hot_ir (sorted_array, number_of_entries, profile, result);
+	if (number_of_entries)
+		imt_emit_ir (sorted_array, 0, number_of_entries, result);
 
 	free (sorted_array);
 	return result;
 }
 
+static void
+imt_dump_slot (MonoVTable *vtable, int slot, MonoImtBuilderEntry *entries, ImtSlotProfile *profile)
+{
+	MonoImtBuilderEntry *entry;
+	char *class_name = mono_type_get_full_name (vtable->klass);
+
+	g_print ("IMT slot %d of %s: %d entries, %d profiled calls\n", slot, class_name, entries->children + 1, profile ? profile->calls : 0);
+	for (entry = entries; entry; entry = entry->next) {
+		char *method_name = mono_method_full_name (entry->key, TRUE);
+		g_print ("\t%6d %s\n", imt_profile_count (profile, entry), method_name);
+		g_free (method_name);
+	}
+	g_free (class_name);
+}
+
 static gpointer
-initialize_imt_slot (MonoVTable *vtable, MonoDomain *domain, MonoImtBuilderEntry *imt_builder_entry, gpointer fail_tramp)
+initialize_imt_slot (MonoVTable *vtable, MonoDomain *domain, MonoImtBuilderEntry *imt_builder_entry, gpointer fail_tramp, ImtSlotProfile *profile)
 {
 	if (imt_builder_entry != NULL) {
 		if (imt_builder_entry->children == 0 && !fail_tramp) {
@@ -1273,7 +1399,7 @@ initialize_imt_slot (MonoVTable *vtable, MonoDomain *domain, MonoImtBuilderEntry
 			return vtable->vtable [imt_builder_entry->value.vtable_slot];
 		} else {
 			/* Collision, build the thunk */
-			GPtrArray *imt_ir = imt_sort_slot_entries (imt_builder_entry);
+			GPtrArray *imt_ir = imt_sort_slot_entries (imt_builder_entry, profile);
 			gpointer result;
 			int i;
 			result = imt_thunk_builder (vtable, domain,
@@ -1300,7 +1426,7 @@ get_generic_virtual_entries (MonoDomain *domain, gpointer *vtable_slot);
  *
 */
 static void
-build_imt_slots (MonoClass *klass, MonoVTable *vt, MonoDomain *domain, gpointer* imt, GSList *extra_interfaces, int slot_num)
+build_imt_slots (MonoClass *klass, MonoVTable *vt, MonoDomain *domain, gpointer* imt, GSList *extra_interfaces, int slot_num, ImtSlotProfile *profile)
 {
 	int i;
 	GSList *list_item;
@@ -1394,6 +1520,18 @@ build_imt_slots (MonoClass *klass, MonoVTable *vt, MonoDomain *domain, gpointer*
 				imt_builder [i] = entries;
 			}
 
+			if (profile && imt_builder [i] && imt_builder [i]->children > 0 && profile->calls < IMT_PROFILE_CALLS && !has_generic_virtual && !has_variant_iface) {
+				/*
+				 * Keep the IMT trampoline in the slot until enough calls are profiled.
+				 * The collision bit is set above, so the trampoline will resolve the
+				 * calls through the vtable in the meantime.
+				 */
+				continue;
+			}
+
+			if (imt_debug && imt_builder [i] && imt_builder [i]->children > 0)
+				imt_dump_slot (vt, i, imt_builder [i], profile);
+
 			if (has_generic_virtual || has_variant_iface) {
 				/*
 				 * There might be collisions later when the the thunk is expanded.
@@ -1404,9 +1542,15 @@ build_imt_slots (MonoClass *klass, MonoVTable *vt, MonoDomain *domain, gpointer*
 				 * The IMT thunk might be called with an instance of one of the 
 				 * generic virtual methods, so has to fallback to the IMT trampoline.
 				 */
-				imt [i] = initialize_imt_slot (vt, domain, imt_builder [i], callbacks.get_imt_trampoline ? callbacks.get_imt_trampoline (i) : NULL);
+				imt [i] = initialize_imt_slot (vt, domain, imt_builder [i], callbacks.get_imt_trampoline ? callbacks.get_imt_trampoline (i) : NULL, NULL);
 			} else {
-				imt [i] = initialize_imt_slot (vt, domain, imt_builder [i], NULL);
+				imt [i] = initialize_imt_slot (vt, domain, imt_builder [i], NULL, profile);
+			}
+			if (profile) {
+				if (imt_builder [i] && imt_builder [i]->children > 0)
+					mono_stats.imt_thunks_profiled++;
+				g_hash_table_remove (domain->imt_slot_profiles, &imt [i]);
+				profile = NULL;
 			}
 #if DEBUG_IMT
 			printf ("initialize_imt_slot[%d]: %p methods %d\n", i, imt [i], imt_builder [i]->children + 1);
@@ -1443,23 +1587,28 @@ build_imt_slots (MonoClass *klass, MonoVTable *vt, MonoDomain *domain, gpointer*
 
 static void
 build_imt (MonoClass *klass, MonoVTable *vt, MonoDomain *domain, gpointer* imt, GSList *extra_interfaces) {
-	build_imt_slots (klass, vt, domain, imt, extra_interfaces, -1);
+	build_imt_slots (klass, vt, domain, imt, extra_interfaces, -1, NULL);
 }
 
 /**
  * mono_vtable_build_imt_slot:
  * @vtable: virtual object table struct
  * @imt_slot: slot in the IMT table
+ * @imt_method: the interface method being called through the slot, or NULL
  *
  * Fill the given @imt_slot in the IMT table of @vtable with
  * a trampoline or a thunk for the case of collisions.
+ * If @imt_method is given, the call is recorded and colliding slots are only
+ * turned into a thunk after enough calls are seen to order its entries by
+ * call frequency.
  * This is part of the internal mono API.
  *
  * LOCKING: Take the domain lock.
  */
 void
-mono_vtable_build_imt_slot (MonoVTable* vtable, int imt_slot)
+mono_vtable_build_imt_slot (MonoVTable* vtable, int imt_slot, MonoMethod *imt_method)
 {
+	ImtSlotProfile *profile = NULL;
 	gpointer *imt = (gpointer*)vtable;
 	imt -= MONO_IMT_SIZE;
 	g_assert (imt_slot >= 0 && imt_slot < MONO_IMT_SIZE);
@@ -1472,8 +1621,13 @@ mono_vtable_build_imt_slot (MonoVTable* vtable, int imt_slot)
 	mono_loader_lock (); /*FIXME build_imt_slots requires the loader lock.*/
 	mono_domain_lock (vtable->domain);
 	/* we change the slot only if it wasn't changed from the generic imt trampoline already */
-	if (imt [imt_slot] == callbacks.get_imt_trampoline (imt_slot))
-		build_imt_slots (vtable->klass, vtable, vtable->domain, imt, NULL, imt_slot);
+	if (imt [imt_slot] == callbacks.get_imt_trampoline (imt_slot)) {
+		if (imt_method)
+			profile = imt_slot_profile_record (vtable->domain, &imt [imt_slot], imt_method);
+		/* The slot is known to collide and is still being profiled, no need to rebuild the entries */
+		if (!(profile && profile->calls > 1 && profile->calls < IMT_PROFILE_CALLS && (vtable->imt_collisions_bitmap & (1 << imt_slot))))
+			build_imt_slots (vtable->klass, vtable, vtable->domain, imt, NULL, imt_slot, profile);
+	}
 	mono_domain_unlock (vtable->domain);
 	mono_loader_unlock ();
 }
@@ -1756,7 +1910,7 @@ mono_method_add_generic_virtual_invocation (MonoDomain *domain, MonoVTable *vtab
 
 			entries = get_generic_virtual_entries (domain, vtable_slot);
 
-			sorted = imt_sort_slot_entries (entries);
+			sorted = imt_sort_slot_entries (entries, NULL);
 
 			*vtable_slot = imt_thunk_builder (NULL, domain, (MonoIMTCheckItem**)sorted->pdata, sorted->len,
 											  vtable_trampoline);
@@ -1871,37 +2025,19 @@ alloc_vtable (MonoDomain *domain, size_t vtable_size, size_t imt_table_bytes)
 	return (gpointer*) ((char*)mono_domain_alloc0 (domain, vtable_size) + alloc_offset);
 }
 
-static MonoVTable *
-mono_class_create_runtime_vtable (MonoDomain *domain, MonoClass *class, gboolean raise_on_error)
+/*
+ * prepare_class_for_vtable:
+ *
+ *   Initialize the parts of CLASS which are needed to create a runtime vtable for it.
+ * Returns FALSE if CLASS failed to load.
+ * LOCKING: Acquires the loader lock if CLASS is not yet initialized.
+ */
+static gboolean
+prepare_class_for_vtable (MonoClass *class)
 {
-	MonoVTable *vt;
-	MonoClassRuntimeInfo *runtime_info, *old_info;
-	MonoClassField *field;
-	char *t;
-	int i, vtable_slots;
-	size_t imt_table_bytes;
-	int gc_bits;
-	guint32 vtable_size, class_size;
-	guint32 cindex;
-	gpointer iter;
-	gpointer *interface_offsets;
-
-	mono_loader_lock (); /*FIXME mono_class_init acquires it*/
-	mono_domain_lock (domain);
-	runtime_info = class->runtime_info;
-	if (runtime_info && runtime_info->max_domain >= domain->domain_id && runtime_info->domain_vtables [domain->domain_id]) {
-		mono_domain_unlock (domain);
-		mono_loader_unlock ();
-		return runtime_info->domain_vtables [domain->domain_id];
-	}
 	if (!class->inited || class->exception_type) {
-		if (!mono_class_init (class) || class->exception_type) {
-			mono_domain_unlock (domain);
-			mono_loader_unlock ();
-			if (raise_on_error)
-				mono_raise_exception (mono_class_get_exception_for_failure (class));
-			return NULL;
-		}
+		if (!mono_class_init (class) || class->exception_type)
+			return FALSE;
 	}
 
 	/* Array types require that their element type be valid*/
@@ -1918,11 +2054,7 @@ mono_class_create_runtime_vtable (MonoDomain *domain, MonoClass *class, gboolean
 			/*Can happen if element_class only got bad after mono_class_setup_vtable*/
 			if (class->exception_type == MONO_EXCEPTION_NONE)
 				mono_class_set_failure (class, MONO_EXCEPTION_TYPE_LOAD, NULL);
-			mono_domain_unlock (domain);
-			mono_loader_unlock ();
-			if (raise_on_error)
-				mono_raise_exception (mono_class_get_exception_for_failure (class));
-			return NULL;
+			return FALSE;
 		}
 	}
 
@@ -1933,12 +2065,55 @@ mono_class_create_runtime_vtable (MonoDomain *domain, MonoClass *class, gboolean
 	if (!class->vtable_size)
 		mono_class_setup_vtable (class);
 
-	if (class->generic_class && !class->vtable)
+	if (class->generic_class && !class->vtable) {
+		mono_loader_lock ();
 		mono_class_check_vtable_constraints (class, NULL);
+		mono_loader_unlock ();
+	}
 
 	/* Initialize klass->has_finalize */
 	mono_class_has_finalizer (class);
 
+	return class->exception_type == MONO_EXCEPTION_NONE;
+}
+
+static MonoVTable *
+mono_class_create_runtime_vtable (MonoDomain *domain, MonoClass *class, gboolean raise_on_error)
+{
+	MonoVTable *vt;
+	MonoClassRuntimeInfo *runtime_info, *old_info;
+	MonoClassField *field;
+	char *t;
+	int i, vtable_slots;
+	size_t imt_table_bytes;
+	int gc_bits;
+	guint32 vtable_size, class_size;
+	guint32 cindex;
+	gpointer iter;
+	gpointer *interface_offsets;
+
+	/*
+	 * Do the per-class setup before taking the locks: each of these steps is
+	 * idempotent and does its own double-checked locking, so threads creating vtables
+	 * for already set up classes, or for classes in different domains, don't
+	 * serialize on the loader lock while another thread is initializing an
+	 * unrelated class.
+	 */
+	if (!prepare_class_for_vtable (class)) {
+		if (raise_on_error)
+			mono_raise_exception (mono_class_get_exception_for_failure (class));
+		return NULL;
+	}
+
+	mono_loader_lock (); /*FIXME mono_class_init acquires it*/
+	mono_domain_lock (domain);
+	runtime_info = class->runtime_info;
+	if (runtime_info && runtime_info->max_domain >= domain->domain_id && runtime_info->domain_vtables [domain->domain_id]) {
+		mono_domain_unlock (domain);
+		mono_loader_unlock ();
+		return runtime_info->domain_vtables [domain->domain_id];
+	}
+
 	if (class->exception_type) {
 		mono_domain_unlock (domain);
 		mono_loader_unlock ();
@@ -4156,6 +4331,127 @@ mono_install_runtime_invoke (MonoInvokeFunc func)
 }
 
 
+typedef enum {
+	INVOKE_ARG_VTYPE,
+	INVOKE_ARG_VTYPE_BYREF,
+	INVOKE_ARG_NULLABLE,
+	INVOKE_ARG_NULLABLE_BYREF,
+	INVOKE_ARG_REF,
+	INVOKE_ARG_REF_BYREF,
+	INVOKE_ARG_PTR
+} InvokeArgKind;
+
+typedef struct {
+	InvokeArgKind kind;
+	/* The class of vtype arguments */
+	MonoClass *klass;
+} InvokeArg;
+
+/*
+ * How mono_runtime_invoke_array () unpacks the arguments of a method, so it
+ * doesn't have to decode the signature on every call. Cached per domain in
+ * domain->invoke_plan_hash.
+ */
+typedef struct {
+	gboolean is_ctor;
+	gboolean ret_is_ptr;
+	InvokeArg args [MONO_ZERO_LEN_ARRAY];
+} InvokePlan;
+
+#define MONO_SIZEOF_INVOKE_PLAN (offsetof (InvokePlan, args))
+
+static gint32 invoke_plan_hits, invoke_plan_misses;
+
+static InvokePlan*
+create_invoke_plan (MonoMethod *method)
+{
+	MonoMethodSignature *sig = mono_method_signature (method);
+	InvokePlan *plan;
+	int i;
+
+	plan = g_malloc0 (MONO_SIZEOF_INVOKE_PLAN + sig->param_count * sizeof (InvokeArg));
+	plan->is_ctor = !strcmp (method->name, ".ctor") && method->klass != mono_defaults.string_class;
+	plan->ret_is_ptr = sig->ret->type == MONO_TYPE_PTR;
+
+	for (i = 0; i < sig->param_count; i++) {
+		MonoType *t = sig->params [i];
+		InvokeArg *arg = &plan->args [i];
+
+	again:
+		switch (t->type) {
+		case MONO_TYPE_U1:
+		case MONO_TYPE_I1:
+		case MONO_TYPE_BOOLEAN:
+		case MONO_TYPE_U2:
+		case MONO_TYPE_I2:
+		case MONO_TYPE_CHAR:
+		case MONO_TYPE_U:
+		case MONO_TYPE_I:
+		case MONO_TYPE_U4:
+		case MONO_TYPE_I4:
+		case MONO_TYPE_U8:
+		case MONO_TYPE_I8:
+		case MONO_TYPE_R4:
+		case MONO_TYPE_R8:
+		case MONO_TYPE_VALUETYPE:
+			arg->klass = mono_class_from_mono_type (sig->params [i]);
+			if (t->type == MONO_TYPE_VALUETYPE && mono_class_is_nullable (arg->klass))
+				arg->kind = t->byref ? INVOKE_ARG_NULLABLE_BYREF : INVOKE_ARG_NULLABLE;
+			else
+				arg->kind = t->byref ? INVOKE_ARG_VTYPE_BYREF : INVOKE_ARG_VTYPE;
+			break;
+		case MONO_TYPE_STRING:
+		case MONO_TYPE_OBJECT:
+		case MONO_TYPE_CLASS:
+		case MONO_TYPE_ARRAY:
+		case MONO_TYPE_SZARRAY:
+			arg->kind = t->byref ? INVOKE_ARG_REF_BYREF : INVOKE_ARG_REF;
+			break;
+		case MONO_TYPE_GENERICINST:
+			if (t->byref)
+				t = &t->data.generic_class->container_class->this_arg;
+			else
+				t = &t->data.generic_class->container_class->byval_arg;
+			goto again;
+		case MONO_TYPE_PTR:
+			arg->kind = INVOKE_ARG_PTR;
+			break;
+		default:
+			g_error ("type 0x%x not handled in mono_runtime_invoke_array", sig->params [i]->type);
+		}
+	}
+
+	return plan;
+}
+
+static InvokePlan*
+get_invoke_plan (MonoDomain *domain, MonoMethod *method)
+{
+	static gboolean inited;
+	InvokePlan *plan, *plan2;
+
+	plan = mono_conc_hashtable_lookup (domain->invoke_plan_hash, method);
+	if (plan) {
+		invoke_plan_hits++;
+		return plan;
+	}
+
+	if (!inited) {
+		mono_counters_register ("Reflection invoke plan hits", MONO_COUNTER_RUNTIME | MONO_COUNTER_INT, &invoke_plan_hits);
+		mono_counters_register ("Reflection invoke plan misses", MONO_COUNTER_RUNTIME | MONO_COUNTER_INT, &invoke_plan_misses);
+		inited = TRUE;
+	}
+	invoke_plan_misses++;
+
+	plan = create_invoke_plan (method);
+	plan2 = mono_conc_hashtable_insert (domain->invoke_plan_hash, method, plan);
+	if (plan2) {
+		g_free (plan);
+		plan = plan2;
+	}
+	return plan;
+}
+
 /**
  * mono_runtime_invoke_array:
  * @method: method to invoke
@@ -4197,7 +4493,8 @@ MonoObject*
 mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 			   MonoObject **exc)
 {
-	MonoMethodSignature *sig = mono_method_signature (method);
+	MonoDomain *domain = mono_domain_get ();
+	InvokePlan *plan = get_invoke_plan (domain, method);
 	gpointer *pa = NULL;
 	MonoObject *res;
 	int i;
@@ -4206,69 +4503,45 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 	if (NULL != params) {
 		pa = alloca (sizeof (gpointer) * mono_array_length (params));
 		for (i = 0; i < mono_array_length (params); i++) {
-			MonoType *t = sig->params [i];
-
-		again:
-			switch (t->type) {
-			case MONO_TYPE_U1:
-			case MONO_TYPE_I1:
-			case MONO_TYPE_BOOLEAN:
-			case MONO_TYPE_U2:
-			case MONO_TYPE_I2:
-			case MONO_TYPE_CHAR:
-			case MONO_TYPE_U:
-			case MONO_TYPE_I:
-			case MONO_TYPE_U4:
-			case MONO_TYPE_I4:
-			case MONO_TYPE_U8:
-			case MONO_TYPE_I8:
-			case MONO_TYPE_R4:
-			case MONO_TYPE_R8:
-			case MONO_TYPE_VALUETYPE:
-				if (t->type == MONO_TYPE_VALUETYPE && mono_class_is_nullable (mono_class_from_mono_type (sig->params [i]))) {
-					/* The runtime invoke wrapper needs the original boxed vtype, it does handle byref values as well. */
-					pa [i] = mono_array_get (params, MonoObject*, i);
-					if (t->byref)
-						has_byref_nullables = TRUE;
-				} else {
-					/* MS seems to create the objects if a null is passed in */
-					if (!mono_array_get (params, MonoObject*, i))
-						mono_array_setref (params, i, mono_object_new (mono_domain_get (), mono_class_from_mono_type (sig->params [i]))); 
-
-					if (t->byref) {
-						/*
-						 * We can't pass the unboxed vtype byref to the callee, since
-						 * that would mean the callee would be able to modify boxed
-						 * primitive types. So we (and MS) make a copy of the boxed
-						 * object, pass that to the callee, and replace the original
-						 * boxed object in the arg array with the copy.
-						 */
-						MonoObject *orig = mono_array_get (params, MonoObject*, i);
-						MonoObject *copy = mono_value_box (mono_domain_get (), orig->vtable->klass, mono_object_unbox (orig));
-						mono_array_setref (params, i, copy);
-					}
-						
-					pa [i] = mono_object_unbox (mono_array_get (params, MonoObject*, i));
+			InvokeArg *arg = &plan->args [i];
+
+			switch (arg->kind) {
+			case INVOKE_ARG_VTYPE:
+			case INVOKE_ARG_VTYPE_BYREF:
+				/* MS seems to create the objects if a null is passed in */
+				if (!mono_array_get (params, MonoObject*, i))
+					mono_array_setref (params, i, mono_object_new (domain, arg->klass));
+
+				if (arg->kind == INVOKE_ARG_VTYPE_BYREF) {
+					/*
+					 * We can't pass the unboxed vtype byref to the callee, since
+					 * that would mean the callee would be able to modify boxed
+					 * primitive types. So we (and MS) make a copy of the boxed
+					 * object, pass that to the callee, and replace the original
+					 * boxed object in the arg array with the copy.
+					 */
+					MonoObject *orig = mono_array_get (params, MonoObject*, i);
+					MonoObject *copy = mono_value_box (domain, orig->vtable->klass, mono_object_unbox (orig));
+					mono_array_setref (params, i, copy);
 				}
+
+				pa [i] = mono_object_unbox (mono_array_get (params, MonoObject*, i));
 				break;
-			case MONO_TYPE_STRING:
-			case MONO_TYPE_OBJECT:
-			case MONO_TYPE_CLASS:
-			case MONO_TYPE_ARRAY:
-			case MONO_TYPE_SZARRAY:
-				if (t->byref)
-					pa [i] = mono_array_addr (params, MonoObject*, i);
-					// FIXME: I need to check this code path
-				else
-					pa [i] = mono_array_get (params, MonoObject*, i);
+			case INVOKE_ARG_NULLABLE_BYREF:
+				has_byref_nullables = TRUE;
+				/* Fall through */
+			case INVOKE_ARG_NULLABLE:
+				/* The runtime invoke wrapper needs the original boxed vtype, it does handle byref values as well. */
+				pa [i] = mono_array_get (params, MonoObject*, i);
 				break;
-			case MONO_TYPE_GENERICINST:
-				if (t->byref)
-					t = &t->data.generic_class->container_class->this_arg;
-				else
-					t = &t->data.generic_class->container_class->byval_arg;
-				goto again;
-			case MONO_TYPE_PTR: {
+			case INVOKE_ARG_REF:
+				pa [i] = mono_array_get (params, MonoObject*, i);
+				break;
+			case INVOKE_ARG_REF_BYREF:
+				// FIXME: I need to check this code path
+				pa [i] = mono_array_addr (params, MonoObject*, i);
+				break;
+			case INVOKE_ARG_PTR: {
 				MonoObject *arg;
 
 				/* The argument should be an IntPtr */
@@ -4282,12 +4555,12 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 				break;
 			}
 			default:
-				g_error ("type 0x%x not handled in mono_runtime_invoke_array", sig->params [i]->type);
+				g_assert_not_reached ();
 			}
 		}
 	}
 
-	if (!strcmp (method->name, ".ctor") && method->klass != mono_defaults.string_class) {
+	if (plan->is_ctor) {
 		void *o = obj;
 
 		if (mono_class_is_nullable (method->klass)) {
@@ -4297,11 +4570,11 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 			if (!params)
 				return NULL;
 			else
-				return mono_value_box (mono_domain_get (), method->klass->cast_class, pa [0]);
+				return mono_value_box (domain, method->klass->cast_class, pa [0]);
 		}
 
 		if (!obj) {
-			obj = mono_object_new (mono_domain_get (), method->klass);
+			obj = mono_object_new (domain, method->klass);
 			g_assert (obj); /*maybe we should raise a TLE instead?*/
 #ifndef DISABLE_REMOTING
 			if (mono_object_class(obj) == mono_defaults.transparent_proxy_class) {
@@ -4313,7 +4586,7 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 			else
 				o = obj;
 		} else if (method->klass->valuetype) {
-			obj = mono_value_box (mono_domain_get (), method->klass, obj);
+			obj = mono_value_box (domain, method->klass, obj);
 		}
 
 		mono_runtime_invoke (method, o, pa, exc);
@@ -4323,16 +4596,16 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 			MonoObject *nullable;
 
 			/* Convert the unboxed vtype into a Nullable structure */
-			nullable = mono_object_new (mono_domain_get (), method->klass);
+			nullable = mono_object_new (domain, method->klass);
 
-			mono_nullable_init (mono_object_unbox (nullable), mono_value_box (mono_domain_get (), method->klass->cast_class, obj), method->klass);
+			mono_nullable_init (mono_object_unbox (nullable), mono_value_box (domain, method->klass->cast_class, obj), method->klass);
 			obj = mono_object_unbox (nullable);
 		}
 
 		/* obj must be already unboxed if needed */
 		res = mono_runtime_invoke (method, obj, pa, exc);
 
-		if (sig->ret->type == MONO_TYPE_PTR) {
+		if (plan->ret_is_ptr) {
 			MonoClass *pointer_class;
 			static MonoMethod *box_method;
 			void *box_args [2];
@@ -4348,7 +4621,7 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 
 			g_assert (res->vtable->klass == mono_defaults.int_class);
 			box_args [0] = ((MonoIntPtr*)res)->m_value;
-			box_args [1] = mono_type_get_object (mono_domain_get (), sig->ret);
+			box_args [1] = mono_type_get_object (domain, mono_method_signature (method)->ret);
 			res = mono_runtime_invoke (box_method, NULL, box_args, &box_exc);
 			g_assert (!box_exc);
 		}
@@ -4360,9 +4633,7 @@ mono_runtime_invoke_array (MonoMethod *method, void *obj, MonoArray *params,
 			 * managed array.
 			 */
 			for (i = 0; i < mono_array_length (params); i++) {
-				MonoType *t = sig->params [i];
-
-				if (t->byref && t->type == MONO_TYPE_GENERICINST && mono_class_is_nullable (mono_class_from_mono_type (t)))
+				if (plan->args [i].kind == INVOKE_ARG_NULLABLE_BYREF)
 					mono_array_setref (params, i, pa [i]);
 			}
 		}
@@ -5083,6 +5354,23 @@ mono_string_new_size (MonoDomain *domain, gint32 len)
 	return s;
 }
 
+/*
+ * Create a string from the ASCII string TEXT without an intermediate UTF-16 copy.
+ * Returns NULL if TEXT contains other characters.
+ */
+static MonoString*
+string_new_ascii (MonoDomain *domain, const char *text, glong length)
+{
+	MonoString *o;
+
+	if (eg_utf8_ascii_prefix (text, length) != length)
+		return NULL;
+
+	o = mono_string_new_size (domain, length);
+	eg_ascii_to_utf16 (text, length, mono_string_chars (o));
+	return o;
+}
+
 /**
  * mono_string_new_len:
  * @text: a pointer to an utf8 string
@@ -5098,6 +5386,10 @@ mono_string_new_len (MonoDomain *domain, const char *text, guint length)
 	guint16 *ut;
 	glong items_written;
 
+	o = string_new_ascii (domain, text, length);
+	if (o)
+		return o;
+
 	ut = eg_utf8_to_utf16_with_nuls (text, length, NULL, &items_written, &error);
 
 	if (!error)
@@ -5126,6 +5418,10 @@ mono_string_new (MonoDomain *domain, const char *text)
     int l;
 
     l = strlen (text);
+
+    o = string_new_ascii (domain, text, l);
+    if (o)
+        return o;
    
     ut = g_utf8_to_utf16 (text, l, NULL, &items_written, &error);
 
@@ -5444,7 +5740,7 @@ str_lookup (MonoDomain *domain, gpointer user_data)
 	LDStrInfo *info = user_data;
 	if (info->res || domain == info->orig_domain)
 		return;
-	info->res = mono_g_hash_table_lookup (domain->ldstr_table, info->ins);
+	info->res = mono_intern_table_lookup (domain->ldstr_table, info->ins);
 }
 
 #ifdef HAVE_SGEN_GC
@@ -5470,22 +5766,18 @@ mono_string_get_pinned (MonoString *str)
 static MonoString*
 mono_string_is_interned_lookup (MonoString *str, int insert)
 {
-	MonoGHashTable *ldstr_table;
+	MonoInternTable *ldstr_table;
 	MonoString *res;
 	MonoDomain *domain;
 	
 	domain = ((MonoObject *)str)->vtable->domain;
 	ldstr_table = domain->ldstr_table;
-	ldstr_lock ();
-	if ((res = mono_g_hash_table_lookup (ldstr_table, str))) {
-		ldstr_unlock ();
+	if ((res = mono_intern_table_lookup (ldstr_table, str)))
 		return res;
-	}
 	if (insert) {
 		str = mono_string_get_pinned (str);
 		if (str)
-			mono_g_hash_table_insert (ldstr_table, str, str);
-		ldstr_unlock ();
+			str = mono_intern_table_insert (ldstr_table, str);
 		return str;
 	} else {
 		LDStrInfo ldstr_info;
@@ -5499,12 +5791,12 @@ mono_string_is_interned_lookup (MonoString *str, int insert)
 			 * the string was already interned in some other domain:
 			 * intern it in the current one as well.
 			 */
-			mono_g_hash_table_insert (ldstr_table, str, str);
-			ldstr_unlock ();
+			str = mono_string_get_pinned (str);
+			if (str)
+				str = mono_intern_table_insert (ldstr_table, str);
 			return str;
 		}
 	}
-	ldstr_unlock ();
 	return NULL;
 }
 
@@ -5585,17 +5877,14 @@ mono_ldstr_metadata_sig (MonoDomain *domain, const char* sig)
 		}
 	}
 #endif
-	ldstr_lock ();
-	if ((interned = mono_g_hash_table_lookup (domain->ldstr_table, o))) {
-		ldstr_unlock ();
+	if ((interned = mono_intern_table_lookup (domain->ldstr_table, o))) {
 		/* o will get garbage collected */
 		return interned;
 	}
 
 	o = mono_string_get_pinned (o);
 	if (o)
-		mono_g_hash_table_insert (domain->ldstr_table, o, o);
-	ldstr_unlock ();
+		o = mono_intern_table_insert (domain->ldstr_table, o);
 
 	return o;
 }
@@ -6318,7 +6607,10 @@ mono_delegate_ctor_with_method (MonoObject *this, MonoObject *target, gpointer a
 		MONO_OBJECT_SETREF (delegate, target, target);
 	}
 
-	delegate->invoke_impl = arch_create_delegate_trampoline (delegate->object.vtable->domain, delegate->object.vtable->klass);
+	if (callbacks.init_delegate)
+		callbacks.init_delegate (delegate);
+	else
+		delegate->invoke_impl = arch_create_delegate_trampoline (delegate->object.vtable->domain, delegate->object.vtable->klass);
 }
 
 /**
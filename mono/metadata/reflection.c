@@ -8701,13 +8701,14 @@ mono_custom_attrs_data_construct (MonoCustomAttrInfo *cinfo)
 	return result;
 }
 
-/**
- * mono_custom_attrs_from_index:
+/*
+ * custom_attrs_from_index_uncached:
  *
- * Returns: NULL if no attributes are found or if a loading error occurs.
+ *   Set *NO_ROWS to whether the CustomAttribute table has no rows for IDX, which
+ * tells that case apart from a failure when NULL is returned.
  */
-MonoCustomAttrInfo*
-mono_custom_attrs_from_index (MonoImage *image, guint32 idx)
+static MonoCustomAttrInfo*
+custom_attrs_from_index_uncached (MonoImage *image, guint32 idx, gboolean *no_rows)
 {
 	guint32 mtoken, i, len;
 	guint32 cols [MONO_CUSTOM_ATTR_SIZE];
@@ -8718,6 +8719,7 @@ mono_custom_attrs_from_index (MonoImage *image, guint32 idx)
 
 	ca = &image->tables [MONO_TABLE_CUSTOMATTRIBUTE];
 
+	*no_rows = TRUE;
 	i = mono_metadata_custom_attrs_from_index (image, idx);
 	if (!i)
 		return NULL;
@@ -8731,6 +8733,7 @@ mono_custom_attrs_from_index (MonoImage *image, guint32 idx)
 	len = g_list_length (list);
 	if (!len)
 		return NULL;
+	*no_rows = FALSE;
 	ainfo = g_malloc0 (MONO_SIZEOF_CUSTOM_ATTR_INFO + sizeof (MonoCustomAttrEntry) * len);
 	ainfo->num_attrs = len;
 	ainfo->image = image;
@@ -8772,6 +8775,47 @@ mono_custom_attrs_from_index (MonoImage *image, guint32 idx)
 	return ainfo;
 }
 
+/* Stored in image->cattr_cache for indexes without custom attributes */
+static MonoCustomAttrInfo no_cattrs;
+
+/**
+ * mono_custom_attrs_from_index:
+ *
+ * The decoded entries are cached in IMAGE, so looking up the attributes of the
+ * same index again doesn't read the CustomAttribute table or allocate. The result
+ * is marked as cached, mono_custom_attrs_free () doesn't free it.
+ *
+ * Returns: NULL if no attributes are found or if a loading error occurs.
+ */
+MonoCustomAttrInfo*
+mono_custom_attrs_from_index (MonoImage *image, guint32 idx)
+{
+	MonoCustomAttrInfo *ainfo, *cached;
+	gboolean no_rows;
+	int size;
+
+	ainfo = mono_conc_hashtable_lookup (image->cattr_cache, GUINT_TO_POINTER (idx));
+	if (ainfo)
+		return ainfo == &no_cattrs ? NULL : ainfo;
+
+	ainfo = custom_attrs_from_index_uncached (image, idx, &no_rows);
+	if (!ainfo) {
+		/* Don't cache loading errors or invalid blobs, only the absence of attributes */
+		if (no_rows)
+			mono_conc_hashtable_insert (image->cattr_cache, GUINT_TO_POINTER (idx), &no_cattrs);
+		return NULL;
+	}
+
+	size = MONO_SIZEOF_CUSTOM_ATTR_INFO + sizeof (MonoCustomAttrEntry) * ainfo->num_attrs;
+	cached = mono_image_alloc (image, size);
+	memcpy (cached, ainfo, size);
+	cached->cached = 1;
+	g_free (ainfo);
+
+	ainfo = mono_conc_hashtable_insert (image->cattr_cache, GUINT_TO_POINTER (idx), cached);
+	return ainfo && ainfo != &no_cattrs ? ainfo : cached;
+}
+
 MonoCustomAttrInfo*
 mono_custom_attrs_from_method (MonoMethod *method)
 {
@@ -10984,6 +11028,7 @@ fix_partial_generic_class (MonoClass *klass)
 		klass->interface_count = gklass->interface_count;
 		klass->interfaces = mono_image_alloc (klass->image, sizeof (MonoClass*) * gklass->interface_count);
 		klass->interfaces_packed = NULL; /*make setup_interface_offsets happy*/
+		klass->interface_hash = NULL;
 
 		for (i = 0; i < gklass->interface_count; ++i) {
 			MonoType *iface_type = mono_class_inflate_generic_type (&gklass->interfaces [i]->byval_arg, mono_class_get_context (klass));
@@ -11069,6 +11114,7 @@ ensure_runtime_vtable (MonoClass *klass)
 		}
 		
 		klass->interfaces_packed = NULL; /*make setup_interface_offsets happy*/
+		klass->interface_hash = NULL;
 		mono_class_setup_interface_offsets (klass);
 		mono_class_setup_interface_id (klass);
 	}
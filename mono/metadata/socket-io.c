@@ -1582,6 +1582,228 @@ gint32 ves_icall_System_Net_Sockets_Socket_SendTo_internal(SOCKET sock, MonoArra
 	return(ret);
 }
 
+/* The largest number of datagrams transferred by one ReceiveMessages_internal/SendMessages_internal call */
+#define MAX_MESSAGE_BATCH 1024
+
+/*
+ * ves_icall_System_Net_Sockets_Socket_ReceiveMessages_internal:
+ *
+ *   Receive a batch of datagrams into the BUFFERS/OFFSETS/COUNTS segments with a single
+ * system call where possible. On return, COUNTS holds the length of each received datagram
+ * and, if SOCKADDRS is not NULL, SOCKADDRS holds the address of its sender. Blocks until
+ * at least one datagram is available. Returns the number of datagrams received. If a
+ * later datagram fails after some were received, ERROR is set along with the partial
+ * count, and the caller reports it on its next call.
+ */
+gint32
+ves_icall_System_Net_Sockets_Socket_ReceiveMessages_internal (SOCKET sock, MonoArray *buffers, MonoArray *offsets, MonoArray *counts, MonoArray *sockaddrs, gint32 flags, gint32 *error)
+{
+	int i, n, ret, recvflags;
+	gint32 addr_error;
+	MonoObject *sockaddr_obj;
+#ifndef HOST_WIN32
+	WapiMMsgHdr *msgs;
+	struct iovec *iovs;
+	struct sockaddr_storage *addrs;
+#else
+	struct sockaddr_storage sa;
+	socklen_t sa_size;
+#endif
+
+	*error = 0;
+
+	n = MIN (mono_array_length (buffers), MAX_MESSAGE_BATCH);
+	for (i = 0; i < n; ++i) {
+		MonoArray *buffer = mono_array_get (buffers, MonoArray*, i);
+		gint32 offset = mono_array_get (offsets, gint32, i);
+		gint32 count = mono_array_get (counts, gint32, i);
+
+		if (!buffer || offset < 0 || count < 0 || offset > mono_array_length (buffer) - count) {
+			*error = WSAEFAULT;
+			return 0;
+		}
+	}
+
+	recvflags = convert_socketflags (flags);
+	if (recvflags == -1) {
+		*error = WSAEOPNOTSUPP;
+		return 0;
+	}
+
+#ifndef HOST_WIN32
+	msgs = g_new0 (WapiMMsgHdr, n);
+	iovs = g_new0 (struct iovec, n);
+	addrs = sockaddrs ? g_new0 (struct sockaddr_storage, n) : NULL;
+
+	for (i = 0; i < n; ++i) {
+		iovs [i].iov_base = mono_array_addr (mono_array_get (buffers, MonoArray*, i), guchar, mono_array_get (offsets, gint32, i));
+		iovs [i].iov_len = mono_array_get (counts, gint32, i);
+		msgs [i].msg_hdr.msg_iov = &iovs [i];
+		msgs [i].msg_hdr.msg_iovlen = 1;
+		if (addrs) {
+			msgs [i].msg_hdr.msg_name = &addrs [i];
+			msgs [i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		}
+	}
+
+	WSASetLastError (0);
+	ret = _wapi_recvmmsg (sock, msgs, n, recvflags);
+	if (ret == SOCKET_ERROR) {
+		*error = WSAGetLastError ();
+		ret = 0;
+	} else if (ret < n) {
+		/* The datagrams after the first one are only taken if already queued */
+		gint32 last_error = WSAGetLastError ();
+		if (last_error != WSAEWOULDBLOCK)
+			*error = last_error;
+	}
+
+	for (i = 0; i < ret; ++i) {
+		mono_array_set (counts, gint32, i, msgs [i].msg_len);
+		if (addrs) {
+			sockaddr_obj = NULL;
+			if (msgs [i].msg_hdr.msg_namelen)
+				sockaddr_obj = create_object_from_sockaddr ((struct sockaddr *)&addrs [i], msgs [i].msg_hdr.msg_namelen, &addr_error);
+			mono_array_setref (sockaddrs, i, sockaddr_obj);
+		}
+	}
+
+	g_free (addrs);
+	g_free (iovs);
+	g_free (msgs);
+#else
+	/* Winsock has no batched receive, return one datagram per call */
+	if (n == 0)
+		return 0;
+	sa_size = sizeof (sa);
+	ret = _wapi_recvfrom (sock, mono_array_addr (mono_array_get (buffers, MonoArray*, 0), guchar, mono_array_get (offsets, gint32, 0)),
+			      mono_array_get (counts, gint32, 0), recvflags, (struct sockaddr *)&sa, &sa_size);
+	if (ret == SOCKET_ERROR) {
+		*error = WSAGetLastError ();
+		return 0;
+	}
+	mono_array_set (counts, gint32, 0, ret);
+	if (sockaddrs) {
+		sockaddr_obj = sa_size ? create_object_from_sockaddr ((struct sockaddr *)&sa, sa_size, &addr_error) : NULL;
+		mono_array_setref (sockaddrs, 0, sockaddr_obj);
+	}
+	ret = 1;
+#endif
+
+	return ret;
+}
+
+/*
+ * ves_icall_System_Net_Sockets_Socket_SendMessages_internal:
+ *
+ *   Send the datagrams in the BUFFERS/OFFSETS/COUNTS segments, each to the corresponding
+ * address in SOCKADDRS, or to the connected peer if SOCKADDRS is NULL, with a single system
+ * call where possible. On return, COUNTS holds the number of bytes sent for each datagram.
+ * Returns the number of datagrams sent, which can be less than requested. If a later
+ * datagram fails after some were sent, ERROR is set along with the partial count, and
+ * the caller reports it on its next call.
+ */
+gint32
+ves_icall_System_Net_Sockets_Socket_SendMessages_internal (SOCKET sock, MonoArray *buffers, MonoArray *offsets, MonoArray *counts, MonoArray *sockaddrs, gint32 flags, gint32 *error)
+{
+	int i, n, ret, sendflags;
+	struct sockaddr **addrs;
+	socklen_t *addr_sizes;
+#ifndef HOST_WIN32
+	WapiMMsgHdr *msgs;
+	struct iovec *iovs;
+#endif
+
+	*error = 0;
+
+	n = MIN (mono_array_length (buffers), MAX_MESSAGE_BATCH);
+	for (i = 0; i < n; ++i) {
+		MonoArray *buffer = mono_array_get (buffers, MonoArray*, i);
+		gint32 offset = mono_array_get (offsets, gint32, i);
+		gint32 count = mono_array_get (counts, gint32, i);
+
+		if (!buffer || offset < 0 || count < 0 || offset > mono_array_length (buffer) - count) {
+			*error = WSAEFAULT;
+			return 0;
+		}
+	}
+
+	sendflags = convert_socketflags (flags);
+	if (sendflags == -1) {
+		*error = WSAEOPNOTSUPP;
+		return 0;
+	}
+
+	addrs = g_new0 (struct sockaddr*, n);
+	addr_sizes = g_new0 (socklen_t, n);
+	for (i = 0; sockaddrs && i < n; ++i) {
+		MonoObject *sockaddr_obj = mono_array_get (sockaddrs, MonoObject*, i);
+
+		if (!sockaddr_obj)
+			continue;
+		addrs [i] = create_sockaddr_from_object (sockaddr_obj, &addr_sizes [i], error);
+		if (*error) {
+			n = i;
+			ret = 0;
+			goto done;
+		}
+	}
+
+#ifndef HOST_WIN32
+	msgs = g_new0 (WapiMMsgHdr, n);
+	iovs = g_new0 (struct iovec, n);
+
+	for (i = 0; i < n; ++i) {
+		iovs [i].iov_base = mono_array_addr (mono_array_get (buffers, MonoArray*, i), guchar, mono_array_get (offsets, gint32, i));
+		iovs [i].iov_len = mono_array_get (counts, gint32, i);
+		msgs [i].msg_hdr.msg_iov = &iovs [i];
+		msgs [i].msg_hdr.msg_iovlen = 1;
+		msgs [i].msg_hdr.msg_name = addrs [i];
+		msgs [i].msg_hdr.msg_namelen = addr_sizes [i];
+	}
+
+	WSASetLastError (0);
+	ret = _wapi_sendmmsg (sock, msgs, n, sendflags);
+	if (ret == SOCKET_ERROR) {
+		*error = WSAGetLastError ();
+		ret = 0;
+	} else if (ret < n) {
+		/* Running out of buffer space on a non-blocking socket is not an error */
+		gint32 last_error = WSAGetLastError ();
+		if (last_error != WSAEWOULDBLOCK)
+			*error = last_error;
+	}
+
+	for (i = 0; i < ret; ++i)
+		mono_array_set (counts, gint32, i, msgs [i].msg_len);
+
+	g_free (iovs);
+	g_free (msgs);
+#else
+	/* Winsock has no batched send, send the datagrams one by one */
+	for (ret = 0; ret < n; ++ret) {
+		int sent = _wapi_sendto (sock, mono_array_addr (mono_array_get (buffers, MonoArray*, ret), guchar, mono_array_get (offsets, gint32, ret)),
+					 mono_array_get (counts, gint32, ret), sendflags, addrs [ret], addr_sizes [ret]);
+		if (sent == SOCKET_ERROR) {
+			*error = WSAGetLastError ();
+			/* Running out of buffer space on a non-blocking socket is not an error */
+			if (ret > 0 && *error == WSAEWOULDBLOCK)
+				*error = 0;
+			break;
+		}
+		mono_array_set (counts, gint32, ret, sent);
+	}
+#endif
+
+done:
+	for (i = 0; i < n; ++i)
+		g_free (addrs [i]);
+	g_free (addr_sizes);
+	g_free (addrs);
+
+	return ret;
+}
+
 static SOCKET Socket_to_SOCKET(MonoObject *sockobj)
 {
 	SOCKET sock;
@@ -2489,12 +2711,17 @@ extern MonoBoolean ves_icall_System_Net_Dns_GetHostName_internal(MonoString **h_
 	return(TRUE);
 }
 
+/* TransmitFile () sends at most 2GB at a time */
+#define MAX_TRANSMIT_FILE_COUNT 0x7ffffffe
+
 gboolean
-ves_icall_System_Net_Sockets_Socket_SendFile (SOCKET sock, MonoString *filename, MonoArray *pre_buffer, MonoArray *post_buffer, gint flags)
+ves_icall_System_Net_Sockets_Socket_SendFile (SOCKET sock, MonoString *filename, gint64 offset, gint64 count, MonoArray *pre_buffer, MonoArray *post_buffer, gint flags)
 {
 	HANDLE file;
 	gint32 error;
+	gint32 offset_high;
 	TRANSMIT_FILE_BUFFERS buffers;
+	MonoArray *tail;
 
 	MONO_ARCH_SAVE_REGS;
 
@@ -2512,15 +2739,37 @@ ves_icall_System_Net_Sockets_Socket_SendFile (SOCKET sock, MonoString *filename,
 		buffers.Head = mono_array_addr (pre_buffer, guchar, 0);
 		buffers.HeadLength = mono_array_length (pre_buffer);
 	}
-	if (post_buffer != NULL) {
-		buffers.Tail = mono_array_addr (post_buffer, guchar, 0);
-		buffers.TailLength = mono_array_length (post_buffer);
-	}
 
-	if (!TransmitFile (sock, file, 0, 0, NULL, &buffers, flags)) {
-		CloseHandle (file);
-		return FALSE;
-	}
+	/*
+	 * A COUNT of 0 sends the rest of the file. Larger ranges are sent in several
+	 * calls, with the head in the first one and the tail in the last one, so a
+	 * response still goes out without returning to managed code.
+	 */
+	do {
+		guint32 chunk = count > MAX_TRANSMIT_FILE_COUNT ? MAX_TRANSMIT_FILE_COUNT : count;
+
+		tail = chunk == count ? post_buffer : NULL;
+		if (tail != NULL) {
+			buffers.Tail = mono_array_addr (tail, guchar, 0);
+			buffers.TailLength = mono_array_length (tail);
+		}
+
+		offset_high = offset >> 32;
+		if (SetFilePointer (file, (gint32)(offset & 0xffffffff), &offset_high, FILE_BEGIN) == INVALID_SET_FILE_POINTER && GetLastError () != NO_ERROR) {
+			CloseHandle (file);
+			return FALSE;
+		}
+
+		if (!TransmitFile (sock, file, chunk, 0, NULL, &buffers, tail != NULL ? flags : flags & ~TF_DISCONNECT)) {
+			CloseHandle (file);
+			return FALSE;
+		}
+
+		buffers.Head = NULL;
+		buffers.HeadLength = 0;
+		offset += chunk;
+		count -= chunk;
+	} while (count > 0);
 
 	CloseHandle (file);
 	return TRUE;
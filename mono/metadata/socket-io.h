@@ -208,6 +208,8 @@ extern gint32 ves_icall_System_Net_Sockets_Socket_RecvFrom_internal(SOCKET sock,
 extern gint32 ves_icall_System_Net_Sockets_Socket_Send_internal(SOCKET sock, MonoArray *buffer, gint32 offset, gint32 count, gint32 flags, gint32 *error) MONO_INTERNAL;
 extern gint32 ves_icall_System_Net_Sockets_Socket_Send_array_internal(SOCKET sock, MonoArray *buffers, gint32 flags, gint32 *error) MONO_INTERNAL;
 extern gint32 ves_icall_System_Net_Sockets_Socket_SendTo_internal(SOCKET sock, MonoArray *buffer, gint32 offset, gint32 count, gint32 flags, MonoObject *sockaddr, gint32 *error) MONO_INTERNAL;
+extern gint32 ves_icall_System_Net_Sockets_Socket_ReceiveMessages_internal (SOCKET sock, MonoArray *buffers, MonoArray *offsets, MonoArray *counts, MonoArray *sockaddrs, gint32 flags, gint32 *error) MONO_INTERNAL;
+extern gint32 ves_icall_System_Net_Sockets_Socket_SendMessages_internal (SOCKET sock, MonoArray *buffers, MonoArray *offsets, MonoArray *counts, MonoArray *sockaddrs, gint32 flags, gint32 *error) MONO_INTERNAL;
 extern void ves_icall_System_Net_Sockets_Socket_Select_internal(MonoArray **sockets, gint32 timeout, gint32 *error) MONO_INTERNAL;
 extern void ves_icall_System_Net_Sockets_Socket_Shutdown_internal(SOCKET sock, gint32 how, gint32 *error) MONO_INTERNAL;
 extern void ves_icall_System_Net_Sockets_Socket_GetSocketOption_obj_internal(SOCKET sock, gint32 level, gint32 name, MonoObject **obj_val, gint32 *error) MONO_INTERNAL;
@@ -219,7 +221,7 @@ extern MonoBoolean ves_icall_System_Net_Dns_GetHostByAddr_internal(MonoString *a
 extern MonoBoolean ves_icall_System_Net_Dns_GetHostName_internal(MonoString **h_name) MONO_INTERNAL;
 extern MonoBoolean ves_icall_System_Net_Sockets_Socket_Poll_internal (SOCKET sock, gint mode, gint timeout, gint32 *error) MONO_INTERNAL;
 extern void ves_icall_System_Net_Sockets_Socket_Disconnect_internal(SOCKET sock, MonoBoolean reuse, gint32 *error) MONO_INTERNAL;
-extern gboolean ves_icall_System_Net_Sockets_Socket_SendFile (SOCKET sock, MonoString *filename, MonoArray *pre_buffer, MonoArray *post_buffer, gint flags) MONO_INTERNAL;
+extern gboolean ves_icall_System_Net_Sockets_Socket_SendFile (SOCKET sock, MonoString *filename, gint64 offset, gint64 count, MonoArray *pre_buffer, MonoArray *post_buffer, gint flags) MONO_INTERNAL;
 void icall_cancel_blocking_socket_operation (MonoThread *thread) MONO_INTERNAL;
 
 extern void mono_network_init(void) MONO_INTERNAL;
@@ -0,0 +1,133 @@
+/*
+ * string-intern.c: Per-domain table of interned strings
+ *
+ * Every ldstr resolution and every call to String.Intern () looks a string up
+ * in this table, so lookups must not take a lock. The table is split into
+ * stripes, each made of a MonoConcurrentHashTable for lock-free lookups keyed
+ * on the string contents, and a MonoGHashTable which is registered with the GC
+ * and keeps the interned strings alive. Inserting a string only takes the lock
+ * of its stripe.
+ *
+ * The concurrent tables hold raw pointers the GC doesn't know about, so only
+ * pinned strings can be inserted, see mono_string_get_pinned () in object.c.
+ * Interned strings are strong references: JITted code embeds the address of
+ * the strings returned by mono_ldstr (), so they must stay alive as long as the
+ * domain does.
+ *
+ * Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include <mono/metadata/string-intern.h>
+#include <mono/metadata/gc-internal.h>
+#include <mono/metadata/mono-hash.h>
+#include <mono/utils/mono-conc-hashtable.h>
+
+#define INTERN_STRIPES 16
+
+typedef struct {
+	mono_mutex_t lock;
+	MonoConcurrentHashTable *strings;
+	/* Owns the strings in STRINGS, only accessed with LOCK held */
+	MonoGHashTable *roots;
+} InternStripe;
+
+struct _MonoInternTable {
+	InternStripe stripes [INTERN_STRIPES];
+};
+
+/*
+ * Pick a stripe from a few characters of the string, so the whole string is
+ * only hashed once, by the concurrent table.
+ */
+static InternStripe*
+get_stripe (MonoInternTable *table, MonoString *str)
+{
+	int len = mono_string_length (str);
+	gunichar2 *chars = mono_string_chars (str);
+	guint h = len;
+
+	if (len) {
+		h = h * 31 + chars [0];
+		h = h * 31 + chars [len / 2];
+		h = h * 31 + chars [len - 1];
+	}
+	h *= 2654435761u;
+	return &table->stripes [h >> 28];
+}
+
+MonoInternTable*
+mono_intern_table_new (void)
+{
+	MonoInternTable *table;
+	int i;
+
+	/* Allocated from the GC so Boehm sees the root tables */
+	table = mono_gc_alloc_fixed (sizeof (MonoInternTable), NULL);
+	for (i = 0; i < INTERN_STRIPES; ++i) {
+		InternStripe *stripe = &table->stripes [i];
+
+		mono_mutex_init_recursive (&stripe->lock);
+		stripe->strings = mono_conc_hashtable_new (&stripe->lock, (GHashFunc)mono_string_hash, (GEqualFunc)mono_string_equal);
+		stripe->roots = mono_g_hash_table_new_type (NULL, NULL, MONO_HASH_KEY_GC);
+	}
+	return table;
+}
+
+/*
+ * mono_intern_table_destroy:
+ *
+ *   Free TABLE. No other thread may be accessing it.
+ */
+void
+mono_intern_table_destroy (MonoInternTable *table)
+{
+	int i;
+
+	for (i = 0; i < INTERN_STRIPES; ++i) {
+		InternStripe *stripe = &table->stripes [i];
+
+		mono_conc_hashtable_destroy (stripe->strings);
+		mono_g_hash_table_destroy (stripe->roots);
+		mono_mutex_destroy (&stripe->lock);
+	}
+	mono_gc_free_fixed (table);
+}
+
+/*
+ * mono_intern_table_lookup:
+ *
+ *   Return the string in TABLE equal to STR, or NULL.
+ * LOCKING: Lock-free.
+ */
+MonoString*
+mono_intern_table_lookup (MonoInternTable *table, MonoString *str)
+{
+	return mono_conc_hashtable_lookup (get_stripe (table, str)->strings, str);
+}
+
+/*
+ * mono_intern_table_insert:
+ *
+ *   Add STR to TABLE unless it already contains an equal string, and return the
+ * string in the table. STR must be pinned.
+ */
+MonoString*
+mono_intern_table_insert (MonoInternTable *table, MonoString *str)
+{
+	InternStripe *stripe = get_stripe (table, str);
+	MonoString *res;
+
+	mono_mutex_lock (&stripe->lock);
+	res = mono_conc_hashtable_lookup (stripe->strings, str);
+	if (!res) {
+		/* Root the string before other threads can find it */
+		mono_g_hash_table_insert (stripe->roots, str, str);
+		mono_conc_hashtable_insert (stripe->strings, str, str);
+		res = str;
+	}
+	mono_mutex_unlock (&stripe->lock);
+	return res;
+}
@@ -0,0 +1,28 @@
+/*
+ * string-intern.h: Per-domain table of interned strings
+ *
+ * Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+ */
+
+#ifndef __MONO_METADATA_STRING_INTERN_H__
+#define __MONO_METADATA_STRING_INTERN_H__
+
+#include <glib.h>
+#include <mono/metadata/object.h>
+#include <mono/utils/mono-compiler.h>
+
+typedef struct _MonoInternTable MonoInternTable;
+
+MonoInternTable*
+mono_intern_table_new (void) MONO_INTERNAL;
+
+void
+mono_intern_table_destroy (MonoInternTable *table) MONO_INTERNAL;
+
+MonoString*
+mono_intern_table_lookup (MonoInternTable *table, MonoString *str) MONO_INTERNAL;
+
+MonoString*
+mono_intern_table_insert (MonoInternTable *table, MonoString *str) MONO_INTERNAL;
+
+#endif /* __MONO_METADATA_STRING_INTERN_H__ */
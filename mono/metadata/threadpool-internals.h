@@ -33,5 +33,6 @@ void socket_io_cleanup (SocketIOData *data) MONO_INTERNAL;
 MonoObject *get_io_event (MonoMList **list, gint event) MONO_INTERNAL;
 int get_events_from_list (MonoMList *list) MONO_INTERNAL;
 void threadpool_append_async_io_jobs (MonoObject **jobs, gint njobs) MONO_INTERNAL;
+MonoObject *mono_thread_pool_new_io_job (MonoObject *target, MonoObject *state) MONO_INTERNAL;
 
 #endif
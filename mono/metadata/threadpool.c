@@ -23,6 +23,7 @@
 #include <mono/metadata/mono-mlist.h>
 #include <mono/metadata/mono-perfcounters.h>
 #include <mono/metadata/socket-io.h>
+#include <mono/metadata/file-io.h>
 #include <mono/metadata/mono-cq.h>
 #include <mono/metadata/mono-wsq.h>
 #include <mono/metadata/mono-ptr-array.h>
@@ -1036,6 +1037,18 @@ create_simple_asyncresult (MonoObject *target, MonoObject *state)
 	return ares;
 }
 
+/*
+ * mono_thread_pool_new_io_job:
+ *
+ *   Create a job which invokes the delegate TARGET with STATE on the IO threadpool,
+ * once it is queued with threadpool_append_async_io_jobs ().
+ */
+MonoObject *
+mono_thread_pool_new_io_job (MonoObject *target, MonoObject *state)
+{
+	return (MonoObject *) create_simple_asyncresult (target, state);
+}
+
 void
 icall_append_io_job (MonoObject *target, MonoSocketAsyncResult *state)
 {
@@ -1132,6 +1145,8 @@ threadpool_kill_idle_threads (ThreadPool *tp)
 void
 mono_thread_pool_cleanup (void)
 {
+	mono_file_io_uring_cleanup ();
+
 	if (InterlockedExchange (&async_io_tp.pool_status, 2) == 1) {
 		socket_io_cleanup (&socket_io_data); /* Empty when DISABLE_SOCKETS is defined */
 		threadpool_kill_idle_threads (&async_io_tp);
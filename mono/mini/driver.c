@@ -1056,6 +1056,8 @@ static void main_thread_handler (gpointer user_data)
 			exit (1);
 		}
 
+		mono_assembly_prefetch_references (assembly);
+
 		/* 
 		 * This must be done in a thread managed by mono since it can invoke
 		 * managed code.
@@ -555,6 +555,7 @@ mono_arch_find_jit_info (MonoDomain *domain, MonoJitTlsData *jit_tls,
 		guint32 unwind_info_len;
 		guint8 *unwind_info;
 		guint8 *epilog = NULL;
+		MonoUnwindPlan *plan;
 
 		frame->type = FRAME_TYPE_MANAGED;
 
@@ -585,10 +586,15 @@ mono_arch_find_jit_info (MonoDomain *domain, MonoJitTlsData *jit_tls,
 		regs [AMD64_R14] = new_ctx->r14;
 		regs [AMD64_R15] = new_ctx->r15;
 
-		mono_unwind_frame (unwind_info, unwind_info_len, ji->code_start, 
-						   (guint8*)ji->code_start + ji->code_size,
-						   ip, epilog ? &epilog : NULL, regs, MONO_MAX_IREGS + 1,
-						   save_locations, MONO_MAX_IREGS, &cfa);
+		plan = mono_jinfo_get_unwind_plan (ji);
+		if (plan)
+			mono_unwind_frame_with_plan (plan, ji->code_start, ip, epilog ? &epilog : NULL, regs, MONO_MAX_IREGS + 1,
+										 save_locations, MONO_MAX_IREGS, &cfa);
+		else
+			mono_unwind_frame (unwind_info, unwind_info_len, ji->code_start, 
+							   (guint8*)ji->code_start + ji->code_size,
+							   ip, epilog ? &epilog : NULL, regs, MONO_MAX_IREGS + 1,
+							   save_locations, MONO_MAX_IREGS, &cfa);
 
 		new_ctx->rax = regs [AMD64_RAX];
 		new_ctx->rbx = regs [AMD64_RBX];
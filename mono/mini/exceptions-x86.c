@@ -770,6 +770,7 @@ mono_arch_find_jit_info (MonoDomain *domain, MonoJitTlsData *jit_tls,
 		guint8 *cfa;
 		guint32 unwind_info_len;
 		guint8 *unwind_info;
+		MonoUnwindPlan *plan;
 
 		frame->type = FRAME_TYPE_MANAGED;
 
@@ -785,10 +786,15 @@ mono_arch_find_jit_info (MonoDomain *domain, MonoJitTlsData *jit_tls,
 		regs [X86_EDI] = new_ctx->edi;
 		regs [X86_NREG] = new_ctx->eip;
 
-		mono_unwind_frame (unwind_info, unwind_info_len, ji->code_start, 
-						   (guint8*)ji->code_start + ji->code_size,
-						   ip, NULL, regs, MONO_MAX_IREGS + 1,
-						   save_locations, MONO_MAX_IREGS, &cfa);
+		plan = mono_jinfo_get_unwind_plan (ji);
+		if (plan)
+			mono_unwind_frame_with_plan (plan, ji->code_start, ip, NULL, regs, MONO_MAX_IREGS + 1,
+										 save_locations, MONO_MAX_IREGS, &cfa);
+		else
+			mono_unwind_frame (unwind_info, unwind_info_len, ji->code_start, 
+							   (guint8*)ji->code_start + ji->code_size,
+							   ip, NULL, regs, MONO_MAX_IREGS + 1,
+							   save_locations, MONO_MAX_IREGS, &cfa);
 
 		new_ctx->eax = regs [X86_EAX];
 		new_ctx->ebx = regs [X86_EBX];
@@ -2731,6 +2731,45 @@ class Tests
 		}
 		return 1;
 	}
+
+	static int throw_site_finallys;
+
+	[MethodImpl(MethodImplOptions.NoInlining)]
+	static Exception throw_site_create (int kind) {
+		if (kind == 0)
+			return new ArgumentException ();
+		else
+			return new InvalidOperationException ();
+	}
+
+	[MethodImpl(MethodImplOptions.NoInlining)]
+	static int throw_site_catch (int kind) {
+		try {
+			try {
+				throw throw_site_create (kind);
+			} finally {
+				throw_site_finallys ++;
+			}
+		} catch (ArgumentException e) {
+			return e.StackTrace.IndexOf ("throw_site_catch") != -1 ? 1 : 100;
+		} catch (InvalidOperationException e) {
+			return e.StackTrace.IndexOf ("throw_site_catch") != -1 ? 2 : 100;
+		}
+	}
+
+	/* Repeated throws from the same place, with different exception types */
+	public static int test_0_throw_site_repeated () {
+		throw_site_finallys = 0;
+		for (int i = 0; i < 10; ++i) {
+			if (throw_site_catch (0) != 1)
+				return 1;
+			if (throw_site_catch (1) != 2)
+				return 2;
+		}
+		if (throw_site_finallys != 20)
+			return 3;
+		return 0;
+	}
 }
 
 #if !MOBILE
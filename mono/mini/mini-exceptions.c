@@ -51,6 +51,7 @@
 #include <mono/metadata/environment.h>
 #include <mono/utils/mono-mmap.h>
 #include <mono/utils/mono-logger-internal.h>
+#include <mono/utils/mono-counters.h>
 
 #include "mini.h"
 #include "trace.h"
@@ -75,6 +76,8 @@ static gpointer restore_stack_protection_tramp = NULL;
 static MonoUnhandledExceptionFunc unhandled_exception_hook = NULL;
 static gpointer unhandled_exception_hook_data = NULL;
 
+static guint32 throw_site_hits;
+
 static void try_more_restore (void);
 static void restore_stack_protection (void);
 static void mono_walk_stack_full (MonoJitStackWalk func, MonoContext *start_ctx, MonoDomain *domain, MonoJitTlsData *jit_tls, MonoLMF *lmf, MonoUnwindOptions unwind_options, gpointer user_data);
@@ -110,6 +113,7 @@ mono_exceptions_init (void)
 #ifdef MONO_ARCH_HAVE_EXCEPTIONS_INIT
 	mono_arch_exceptions_init ();
 #endif
+	mono_counters_register ("Exceptions handled from throw site cache", MONO_COUNTER_JIT | MONO_COUNTER_INT, &throw_site_hits);
 	cbs.mono_walk_stack_with_ctx = mono_runtime_walk_stack_with_ctx;
 	cbs.mono_walk_stack_with_state = mono_walk_stack_with_state;
 	cbs.mono_raise_exception = mono_get_throw_exception ();
@@ -1092,25 +1096,62 @@ callback_get_stack_frames_security_info (StackFrameInfo *frame, MonoContext *ctx
 	return FALSE;
 }
 
-static MonoArray *
-glist_to_array (GList *list, MonoClass *eclass) 
+/*
+ * The managed frames an exception went through, as ip and generic info pairs.
+ * Methods are only looked up when the stack trace is requested, see
+ * ves_icall_System_Exception_get_trace ().
+ */
+typedef struct {
+	gpointer *ips;
+	int len, size;
+	gpointer inline_ips [32];
+} TraceIps;
+
+static void
+trace_ips_init (TraceIps *trace)
 {
-	MonoDomain *domain = mono_domain_get ();
-	MonoArray *res;
-	int len, i;
+	trace->ips = trace->inline_ips;
+	trace->len = 0;
+	trace->size = G_N_ELEMENTS (trace->inline_ips);
+}
 
-	if (!list)
-		return NULL;
+static void
+trace_ips_add (TraceIps *trace, gpointer ip, gpointer generic_info)
+{
+	if (trace->len + 2 > trace->size) {
+		gpointer *ips = g_new (gpointer, trace->size * 2);
+
+		memcpy (ips, trace->ips, trace->len * sizeof (gpointer));
+		if (trace->ips != trace->inline_ips)
+			g_free (trace->ips);
+		trace->ips = ips;
+		trace->size *= 2;
+	}
+	trace->ips [trace->len ++] = ip;
+	trace->ips [trace->len ++] = generic_info;
+}
 
-	len = g_list_length (list);
-	res = mono_array_new (domain, eclass, len);
+static MonoArray*
+trace_ips_to_array (TraceIps *trace)
+{
+	MonoArray *res;
 
-	for (i = 0; list; list = list->next, i++)
-		mono_array_set (res, gpointer, i, list->data);
+	if (!trace->len)
+		return NULL;
 
+	res = mono_array_new (mono_domain_get (), mono_defaults.int_class, trace->len);
+	memcpy (mono_array_addr (res, gpointer, 0), trace->ips, trace->len * sizeof (gpointer));
 	return res;
 }
 
+static void
+trace_ips_free (TraceIps *trace)
+{
+	if (trace->ips != trace->inline_ips)
+		g_free (trace->ips);
+	trace_ips_init (trace);
+}
+
 /**
  * ves_icall_System_Security_SecurityFrame_GetSecurityStack:
  * @skip: the number of stack frames to skip
@@ -1316,25 +1357,54 @@ build_native_trace (void)
 
 #define setup_managed_stacktrace_information() do {	\
 	if (mono_ex && !initial_trace_ips) {	\
-		trace_ips = g_list_reverse (trace_ips);	\
-		MONO_OBJECT_SETREF (mono_ex, trace_ips, glist_to_array (trace_ips, mono_defaults.int_class));	\
+		MONO_OBJECT_SETREF (mono_ex, trace_ips, trace_ips_to_array (&trace_ips));	\
 		MONO_OBJECT_SETREF (mono_ex, native_trace_ips, build_native_trace ());	\
 		if (has_dynamic_methods)	\
 			/* These methods could go away anytime, so compute the stack trace now */	\
 			MONO_OBJECT_SETREF (mono_ex, stack_trace, ves_icall_System_Exception_get_trace (mono_ex));	\
 	}	\
-	g_list_free (trace_ips);	\
-	trace_ips = NULL;	\
+	trace_ips_free (&trace_ips);	\
 } while (0)
+/*
+ * add_throw_site_handler:
+ *
+ *   Remember that exceptions with vtable VTABLE thrown at IP are caught by clause
+ * CLAUSE_INDEX of JI, which is the method containing IP.
+ */
+static void
+add_throw_site_handler (MonoDomain *domain, gpointer ip, MonoVTable *vtable, MonoJitInfo *ji, int clause_index)
+{
+	MonoThrowSiteHandler *site = g_new0 (MonoThrowSiteHandler, 1);
+
+	site->ip = ip;
+	site->vtable = vtable;
+	site->ji = ji;
+	site->clause_index = clause_index;
+	if (mono_conc_hashtable_insert (domain_jit_info (domain)->throw_site_hash, site, site))
+		g_free (site);
+}
+
+static MonoThrowSiteHandler*
+find_throw_site_handler (MonoDomain *domain, gpointer ip, MonoVTable *vtable)
+{
+	MonoThrowSiteHandler key;
+
+	key.ip = ip;
+	key.vtable = vtable;
+	return mono_conc_hashtable_lookup (domain_jit_info (domain)->throw_site_hash, &key);
+}
+
 /*
  * mono_handle_exception_internal_first_pass:
  *
  *   The first pass of exception handling. Unwind the stack until a catch clause which can catch
  * OBJ is found. Run the index of the filter clause which caught the exception into
  * OUT_FILTER_IDX. Return TRUE if the exception is caught, FALSE otherwise.
+ * OUT_CACHED is set to TRUE if the catch clause is in the throwing frame and was found
+ * in the throw site cache, without unwinding the frame.
  */
 static gboolean
-mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint32 *out_filter_idx, MonoJitInfo **out_ji, MonoJitInfo **out_prev_ji, MonoObject *non_exception)
+mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint32 *out_filter_idx, MonoJitInfo **out_ji, MonoJitInfo **out_prev_ji, MonoObject *non_exception, gboolean *out_cached)
 {
 	MonoDomain *domain = mono_domain_get ();
 	MonoJitInfo *ji = NULL;
@@ -1342,9 +1412,11 @@ mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint3
 	MonoJitTlsData *jit_tls = mono_native_tls_get_value (mono_jit_tls_id);
 	MonoLMF *lmf = mono_get_lmf ();
 	MonoArray *initial_trace_ips = NULL;
-	GList *trace_ips = NULL;
+	TraceIps trace_ips;
 	MonoException *mono_ex;
 	gboolean stack_overflow = FALSE;
+	gboolean use_throw_site_cache;
+	MonoThrowSiteHandler *site;
 	MonoContext initial_ctx;
 	MonoMethod *method;
 	int frame_count = 0;
@@ -1380,14 +1452,42 @@ mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint3
 		*out_ji = NULL;
 	if (out_prev_ji)
 		*out_prev_ji = NULL;
+	*out_cached = FALSE;
 	filter_idx = 0;
 	initial_ctx = *ctx;
+	trace_ips_init (&trace_ips);
+
+	/*
+	 * Exceptions used for control flow are usually caught in the method throwing them,
+	 * so remember the catch clauses found in the throwing frame. Filters run user code,
+	 * so they are never cached, and the catch class has to be the same for every
+	 * exception of the same type.
+	 */
+	use_throw_site_cache = !stack_overflow && !non_exception;
+	if (use_throw_site_cache) {
+		site = find_throw_site_handler (domain, MONO_CONTEXT_GET_IP (ctx), ((MonoObject*)obj)->vtable);
+		if (site) {
+			ji = site->ji;
+			if (mono_ex && !initial_trace_ips)
+				trace_ips_add (&trace_ips, MONO_CONTEXT_GET_IP (ctx), get_generic_info_from_stack_frame (ji, ctx));
+			setup_managed_stacktrace_information ();
+
+			throw_site_hits ++;
+			if (out_ji)
+				*out_ji = ji;
+			*out_cached = TRUE;
+			/* mono_debugger_agent_handle_exception () needs this */
+			MONO_CONTEXT_SET_IP (ctx, ji->clauses [site->clause_index].handler_start);
+			return TRUE;
+		}
+	}
 
 	while (1) {
 		MonoContext new_ctx;
 		guint32 free_stack;
 		int clause_index_start = 0;
 		gboolean unwind_res = TRUE;
+		MonoLMF *prev_lmf = lmf;
 		
 		StackFrameInfo frame;
 
@@ -1398,6 +1498,7 @@ mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint3
 		if (unwind_res) {
 			if (frame.type == FRAME_TYPE_DEBUGGER_INVOKE || frame.type == FRAME_TYPE_MANAGED_TO_NATIVE) {
 				*ctx = new_ctx;
+				use_throw_site_cache = FALSE;
 				continue;
 			}
 			g_assert (frame.type == FRAME_TYPE_MANAGED);
@@ -1425,16 +1526,22 @@ mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint3
 			 * rethrown. Also avoid giant stack traces during a stack
 			 * overflow.
 			 */
-			if (!initial_trace_ips && (frame_count < 1000)) {
-				trace_ips = g_list_prepend (trace_ips, MONO_CONTEXT_GET_IP (ctx));
-				trace_ips = g_list_prepend (trace_ips,
-											get_generic_info_from_stack_frame (ji, ctx));
-			}
+			if (!initial_trace_ips && (frame_count < 1000))
+				trace_ips_add (&trace_ips, MONO_CONTEXT_GET_IP (ctx), get_generic_info_from_stack_frame (ji, ctx));
 		}
 
 		if (method->dynamic)
 			has_dynamic_methods = TRUE;
 
+		/*
+		 * Code and vtables live as long as the domain, except for dynamic methods. Methods
+		 * which save an LMF are wrappers, which are not cached either. LLVM compiled finally
+		 * clauses save the unwound context, see mono_handle_exception_internal ().
+		 */
+		if (use_throw_site_cache && (frame_count > 1 || method->wrapper_type != MONO_WRAPPER_NONE || method->dynamic ||
+			ji->has_generic_jit_info || ji->from_llvm || lmf != prev_lmf || (frame.domain != domain && frame.domain != mono_get_root_domain ())))
+			use_throw_site_cache = FALSE;
+
 		if (stack_overflow) {
 			if (DOES_STACK_GROWS_UP)
 				free_stack = (guint8*)(MONO_CONTEXT_GET_SP (ctx)) - (guint8*)(MONO_CONTEXT_GET_SP (&initial_ctx));
@@ -1514,6 +1621,9 @@ mono_handle_exception_internal_first_pass (MonoContext *ctx, gpointer obj, gint3
 				if (ei->flags == MONO_EXCEPTION_CLAUSE_NONE && mono_object_isinst (ex_obj, catch_class)) {
 					setup_managed_stacktrace_information ();
 
+					if (use_throw_site_cache && filter_idx == 0)
+						add_throw_site_handler (domain, MONO_CONTEXT_GET_IP (&initial_ctx), ((MonoObject*)obj)->vtable, ji, i);
+
 					if (out_ji)
 						*out_ji = ji;
 
@@ -1553,6 +1663,7 @@ mono_handle_exception_internal (MonoContext *ctx, gpointer obj, gboolean resume,
 	int i;
 	MonoObject *ex_obj;
 	MonoObject *non_exception = NULL;
+	gboolean cached = FALSE;
 
 	g_assert (ctx != NULL);
 	if (!obj) {
@@ -1659,7 +1770,7 @@ mono_handle_exception_internal (MonoContext *ctx, gpointer obj, gboolean resume,
 		mono_profiler_exception_thrown (obj);
 		jit_tls->orig_ex_ctx_set = FALSE;
 
-		res = mono_handle_exception_internal_first_pass (&ctx_cp, obj, &first_filter_idx, &ji, &prev_ji, non_exception);
+		res = mono_handle_exception_internal_first_pass (&ctx_cp, obj, &first_filter_idx, &ji, &prev_ji, non_exception, &cached);
 
 		if (!res) {
 			if (mini_get_debug_options ()->break_on_exc)
@@ -1717,6 +1828,11 @@ mono_handle_exception_internal (MonoContext *ctx, gpointer obj, gboolean resume,
 			lmf = jit_tls->resume_state.lmf;
 			first_filter_idx = jit_tls->resume_state.first_filter_idx;
 			filter_idx = jit_tls->resume_state.filter_idx;
+		} else if (cached) {
+			/*
+			 * The first pass found the catch clause in this frame using the throw site
+			 * cache, so there is no need to unwind it. JI is set by the first pass.
+			 */
 		} else {
 			StackFrameInfo frame;
 
@@ -1895,6 +2011,9 @@ mono_handle_exception_internal (MonoContext *ctx, gpointer obj, gboolean resume,
 			}
 		}
 
+		/* NEW_CTX is not set if the frame was found in the throw site cache */
+		g_assert (!cached);
+
 		jit_tls->orig_ex_ctx_set = TRUE;
 		mono_profiler_exception_method_leave (method);
 		jit_tls->orig_ex_ctx_set = FALSE;
@@ -2792,6 +2911,21 @@ mono_jinfo_get_unwind_info (MonoJitInfo *ji, guint32 *unwind_info_len)
 		return mono_get_cached_unwind_info (ji->unwind_info, unwind_info_len);
 }
 
+/*
+ * mono_jinfo_get_unwind_plan:
+ *
+ *   Return the precomputed unwind plan for JI, or NULL if it doesn't have one, in
+ * which case the unwind info returned by mono_jinfo_get_unwind_info () should be used.
+ */
+MonoUnwindPlan*
+mono_jinfo_get_unwind_plan (MonoJitInfo *ji)
+{
+	if (ji->from_aot)
+		return NULL;
+	else
+		return mono_get_cached_unwind_plan (ji->unwind_info);
+}
+
 int
 mono_jinfo_get_epilog_size (MonoJitInfo *ji)
 {
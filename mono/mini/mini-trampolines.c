@@ -27,6 +27,7 @@ static GHashTable *class_init_hash_addr;
 static GHashTable *rgctx_lazy_fetch_trampoline_hash;
 static GHashTable *rgctx_lazy_fetch_trampoline_hash_addr;
 static guint32 trampoline_calls, jit_trampolines, unbox_trampolines, static_rgctx_trampolines;
+static guint32 delegate_cached_inits;
 
 #define mono_trampolines_lock() mono_mutex_lock (&trampolines_mutex)
 #define mono_trampolines_unlock() mono_mutex_unlock (&trampolines_mutex)
@@ -173,7 +174,7 @@ mono_convert_imt_slot_to_vtable_slot (gpointer* slot, mgreg_t *regs, guint8 *cod
 		if (interface_offset < 0) {
 			g_error ("%s doesn't implement interface %s\n", mono_type_get_name_full (&vt->klass->byval_arg, 0), mono_type_get_name_full (&imt_method->klass->byval_arg, 0));
 		}
-		mono_vtable_build_imt_slot (vt, mono_method_get_imt_slot (imt_method));
+		mono_vtable_build_imt_slot (vt, mono_method_get_imt_slot (imt_method), imt_method);
 
 		if (imt_method->is_inflated && ((MonoMethodInflated*)imt_method)->context.method_inst) {
 			MonoError error;
@@ -1173,6 +1174,8 @@ mono_delegate_trampoline (mgreg_t *regs, guint8 *code, gpointer *arg, guint8* tr
 	delegate->invoke_impl = mono_get_addr_from_ftnptr (code);
 	if (enable_caching && !callvirt && tramp_info->method) {
 		tramp_info->method_ptr = delegate->method_ptr;
+		/* mini_init_delegate () reads these without a lock */
+		mono_memory_write_barrier ();
 		tramp_info->invoke_impl = delegate->invoke_impl;
 	}
 
@@ -1339,6 +1342,7 @@ mono_trampolines_init (void)
 	mono_counters_register ("JIT trampolines", MONO_COUNTER_JIT | MONO_COUNTER_INT, &jit_trampolines);
 	mono_counters_register ("Unbox trampolines", MONO_COUNTER_JIT | MONO_COUNTER_INT, &unbox_trampolines);
 	mono_counters_register ("Static rgctx trampolines", MONO_COUNTER_JIT | MONO_COUNTER_INT, &static_rgctx_trampolines);
+	mono_counters_register ("Delegates initialized from cache", MONO_COUNTER_JIT | MONO_COUNTER_INT, &delegate_cached_inits);
 }
 
 void
@@ -1587,6 +1591,49 @@ mono_create_delegate_trampoline (MonoDomain *domain, MonoClass *klass)
 #endif
 }
 
+/*
+ * mini_init_delegate:
+ *
+ *   Set DEL->invoke_impl for delegates created by the runtime, i.e. by
+ * mono_delegate_ctor_with_method (). Like the code emitted for delegate
+ * constructors by the JIT, this reuses the trampoline info of the
+ * KLASS+METHOD pair, so once one delegate of the pair has been invoked, new
+ * delegates call the target method directly instead of going through the
+ * delegate trampoline on their first invocation.
+ */
+void
+mini_init_delegate (MonoDelegate *del)
+{
+	MonoDomain *domain = del->object.vtable->domain;
+	MonoClass *klass = del->object.vtable->klass;
+	MonoMethod *method = del->method;
+
+#ifdef MONO_ARCH_HAVE_CREATE_DELEGATE_TRAMPOLINE
+	/*
+	 * The cached code depends on whether the delegate is closed, so only use it
+	 * when the trampoline would make the same choice for every delegate of the pair:
+	 * closed instance delegates and static delegates. Open instance delegates need
+	 * a virtual call, and remoting and wrappers get different code for each instance.
+	 */
+	if (method && !method_is_dynamic (method) && method->wrapper_type == MONO_WRAPPER_NONE &&
+		((del->target && !mono_object_is_transparent_proxy (del->target)) || (method->flags & METHOD_ATTRIBUTE_STATIC))) {
+		MonoDelegateTrampInfo *tramp_info = mono_create_delegate_trampoline_info (domain, klass, method);
+		gpointer invoke_impl = tramp_info->invoke_impl;
+
+		/* Pairs with the write barrier in mono_delegate_trampoline () */
+		mono_memory_read_barrier ();
+		if (tramp_info->method_ptr) {
+			del->method_ptr = tramp_info->method_ptr;
+			delegate_cached_inits ++;
+		}
+		del->invoke_impl = invoke_impl;
+		return;
+	}
+#endif
+
+	del->invoke_impl = mono_create_delegate_trampoline (domain, klass);
+}
+
 gpointer
 mono_create_delegate_virtual_trampoline (MonoDomain *domain, MonoClass *klass, MonoMethod *method)
 {
@@ -149,6 +149,14 @@ mono_unwind_frame (guint8 *unwind_info, guint32 unwind_info_len,
 				   mgreg_t **save_locations, int save_locations_len,
 				   guint8 **out_cfa) MONO_INTERNAL;
 
+typedef struct _MonoUnwindPlan MonoUnwindPlan;
+
+void
+mono_unwind_frame_with_plan (MonoUnwindPlan *plan, guint8 *start_ip, guint8 *ip, guint8 **mark_locations,
+							 mgreg_t *regs, int nregs,
+							 mgreg_t **save_locations, int save_locations_len,
+							 guint8 **out_cfa) MONO_INTERNAL;
+
 void mono_unwind_init (void) MONO_INTERNAL;
 
 void mono_unwind_cleanup (void) MONO_INTERNAL;
@@ -157,6 +165,8 @@ guint32 mono_cache_unwind_info (guint8 *unwind_info, guint32 unwind_info_len) MO
 
 guint8* mono_get_cached_unwind_info (guint32 index, guint32 *unwind_info_len) MONO_INTERNAL;
 
+MonoUnwindPlan* mono_get_cached_unwind_plan (guint32 index) MONO_INTERNAL;
+
 guint8* mono_unwind_decode_fde (guint8 *fde, guint32 *out_len, guint32 *code_len, MonoJitExceptionInfo **ex_info, guint32 *ex_info_len, gpointer **type_info, int *this_reg, int *this_offset) MONO_LLVM_INTERNAL;
 
 /* Data retrieved from an LLVM Mono FDE entry */
@@ -6978,9 +6978,11 @@ mini_parse_debug_options (void)
 			debug_options.check_pinvoke_callconv = TRUE;
 		else if (!strcmp (arg, "debug-domain-unload"))
 			mono_enable_debug_domain_unload (TRUE);
+		else if (!strcmp (arg, "imt"))
+			debug_options.imt = TRUE;
 		else {
 			fprintf (stderr, "Invalid option for the MONO_DEBUG env variable: %s\n", arg);
-			fprintf (stderr, "Available options: 'handle-sigint', 'keep-delegates', 'reverse-pinvoke-exceptions', 'collect-pagefault-stats', 'break-on-unverified', 'no-gdb-backtrace', 'dont-free-domains', 'suspend-on-sigsegv', 'suspend-on-exception', 'suspend-on-unhandled', 'dyn-runtime-invoke', 'gdb', 'explicit-null-checks', 'init-stacks', 'check-pinvoke-callconv', 'debug-domain-unload'\n");
+			fprintf (stderr, "Available options: 'handle-sigint', 'keep-delegates', 'reverse-pinvoke-exceptions', 'collect-pagefault-stats', 'break-on-unverified', 'no-gdb-backtrace', 'dont-free-domains', 'suspend-on-sigsegv', 'suspend-on-exception', 'suspend-on-unhandled', 'dyn-runtime-invoke', 'gdb', 'explicit-null-checks', 'init-stacks', 'check-pinvoke-callconv', 'debug-domain-unload', 'imt'\n");
 			exit (1);
 		}
 	}
@@ -7078,6 +7080,23 @@ class_method_pair_hash (gconstpointer data)
 	return (gsize)pair->klass ^ (gsize)pair->method;
 }
 
+static guint
+throw_site_hash (gconstpointer data)
+{
+	const MonoThrowSiteHandler *site = data;
+
+	return (guint)(gsize)site->ip ^ mono_aligned_addr_hash (site->vtable);
+}
+
+static gboolean
+throw_site_equal (gconstpointer ka, gconstpointer kb)
+{
+	const MonoThrowSiteHandler *site1 = ka;
+	const MonoThrowSiteHandler *site2 = kb;
+
+	return site1->ip == site2->ip && site1->vtable == site2->vtable;
+}
+
 static void
 mini_create_jit_domain_info (MonoDomain *domain)
 {
@@ -7089,6 +7108,7 @@ mini_create_jit_domain_info (MonoDomain *domain)
 	info->delegate_trampoline_hash = g_hash_table_new (class_method_pair_hash, class_method_pair_equal);
 	info->llvm_vcall_trampoline_hash = g_hash_table_new (mono_aligned_addr_hash, NULL);
 	info->runtime_invoke_hash = mono_conc_hashtable_new_full (&domain->lock, mono_aligned_addr_hash, NULL, NULL, runtime_invoke_info_free);
+	info->throw_site_hash = mono_conc_hashtable_new_full (&domain->lock, throw_site_hash, throw_site_equal, g_free, NULL);
 	info->seq_points = g_hash_table_new_full (mono_aligned_addr_hash, NULL, NULL, seq_point_info_free);
 	info->arch_seq_points = g_hash_table_new (mono_aligned_addr_hash, NULL);
 	info->jump_target_hash = g_hash_table_new (NULL, NULL);
@@ -7155,6 +7175,7 @@ mini_free_jit_domain_info (MonoDomain *domain)
 		g_hash_table_destroy (info->static_rgctx_trampoline_hash);
 	g_hash_table_destroy (info->llvm_vcall_trampoline_hash);
 	mono_conc_hashtable_destroy (info->runtime_invoke_hash);
+	mono_conc_hashtable_destroy (info->throw_site_hash);
 	g_hash_table_destroy (info->seq_points);
 	g_hash_table_destroy (info->arch_seq_points);
 	if (info->agent_info)
@@ -7256,6 +7277,7 @@ mini_init (const char *filename, const char *runtime_version)
 	callbacks.debug_log = mono_debugger_agent_debug_log;
 	callbacks.debug_log_is_enabled = mono_debugger_agent_debug_log_is_enabled;
 	callbacks.tls_key_supported = mini_tls_key_supported;
+	callbacks.init_delegate = mini_init_delegate;
 
 	if (mono_use_imt) {
 		callbacks.get_vtable_trampoline = mini_get_vtable_trampoline;
@@ -7372,6 +7394,7 @@ mini_init (const char *filename, const char *runtime_version)
 			mono_install_imt_thunk_builder (mono_aot_get_imt_thunk);
 		else
 			mono_install_imt_thunk_builder (mono_arch_build_imt_thunk);
+		mono_set_imt_debug (debug_options.imt);
 	}
 
 	/*Init arch tls information only after the metadata side is inited to make sure we see dynamic appdomain tls keys*/
@@ -7702,6 +7725,8 @@ print_jit_stats (void)
 		g_print ("IMT max collisions:     %ld\n", mono_stats.imt_max_collisions_in_slot);
 		g_print ("IMT methods at max col: %ld\n", mono_stats.imt_method_count_when_max_collisions);
 		g_print ("IMT thunks size:        %ld\n", mono_stats.imt_thunks_size);
+		g_print ("IMT profiled thunks:    %ld\n", mono_stats.imt_thunks_profiled);
+		g_print ("IMT thunks w/ hot ents: %ld\n", mono_stats.imt_thunks_with_hot_entries);
 
 		g_print ("JIT info table inserts: %ld\n", mono_stats.jit_info_table_insert_count);
 		g_print ("JIT info table removes: %ld\n", mono_stats.jit_info_table_remove_count);
@@ -280,6 +280,18 @@ typedef struct
 	gboolean virtual;
 } MonoDelegateClassMethodPair;
 
+/*
+ * A catch clause which handled an exception thrown in the same frame, keyed on the
+ * throw ip and the exception vtable.
+ */
+typedef struct
+{
+	gpointer ip;
+	MonoVTable *vtable;
+	MonoJitInfo *ji;
+	int clause_index;
+} MonoThrowSiteHandler;
+
 /* Per-domain information maintained by the JIT */
 typedef struct
 {
@@ -299,6 +311,8 @@ typedef struct
 	GHashTable *method_code_hash;
 	/* Maps methods to a RuntimeInvokeInfo structure */
 	MonoConcurrentHashTable *runtime_invoke_hash;
+	/* Maps MonoThrowSiteHandler -> MonoThrowSiteHandler */
+	MonoConcurrentHashTable *throw_site_hash;
 	/* Maps MonoMethod to a GPtrArray containing sequence point locations */
 	GHashTable *seq_points;
 	/* Debugger agent data */
@@ -1897,6 +1911,10 @@ typedef struct {
 	 * Check for pinvoke calling convention mismatches.
 	 */
 	gboolean check_pinvoke_callconv;
+	/*
+	 * Print the methods sharing an IMT slot when building IMT thunks.
+	 */
+	gboolean imt;
 } MonoDebugOptions;
 
 enum {
@@ -2307,6 +2325,7 @@ gpointer          mono_create_jit_trampoline_from_token (MonoImage *image, guint
 gpointer          mono_create_jit_trampoline_in_domain (MonoDomain *domain, MonoMethod *method) MONO_LLVM_INTERNAL;
 gpointer          mono_create_delegate_trampoline (MonoDomain *domain, MonoClass *klass) MONO_INTERNAL;
 MonoDelegateTrampInfo* mono_create_delegate_trampoline_info (MonoDomain *domain, MonoClass *klass, MonoMethod *method) MONO_INTERNAL;
+void              mini_init_delegate (MonoDelegate *del) MONO_INTERNAL;
 gpointer          mono_create_delegate_virtual_trampoline (MonoDomain *domain, MonoClass *klass, MonoMethod *method) MONO_INTERNAL;
 gpointer          mono_create_rgctx_lazy_fetch_trampoline (guint32 offset) MONO_INTERNAL;
 gpointer          mono_create_monitor_enter_trampoline (void) MONO_INTERNAL;
@@ -2590,6 +2609,7 @@ typedef gboolean (*MonoExceptionFrameWalk)      (MonoMethod *method, gpointer ip
 gboolean mono_exception_walk_trace              (MonoException *ex, MonoExceptionFrameWalk func, gpointer user_data);
 void mono_restore_context                       (MonoContext *ctx) MONO_INTERNAL;
 guint8* mono_jinfo_get_unwind_info              (MonoJitInfo *ji, guint32 *unwind_info_len) MONO_INTERNAL;
+MonoUnwindPlan* mono_jinfo_get_unwind_plan       (MonoJitInfo *ji) MONO_INTERNAL;
 int  mono_jinfo_get_epilog_size                 (MonoJitInfo *ji) MONO_INTERNAL;
 
 gboolean
@@ -26,7 +26,38 @@ typedef struct {
 	int offset;
 } Loc;
 
+/*
+ * A precomputed form of the unwind info, made of one row per range of code where the
+ * CFA rule and the saved registers don't change. Unwinding a frame with a plan only
+ * needs to find the row covering the ip, instead of decoding the unwind ops up to it.
+ */
 typedef struct {
+	/* Start of the range, relative to the method start or to mark location 0 */
+	guint32 pos;
+	gint32 cfa_offset;
+	/* Hardware register, -1 if the CFA is not defined */
+	gint16 cfa_reg;
+	guint16 from_mark;
+	guint16 nslots;
+	/* Index of the first saved register of this row in MonoUnwindPlan->slots */
+	guint32 first_slot;
+} UnwindPlanRow;
+
+typedef struct {
+	/* Hardware register */
+	guint16 reg;
+	/* Offset from the CFA of the stack slot the register is saved in */
+	gint32 offset;
+} UnwindPlanSlot;
+
+struct _MonoUnwindPlan {
+	int nrows;
+	UnwindPlanRow *rows;
+	UnwindPlanSlot *slots;
+};
+
+typedef struct {
+	MonoUnwindPlan *plan;
 	guint32 len;
 	guint8 info [MONO_ZERO_LEN_ARRAY];
 } MonoUnwindInfo;
@@ -39,7 +70,8 @@ static MonoUnwindInfo **cached_info;
 static int cached_info_next, cached_info_size;
 static GSList *cached_info_list;
 /* Statistics */
-static int unwind_info_size;
+static int unwind_info_size, unwind_plan_size;
+static guint32 unwind_plan_frames, unwind_interp_frames;
 
 #define unwind_lock() mono_mutex_lock (&unwind_mutex)
 #define unwind_unlock() mono_mutex_unlock (&unwind_mutex)
@@ -497,6 +529,8 @@ mono_unwind_frame (guint8 *unwind_info, guint32 unwind_info_len,
 	UnwindState state_stack [1];
 	int state_stack_pos;
 
+	unwind_interp_frames ++;
+
 	memset (reg_saved, 0, sizeof (reg_saved));
 	state_stack [0].cfa_reg = -1;
 	state_stack [0].cfa_offset = 0;
@@ -616,12 +650,256 @@ mono_unwind_frame (guint8 *unwind_info, guint32 unwind_info_len,
 	*out_cfa = cfa_val;
 }
 
+static void
+add_plan_row (GArray *rows, GArray *slots, int pos, gboolean from_mark, int cfa_reg, int cfa_offset, Loc *locations, guint8 *reg_saved)
+{
+	UnwindPlanRow row;
+	int i;
+
+	row.pos = pos;
+	row.from_mark = from_mark;
+	row.cfa_reg = cfa_reg == -1 ? -1 : mono_dwarf_reg_to_hw_reg (cfa_reg);
+	row.cfa_offset = cfa_offset;
+	row.first_slot = slots->len;
+	row.nslots = 0;
+	for (i = 0; i < NUM_REGS; ++i) {
+		if (reg_saved [i] && locations [i].loc_type == LOC_OFFSET) {
+			UnwindPlanSlot slot;
+
+			memset (&slot, 0, sizeof (slot));
+			slot.reg = mono_dwarf_reg_to_hw_reg (i);
+			slot.offset = locations [i].offset;
+			g_array_append_val (slots, slot);
+			row.nslots ++;
+		}
+	}
+
+	/* Rows with the same state as the previous one are only needed for their position */
+	if (rows->len) {
+		UnwindPlanRow *prev = &g_array_index (rows, UnwindPlanRow, rows->len - 1);
+
+		if (prev->cfa_reg == row.cfa_reg && prev->cfa_offset == row.cfa_offset && prev->nslots == row.nslots &&
+			!memcmp (&g_array_index (slots, UnwindPlanSlot, prev->first_slot), &g_array_index (slots, UnwindPlanSlot, row.first_slot), row.nslots * sizeof (UnwindPlanSlot)) &&
+			prev->from_mark == row.from_mark) {
+			g_array_set_size (slots, row.first_slot);
+			return;
+		}
+	}
+	g_array_append_val (rows, row);
+}
+
+/*
+ * build_unwind_plan:
+ *
+ *   Decode UNWIND_INFO the same way mono_unwind_frame () does, and return a plan with
+ * one row for each position the unwind state changes at. Return NULL if UNWIND_INFO
+ * can't be represented by a plan.
+ */
+static MonoUnwindPlan*
+build_unwind_plan (guint8 *unwind_info, guint32 unwind_info_len)
+{
+	Loc locations [NUM_REGS];
+	guint8 reg_saved [NUM_REGS];
+	UnwindState state;
+	gboolean state_saved = FALSE, from_mark = FALSE;
+	int pos, reg, cfa_reg, cfa_offset, offset, size;
+	GArray *rows, *slots;
+	MonoUnwindPlan *plan;
+	guint8 *p;
+
+	memset (reg_saved, 0, sizeof (reg_saved));
+	rows = g_array_new (FALSE, FALSE, sizeof (UnwindPlanRow));
+	slots = g_array_new (FALSE, FALSE, sizeof (UnwindPlanSlot));
+
+	p = unwind_info;
+	pos = 0;
+	cfa_reg = -1;
+	cfa_offset = -1;
+	while (p < unwind_info + unwind_info_len) {
+		int op = *p & 0xc0;
+		int advance = -1;
+
+		switch (op) {
+		case DW_CFA_advance_loc:
+			advance = *p & 0x3f;
+			p ++;
+			break;
+		case DW_CFA_offset:
+			reg = *p & 0x3f;
+			p ++;
+			if (reg >= NUM_REGS)
+				goto fail;
+			reg_saved [reg] = TRUE;
+			locations [reg].loc_type = LOC_OFFSET;
+			locations [reg].offset = decode_uleb128 (p, &p) * DWARF_DATA_ALIGN;
+			break;
+		case 0: {
+			int ext_op = *p;
+			p ++;
+			switch (ext_op) {
+			case DW_CFA_def_cfa:
+				cfa_reg = decode_uleb128 (p, &p);
+				cfa_offset = decode_uleb128 (p, &p);
+				break;
+			case DW_CFA_def_cfa_offset:
+				cfa_offset = decode_uleb128 (p, &p);
+				break;
+			case DW_CFA_def_cfa_register:
+				cfa_reg = decode_uleb128 (p, &p);
+				break;
+			case DW_CFA_offset_extended_sf:
+			case DW_CFA_offset_extended:
+				reg = decode_uleb128 (p, &p);
+				if (ext_op == DW_CFA_offset_extended_sf)
+					offset = decode_sleb128 (p, &p);
+				else
+					offset = decode_uleb128 (p, &p);
+				if (reg >= NUM_REGS)
+					goto fail;
+				reg_saved [reg] = TRUE;
+				locations [reg].loc_type = LOC_OFFSET;
+				locations [reg].offset = offset * DWARF_DATA_ALIGN;
+				break;
+			case DW_CFA_same_value:
+				reg = decode_uleb128 (p, &p);
+				if (reg >= NUM_REGS)
+					goto fail;
+				locations [reg].loc_type = LOC_SAME;
+				break;
+			case DW_CFA_advance_loc1:
+				advance = *p;
+				p += 1;
+				break;
+			case DW_CFA_advance_loc2:
+				advance = read16 (p);
+				p += 2;
+				break;
+			case DW_CFA_advance_loc4:
+				advance = read32 (p);
+				p += 4;
+				break;
+			case DW_CFA_remember_state:
+				if (state_saved)
+					goto fail;
+				memcpy (&state.locations, &locations, sizeof (locations));
+				memcpy (&state.reg_saved, &reg_saved, sizeof (reg_saved));
+				state.cfa_reg = cfa_reg;
+				state.cfa_offset = cfa_offset;
+				state_saved = TRUE;
+				break;
+			case DW_CFA_restore_state:
+				if (!state_saved)
+					goto fail;
+				state_saved = FALSE;
+				memcpy (&locations, &state.locations, sizeof (locations));
+				memcpy (&reg_saved, &state.reg_saved, sizeof (reg_saved));
+				cfa_reg = state.cfa_reg;
+				cfa_offset = state.cfa_offset;
+				break;
+			case DW_CFA_mono_advance_loc:
+				/* Positions after this are relative to mark location 0 */
+				add_plan_row (rows, slots, pos, from_mark, cfa_reg, cfa_offset, locations, reg_saved);
+				pos = 0;
+				from_mark = TRUE;
+				break;
+			default:
+				goto fail;
+			}
+			break;
+		}
+		default:
+			goto fail;
+		}
+
+		if (advance != -1) {
+			add_plan_row (rows, slots, pos, from_mark, cfa_reg, cfa_offset, locations, reg_saved);
+			pos += advance;
+		}
+	}
+	add_plan_row (rows, slots, pos, from_mark, cfa_reg, cfa_offset, locations, reg_saved);
+
+	size = sizeof (MonoUnwindPlan) + rows->len * sizeof (UnwindPlanRow) + slots->len * sizeof (UnwindPlanSlot);
+	plan = g_malloc (size);
+	plan->nrows = rows->len;
+	plan->rows = (UnwindPlanRow*)(plan + 1);
+	plan->slots = (UnwindPlanSlot*)(plan->rows + rows->len);
+	memcpy (plan->rows, rows->data, rows->len * sizeof (UnwindPlanRow));
+	memcpy (plan->slots, slots->data, slots->len * sizeof (UnwindPlanSlot));
+	unwind_plan_size += size;
+
+	g_array_free (rows, TRUE);
+	g_array_free (slots, TRUE);
+	return plan;
+
+ fail:
+	g_array_free (rows, TRUE);
+	g_array_free (slots, TRUE);
+	return NULL;
+}
+
+/*
+ * mono_unwind_frame_with_plan:
+ *
+ *   Same as mono_unwind_frame (), but using PLAN, which is obtained from
+ * mono_get_cached_unwind_plan ().
+ * This function is signal safe.
+ */
+void
+mono_unwind_frame_with_plan (MonoUnwindPlan *plan, guint8 *start_ip, guint8 *ip, guint8 **mark_locations,
+							 mgreg_t *regs, int nregs,
+							 mgreg_t **save_locations, int save_locations_len,
+							 guint8 **out_cfa)
+{
+	UnwindPlanRow *row = NULL;
+	guint32 ip_offset = ip - start_ip;
+	guint8 *cfa_val;
+	int i;
+
+	unwind_plan_frames ++;
+
+	/*
+	 * Rows are in the order of the unwind ops, and mono_unwind_frame () stops
+	 * decoding at the first position after IP.
+	 */
+	for (i = 0; i < plan->nrows; ++i) {
+		UnwindPlanRow *r = &plan->rows [i];
+		guint32 pos = r->pos;
+
+		if (r->from_mark) {
+			g_assert (mark_locations [0]);
+			pos += mark_locations [0] - start_ip;
+		}
+		if (pos > ip_offset)
+			break;
+		row = r;
+	}
+
+	if (save_locations)
+		memset (save_locations, 0, save_locations_len * sizeof (mgreg_t*));
+
+	g_assert (row && row->cfa_reg != -1);
+	cfa_val = (guint8*)regs [row->cfa_reg] + row->cfa_offset;
+	for (i = 0; i < row->nslots; ++i) {
+		UnwindPlanSlot *slot = &plan->slots [row->first_slot + i];
+
+		g_assert (slot->reg < nregs);
+		regs [slot->reg] = *(mgreg_t*)(cfa_val + slot->offset);
+		if (save_locations && slot->reg < save_locations_len)
+			save_locations [slot->reg] = (mgreg_t*)(cfa_val + slot->offset);
+	}
+
+	*out_cfa = cfa_val;
+}
+
 void
 mono_unwind_init (void)
 {
 	mono_mutex_init_recursive (&unwind_mutex);
 
 	mono_counters_register ("Unwind info size", MONO_COUNTER_JIT | MONO_COUNTER_INT, &unwind_info_size);
+	mono_counters_register ("Unwind plan size", MONO_COUNTER_JIT | MONO_COUNTER_INT, &unwind_plan_size);
+	mono_counters_register ("Frames unwound using a plan", MONO_COUNTER_JIT | MONO_COUNTER_INT, &unwind_plan_frames);
+	mono_counters_register ("Frames unwound by decoding unwind info", MONO_COUNTER_JIT | MONO_COUNTER_INT, &unwind_interp_frames);
 }
 
 void
@@ -637,6 +915,7 @@ mono_unwind_cleanup (void)
 	for (i = 0; i < cached_info_next; ++i) {
 		MonoUnwindInfo *cached = cached_info [i];
 
+		g_free (cached->plan);
 		g_free (cached);
 	}
 
@@ -678,6 +957,7 @@ mono_cache_unwind_info (guint8 *unwind_info, guint32 unwind_info_len)
 	info = g_malloc (sizeof (MonoUnwindInfo) + unwind_info_len);
 	info->len = unwind_info_len;
 	memcpy (&info->info, unwind_info, unwind_info_len);
+	info->plan = build_unwind_plan (info->info, unwind_info_len);
 
 	i = cached_info_next;
 	
@@ -735,6 +1015,19 @@ mono_get_cached_unwind_info (guint32 index, guint32 *unwind_info_len)
 	return data;
 }
 
+/*
+ * mono_get_cached_unwind_plan:
+ *
+ *   Return the plan for the unwind info with index INDEX in the unwind info cache,
+ * or NULL if it doesn't have one.
+ * This function is signal safe.
+ */
+MonoUnwindPlan*
+mono_get_cached_unwind_plan (guint32 index)
+{
+	return cached_info [index]->plan;
+}
+
 /*
  * mono_unwind_get_dwarf_data_align:
  *
@@ -12,6 +12,7 @@
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
+#include <math.h>
 #if !defined(__APPLE__) && !defined(__FreeBSD__)
 #include <malloc.h>
 #endif
@@ -528,6 +529,8 @@ add_image (intptr_t image, char *name)
 typedef struct _BackTrace BackTrace;
 typedef struct {
 	uint64_t count;
+	/* number of events added to count */
+	uint64_t events;
 	BackTrace *bt;
 } CallContext;
 
@@ -544,11 +547,15 @@ struct _ClassDesc {
 	char *name;
 	intptr_t allocs;
 	uint64_t alloc_size;
+	/* fraction of an object left over from the estimates of sampled allocations */
+	double alloc_weight;
 	TraceDesc traces;
 };
 
 static ClassDesc* class_hash [HASH_SIZE] = {0};
 static int num_classes = 0;
+static uint64_t alloc_samples = 0;
+static uint64_t alloc_sample_bytes = 0;
 
 static ClassDesc*
 add_class (intptr_t klass, const char *name)
@@ -1545,7 +1552,7 @@ ensure_thread_stack (ThreadContext *thread)
 }
 
 static int
-add_trace_hashed (CallContext *traces, int size, BackTrace *bt, uint64_t value)
+add_trace_hashed (CallContext *traces, int size, BackTrace *bt, uint64_t value, uint64_t events)
 {
 	int i;
 	unsigned int start_pos;
@@ -1554,10 +1561,12 @@ add_trace_hashed (CallContext *traces, int size, BackTrace *bt, uint64_t value)
 	do {
 		if (traces [i].bt == bt) {
 			traces [i].count += value;
+			traces [i].events += events;
 			return 0;
 		} else if (!traces [i].bt) {
 			traces [i].bt = bt;
 			traces [i].count += value;
+			traces [i].events += events;
 			return 1;
 		}
 		/* wrap around */
@@ -1584,13 +1593,13 @@ add_trace_bt (BackTrace *bt, TraceDesc *trace, uint64_t value)
 		n = calloc (sizeof (CallContext) * trace->size, 1);
 		for (i = 0; i < old_size; ++i) {
 			if (trace->traces [i].bt)
-				add_trace_hashed (n, trace->size, trace->traces [i].bt, trace->traces [i].count);
+				add_trace_hashed (n, trace->size, trace->traces [i].bt, trace->traces [i].count, trace->traces [i].events);
 		}
 		if (trace->traces)
 			free (trace->traces);
 		trace->traces = n;
 	}
-	trace->count += add_trace_hashed (trace->traces, trace->size, bt, value);
+	trace->count += add_trace_hashed (trace->traces, trace->size, bt, value, 1);
 }
 
 static BackTrace*
@@ -1657,6 +1666,7 @@ sort_context_array (TraceDesc* traces)
 		if (traces->traces [i].bt) {
 			traces->traces [j].bt = traces->traces [i].bt;
 			traces->traces [j].count = traces->traces [i].count;
+			traces->traces [j].events = traces->traces [i].events;
 			j++;
 		}
 	}
@@ -2105,15 +2115,18 @@ decode_buffer (ProfContext *ctx)
 		}
 		case TYPE_ALLOC: {
 			int has_bt = *p & TYPE_ALLOC_BT;
+			int sampled = *p & TYPE_ALLOC_SAMPLED;
 			uint64_t tdiff = decode_uleb128 (p + 1, &p);
 			intptr_t ptrdiff = decode_sleb128 (p, &p);
 			intptr_t objdiff = decode_sleb128 (p, &p);
-			uint64_t len;
+			uint64_t len, sample_bytes = 0;
 			int num_bt = 0;
 			MethodDesc* sframes [8];
 			MethodDesc** frames = sframes;
 			ClassDesc *cd = lookup_class (ptr_base + ptrdiff);
 			len = decode_uleb128 (p, &p);
+			if (sampled)
+				sample_bytes = decode_uleb128 (p, &p);
 			LOG_TIME (time_base, tdiff);
 			time_base += tdiff;
 			if (debug)
@@ -2128,12 +2141,29 @@ decode_buffer (ProfContext *ctx)
 			}
 			if ((thread_filter && thread_filter == thread->thread_id) || (time_base >= time_from && time_base < time_to)) {
 				BackTrace *bt;
-				cd->allocs++;
-				cd->alloc_size += len;
+				uint64_t size = len;
+				if (sampled) {
+					/*
+					 * An allocation of LEN bytes is sampled with probability
+					 * 1 - exp (-LEN / sample_bytes), so it stands for 1 / p objects.
+					 */
+					double scale = 1.0 / (1.0 - exp (-(double)len / sample_bytes));
+					intptr_t count;
+					cd->alloc_weight += scale;
+					count = (intptr_t)cd->alloc_weight;
+					cd->alloc_weight -= count;
+					cd->allocs += count;
+					size = (uint64_t)(len * scale + 0.5);
+					alloc_samples++;
+					alloc_sample_bytes = sample_bytes;
+				} else {
+					cd->allocs++;
+				}
+				cd->alloc_size += size;
 				if (has_bt)
-					bt = add_trace_methods (frames, num_bt, &cd->traces, len);
+					bt = add_trace_methods (frames, num_bt, &cd->traces, size);
 				else
-					bt = add_trace_thread (thread, &cd->traces, len);
+					bt = add_trace_thread (thread, &cd->traces, size);
 				if (find_size && len >= find_size) {
 					if (!find_name || strstr (cd->name, find_name))
 						found_object (OBJ_ADDR (objdiff));
@@ -2644,8 +2674,12 @@ dump_header (ProfContext *ctx)
 		fprintf (outfile, "\tServer listening on: %d\n", ctx->port);
 }
 
+/*
+ * Print the traces with their values, and with SAMPLED, the number of
+ * samples the estimated values come from.
+ */
 static void
-dump_traces (TraceDesc *traces, const char *desc)
+dump_traces_sampled (TraceDesc *traces, const char *desc, int sampled)
 {
 	int j;
 	if (!show_traces)
@@ -2659,12 +2693,22 @@ dump_traces (TraceDesc *traces, const char *desc)
 		bt = traces->traces [j].bt;
 		if (!bt->count)
 			continue;
-		fprintf (outfile, "\t%llu %s from:\n", (unsigned long long) traces->traces [j].count, desc);
+		if (sampled)
+			fprintf (outfile, "\t%llu %s (%llu samples) from:\n", (unsigned long long) traces->traces [j].count, desc,
+				(unsigned long long) traces->traces [j].events);
+		else
+			fprintf (outfile, "\t%llu %s from:\n", (unsigned long long) traces->traces [j].count, desc);
 		for (k = 0; k < bt->count; ++k)
 			fprintf (outfile, "\t\t%s\n", bt->methods [k]->name);
 	}
 }
 
+static void
+dump_traces (TraceDesc *traces, const char *desc)
+{
+	dump_traces_sampled (traces, desc, 0);
+}
+
 static void
 dump_threads (ProfContext *ctx)
 {
@@ -2808,6 +2852,9 @@ dump_allocations (void)
 		size += cd->alloc_size;
 		if (!header_done++) {
 			fprintf (outfile, "\nAllocation summary\n");
+			if (alloc_samples)
+				fprintf (outfile, "Estimated from %llu allocations sampled every %llu bytes on average\n",
+					(unsigned long long) alloc_samples, (unsigned long long) alloc_sample_bytes);
 			fprintf (outfile, "%10s %10s %8s Type name\n", "Bytes", "Count", "Average");
 		}
 		fprintf (outfile, "%10llu %10zd %8llu %s\n",
@@ -2815,7 +2862,7 @@ dump_allocations (void)
 			cd->allocs,
 			(unsigned long long) (cd->alloc_size / cd->allocs),
 			cd->name);
-		dump_traces (&cd->traces, "bytes");
+		dump_traces_sampled (&cd->traces, "bytes", alloc_samples != 0);
 	}
 	if (allocs)
 		fprintf (outfile, "Total memory allocated: %llu bytes in %zd objects\n", (unsigned long long) size, allocs);
@@ -22,6 +22,7 @@
 #include <string.h>
 #include <assert.h>
 #include <glib.h>
+#include <math.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
@@ -30,6 +31,10 @@
 #if defined(HOST_WIN32) || defined(DISABLE_SOCKETS)
 #define DISABLE_HELPER_THREAD 1
 #endif
+#ifndef HOST_WIN32
+#define USE_WRITER_THREAD 1
+#include <mono/utils/mono-semaphore.h>
+#endif
 
 #ifndef _GNU_SOURCE
 #define _GNU_SOURCE
@@ -92,6 +97,12 @@ static int do_mono_sample = 0;
 static int in_shutdown = 0;
 static int do_debug = 0;
 static int do_counters = 0;
+static int alloc_sample_bytes = 0;
+static int use_writer_thread = 1;
+static int max_queued_bytes = 16 * 1024 * 1024;
+static int drop_when_full = 0;
+static gint32 dropped_buffers = 0;
+static gint32 writer_stalls = 0;
 static MonoProfileSamplingMode sampling_mode = MONO_PROFILER_STAT_MODE_PROCESS;
 
 /* For linux compile with:
@@ -180,11 +191,14 @@ typedef struct _LogBuffer LogBuffer;
  *
  * type alloc format:
  * type: TYPE_ALLOC
- * exinfo: flags: TYPE_ALLOC_BT
+ * exinfo: flags: TYPE_ALLOC_BT, TYPE_ALLOC_SAMPLED
  * [time diff: uleb128] nanoseconds since last timing
  * [ptr: sleb128] class as a byte difference from ptr_base
  * [obj: sleb128] object address as a byte difference from obj_base
  * [size: uleb128] size of the object in the heap
+ * If the TYPE_ALLOC_SAMPLED flag is set, this is one of the allocations sampled
+ * on average every sample_bytes bytes allocated by a thread:
+ * [sample_bytes: uleb128] average number of bytes between samples
  * If the TYPE_ALLOC_BT flag is set, a backtrace follows.
  *
  * type GC format:
@@ -341,6 +355,8 @@ typedef struct _LogBuffer LogBuffer;
  */
 struct _LogBuffer {
 	LogBuffer *next;
+	/* next chain in the writer thread queue */
+	LogBuffer *queue_next;
 	uint64_t time_base;
 	uint64_t last_time;
 	uintptr_t ptr_base;
@@ -353,6 +369,9 @@ struct _LogBuffer {
 	int locked;
 	int size;
 	int call_depth;
+	/* bytes the thread can allocate before the next sampled allocation */
+	int64_t alloc_countdown;
+	uint64_t alloc_rand;
 	unsigned char buf [1];
 };
 
@@ -396,6 +415,15 @@ struct _MonoProfiler {
 	int pipes [2];
 #ifndef HOST_WIN32
 	pthread_t helper_thread;
+#endif
+#ifdef USE_WRITER_THREAD
+	pthread_t writer_thread;
+	MonoSemType writer_sem;
+	/* protects clearing run_writer_thread against pushes and wakeups */
+	mono_mutex_t writer_queue_mutex;
+	volatile gint32 run_writer_thread;
+	LogBuffer *writer_queue;
+	volatile gint32 queued_bytes;
 #endif
 	BinaryObject *binary_objects;
 };
@@ -471,8 +499,11 @@ ensure_logbuf (int bytes)
 	TLS_SET (tlsbuffer, NULL);
 	init_thread ();
 	TLS_GET (tlsbuffer)->next = old;
-	if (old)
+	if (old) {
 		TLS_GET (tlsbuffer)->call_depth = old->call_depth;
+		TLS_GET (tlsbuffer)->alloc_countdown = old->alloc_countdown;
+		TLS_GET (tlsbuffer)->alloc_rand = old->alloc_rand;
+	}
 	//printf ("new logbuffer\n");
 	return TLS_GET (tlsbuffer);
 }
@@ -671,6 +702,177 @@ dump_buffer (MonoProfiler *profiler, LogBuffer *buf)
 	free_buffer (buf, buf->size);
 }
 
+#ifdef USE_WRITER_THREAD
+/*
+ * Filled buffers are written out by a separate thread, so the threads running
+ * managed code don't wait for compression and I/O. A thread hands its chain of
+ * buffers over by pushing it on prof->writer_queue, a lock-free LIFO list linked
+ * by queue_next. The writer thread takes the whole list at once and writes the
+ * chains in the order they were queued, so the buffers of each thread keep their
+ * order in the output.
+ * The data waiting in the queue is bounded by max_queued_bytes: when the writer
+ * falls behind, threads wait for it, or with the dropfull option, discard their
+ * buffers, which are counted in dropped_buffers.
+ * Threads check run_writer_thread, push and wake the writer while holding
+ * writer_queue_mutex, which stop_writer_thread () keeps until the writer has
+ * written out the queue and exited. So nothing is pushed or posted after that,
+ * and a thread that finds the flag cleared writes its chain directly only after
+ * all of its earlier chains.
+ */
+static int
+chain_size (LogBuffer *buf, int *count)
+{
+	int size = 0;
+	*count = 0;
+	for (; buf; buf = buf->next) {
+		size += buf->size;
+		(*count)++;
+	}
+	return size;
+}
+
+static void
+free_chain (LogBuffer *buf)
+{
+	LogBuffer *next;
+	for (; buf; buf = next) {
+		next = buf->next;
+		free_buffer (buf, buf->size);
+	}
+}
+
+/*
+ * Take the whole queue and write out its chains in the order they were queued.
+ */
+static void
+write_queue (MonoProfiler *prof)
+{
+	LogBuffer *list, *chain, *next;
+	int count, size;
+
+	list = InterlockedExchangePointer ((void * volatile*)&prof->writer_queue, NULL);
+	/* reverse the list to get the chains in queue order */
+	chain = NULL;
+	for (; list; list = next) {
+		next = list->queue_next;
+		list->queue_next = chain;
+		chain = list;
+	}
+	for (; chain; chain = next) {
+		next = chain->queue_next;
+		size = chain_size (chain, &count);
+		take_lock ();
+		dump_buffer (prof, chain);
+		release_lock ();
+		InterlockedAdd (&prof->queued_bytes, -size);
+	}
+}
+
+/*
+ * Queue BUF for the writer thread. Returns FALSE if the writer has been stopped,
+ * the caller then writes BUF itself.
+ */
+static gboolean
+enqueue_buffer (MonoProfiler *profiler, LogBuffer *buf)
+{
+	LogBuffer *head;
+	int count;
+	int size = chain_size (buf, &count);
+
+	if (profiler->queued_bytes && profiler->queued_bytes + size > max_queued_bytes) {
+		if (drop_when_full) {
+			InterlockedAdd (&dropped_buffers, count);
+			free_chain (buf);
+			return TRUE;
+		}
+		InterlockedIncrement (&writer_stalls);
+		while (profiler->run_writer_thread && profiler->queued_bytes && profiler->queued_bytes + size > max_queued_bytes)
+			usleep (1000);
+	}
+	mono_mutex_lock (&profiler->writer_queue_mutex);
+	if (!profiler->run_writer_thread) {
+		mono_mutex_unlock (&profiler->writer_queue_mutex);
+		return FALSE;
+	}
+	InterlockedAdd (&profiler->queued_bytes, size);
+	/* the writer takes the queue without the mutex */
+	do {
+		head = profiler->writer_queue;
+		buf->queue_next = head;
+	} while (InterlockedCompareExchangePointer ((void * volatile*)&profiler->writer_queue, buf, head) != head);
+	/* the writer takes the whole queue when it wakes up, so it needs a wakeup only when the queue was empty */
+	if (!head)
+		MONO_SEM_POST (&profiler->writer_sem);
+	mono_mutex_unlock (&profiler->writer_queue_mutex);
+	return TRUE;
+}
+
+static void*
+writer_thread (void *arg)
+{
+	MonoProfiler *prof = arg;
+
+	for (;;) {
+		MONO_SEM_WAIT (&prof->writer_sem);
+		write_queue (prof);
+		if (!prof->run_writer_thread && !prof->writer_queue)
+			break;
+	}
+	return NULL;
+}
+
+static void
+start_writer_thread (MonoProfiler* prof)
+{
+	MONO_SEM_INIT (&prof->writer_sem, 0);
+	mono_mutex_init (&prof->writer_queue_mutex);
+	prof->run_writer_thread = 1;
+	if (pthread_create (&prof->writer_thread, NULL, writer_thread, prof)) {
+		prof->run_writer_thread = 0;
+		MONO_SEM_DESTROY (&prof->writer_sem);
+		mono_mutex_destroy (&prof->writer_queue_mutex);
+	}
+}
+
+/*
+ * Write out the remaining queued buffers and wait for the writer thread to exit.
+ */
+static void
+stop_writer_thread (MonoProfiler* prof)
+{
+	void *res;
+	if (!prof->run_writer_thread)
+		return;
+	/* the writer doesn't take the mutex, so it can be held while it drains the queue */
+	mono_mutex_lock (&prof->writer_queue_mutex);
+	prof->run_writer_thread = 0;
+	MONO_SEM_POST (&prof->writer_sem);
+	pthread_join (prof->writer_thread, &res);
+	mono_mutex_unlock (&prof->writer_queue_mutex);
+	MONO_SEM_DESTROY (&prof->writer_sem);
+	mono_mutex_destroy (&prof->writer_queue_mutex);
+	if (dropped_buffers)
+		fprintf (stderr, "Profiler data was dropped because the writer thread fell behind: %d buffers (%d KB).\n",
+			dropped_buffers, dropped_buffers * (BUFFER_SIZE / 1024));
+}
+#endif
+
+/*
+ * Send the chain of buffers BUF to the output, either by queueing it for the
+ * writer thread or by writing it directly.
+ */
+static void
+send_buffer (MonoProfiler *profiler, LogBuffer *buf)
+{
+#ifdef USE_WRITER_THREAD
+	if (profiler->run_writer_thread && enqueue_buffer (profiler, buf))
+		return;
+#endif
+	take_lock ();
+	dump_buffer (profiler, buf);
+	release_lock ();
+}
+
 static void
 process_requests (MonoProfiler *profiler)
 {
@@ -685,6 +887,12 @@ static void
 runtime_initialized (MonoProfiler *profiler)
 {
 	runtime_inited = 1;
+#ifdef USE_WRITER_THREAD
+	if (profiler->run_writer_thread) {
+		mono_counters_register ("Profiler buffers dropped", MONO_COUNTER_RUNTIME | MONO_COUNTER_INT, &dropped_buffers);
+		mono_counters_register ("Profiler writer stalls", MONO_COUNTER_RUNTIME | MONO_COUNTER_INT, &writer_stalls);
+	}
+#endif
 #ifndef DISABLE_HELPER_THREAD
 	counters_init (profiler);
 	counters_sample (profiler, 0);
@@ -700,12 +908,14 @@ static void
 safe_dump (MonoProfiler *profiler, LogBuffer *logbuffer)
 {
 	int cd = logbuffer->call_depth;
-	take_lock ();
-	dump_buffer (profiler, TLS_GET (tlsbuffer));
-	release_lock ();
+	int64_t countdown = logbuffer->alloc_countdown;
+	uint64_t rand = logbuffer->alloc_rand;
+	send_buffer (profiler, TLS_GET (tlsbuffer));
 	TLS_SET (tlsbuffer, NULL);
 	init_thread ();
 	TLS_GET (tlsbuffer)->call_depth = cd;
+	TLS_GET (tlsbuffer)->alloc_countdown = countdown;
+	TLS_GET (tlsbuffer)->alloc_rand = rand;
 }
 
 static int
@@ -859,28 +1069,64 @@ emit_bt (LogBuffer *logbuffer, FrameData *data)
 	}
 }
 
+/*
+ * Return the number of bytes until the next sampled allocation: the distances
+ * between the sampled bytes are exponentially distributed with a mean of
+ * alloc_sample_bytes, so each allocation of SIZE bytes is sampled with
+ * probability 1 - exp (-SIZE / alloc_sample_bytes), regardless of the
+ * allocations that preceded it. mprof-report uses this to scale the samples.
+ */
+static int64_t
+next_alloc_sample (LogBuffer *logbuffer)
+{
+	uint64_t x = logbuffer->alloc_rand;
+	/* xorshift64* */
+	if (!x)
+		x = (thread_id () ^ current_time ()) | 1;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	logbuffer->alloc_rand = x;
+	x *= 2685821657736338717ULL;
+	/* uniform in (0, 1] */
+	return (int64_t)(-log (((x >> 11) + 1) * (1.0 / 9007199254740992.0)) * alloc_sample_bytes) + 1;
+}
+
 static void
 gc_alloc (MonoProfiler *prof, MonoObject *obj, MonoClass *klass)
 {
 	uint64_t now;
 	uintptr_t len;
 	int do_bt = (nocalls && runtime_inited && !notraces)? TYPE_ALLOC_BT: 0;
+	int sampled = 0;
 	FrameData data;
 	LogBuffer *logbuffer;
 	len = mono_object_get_size (obj);
 	/* account for object alignment in the heap */
 	len += 7;
 	len &= ~7;
+	if (alloc_sample_bytes) {
+		logbuffer = ensure_logbuf (0);
+		if (!logbuffer->alloc_rand)
+			logbuffer->alloc_countdown = next_alloc_sample (logbuffer);
+		logbuffer->alloc_countdown -= len;
+		if (logbuffer->alloc_countdown > 0)
+			return;
+		logbuffer->alloc_countdown = next_alloc_sample (logbuffer);
+		sampled = TYPE_ALLOC_SAMPLED;
+	}
 	if (do_bt)
 		collect_bt (&data);
 	logbuffer = ensure_logbuf (32 + MAX_FRAMES * 8);
 	now = current_time ();
 	ENTER_LOG (logbuffer, "gcalloc");
-	emit_byte (logbuffer, do_bt | TYPE_ALLOC);
+	emit_byte (logbuffer, do_bt | sampled | TYPE_ALLOC);
 	emit_time (logbuffer, now);
 	emit_ptr (logbuffer, klass);
 	emit_obj (logbuffer, obj);
 	emit_value (logbuffer, len);
+	if (sampled)
+		emit_value (logbuffer, alloc_sample_bytes);
 	if (do_bt)
 		emit_bt (logbuffer, &data);
 	EXIT_LOG (logbuffer);
@@ -1226,10 +1472,8 @@ thread_start (MonoProfiler *prof, uintptr_t tid)
 static void
 thread_end (MonoProfiler *prof, uintptr_t tid)
 {
-	take_lock ();
 	if (TLS_GET (tlsbuffer))
-		dump_buffer (prof, TLS_GET (tlsbuffer));
-	release_lock ();
+		send_buffer (prof, TLS_GET (tlsbuffer));
 	TLS_SET (tlsbuffer, NULL);
 }
 
@@ -2439,11 +2683,12 @@ log_shutdown (MonoProfiler *prof)
 	}
 #endif
 	dump_sample_hits (prof, prof->stat_buffers, 1);
-	take_lock ();
 	if (TLS_GET (tlsbuffer))
-		dump_buffer (prof, TLS_GET (tlsbuffer));
+		send_buffer (prof, TLS_GET (tlsbuffer));
 	TLS_SET (tlsbuffer, NULL);
-	release_lock ();
+#ifdef USE_WRITER_THREAD
+	stop_writer_thread (prof);
+#endif
 #if defined (HAVE_SYS_ZLIB)
 	if (prof->gzfile)
 		gzclose (prof->gzfile);
@@ -2787,6 +3032,10 @@ create_profiler (const char *filename)
 #endif
 	prof->startup_time = current_time ();
 	dump_header (prof);
+#ifdef USE_WRITER_THREAD
+	if (use_writer_thread)
+		start_writer_thread (prof);
+#endif
 	return prof;
 }
 
@@ -2798,6 +3047,7 @@ usage (int do_exit)
 	printf ("Options:\n");
 	printf ("\thelp             show this usage info\n");
 	printf ("\t[no]alloc        enable/disable recording allocation info\n");
+	printf ("\talloc=NUM        record one allocation every NUM bytes allocated on average\n");
 	printf ("\t[no]calls        enable/disable recording enter/leave method events\n");
 	printf ("\theapshot[=MODE]  record heap shot info (by default at each major collection)\n");
 	printf ("\t                 MODE: every XXms milliseconds, every YYgc collections, ondemand\n");
@@ -2814,6 +3064,9 @@ usage (int do_exit)
 	printf ("\treport           create a report instead of writing the raw data to a file\n");
 	printf ("\tzip              compress the output data\n");
 	printf ("\tport=PORTNUM     use PORTNUM for the listening command server\n");
+	printf ("\tnowriter         write the data from the profiled threads instead of a writer thread\n");
+	printf ("\tmaxqueue=NUM     queue up to NUM MB of data for the writer thread (default 16)\n");
+	printf ("\tdropfull         drop data instead of waiting when the writer thread queue is full\n");
 	if (do_exit)
 		exit (1);
 }
@@ -2999,8 +3252,13 @@ mono_profiler_startup (const char *desc)
 			nocalls = 1;
 			continue;
 		}
-		if ((opt = match_option (p, "alloc", NULL)) != p) {
+		if ((opt = match_option (p, "alloc", &val)) != p) {
+			char *end;
 			allocs_enabled = 1;
+			if (val) {
+				alloc_sample_bytes = strtoul (val, &end, 10);
+				free (val);
+			}
 			continue;
 		}
 		if ((opt = match_option (p, "noalloc", NULL)) != p) {
@@ -3086,6 +3344,23 @@ mono_profiler_startup (const char *desc)
 			do_counters = 1;
 			continue;
 		}
+		if ((opt = match_option (p, "nowriter", NULL)) != p) {
+			use_writer_thread = 0;
+			continue;
+		}
+		if ((opt = match_option (p, "maxqueue", &val)) != p) {
+			char *end;
+			max_queued_bytes = strtoul (val, &end, 10);
+			if (max_queued_bytes > 1024)
+				max_queued_bytes = 1024;
+			max_queued_bytes *= 1024 * 1024;
+			free (val);
+			continue;
+		}
+		if ((opt = match_option (p, "dropfull", NULL)) != p) {
+			drop_when_full = 1;
+			continue;
+		}
 		if ((opt = match_option (p, "countersonly", NULL)) != p) {
 			only_counters = 1;
 			continue;
@@ -5,7 +5,7 @@
 #define LOG_HEADER_ID 0x4D505A01
 #define LOG_VERSION_MAJOR 0
 #define LOG_VERSION_MINOR 4
-#define LOG_DATA_VERSION 8
+#define LOG_DATA_VERSION 9
 /*
  * Changes in data versions:
  * version 2: added offsets in heap walk
@@ -14,6 +14,7 @@
  * version 5: added counters sampling
  * version 6: added optional backtrace in sampling info
  * version 8: added TYPE_RUNTIME and JIT helpers/trampolines
+ * version 9: added sampled allocations (TYPE_ALLOC_SAMPLED)
  */
 
 enum {
@@ -59,6 +60,7 @@ enum {
 	TYPE_EXCEPTION_BT = 1 << 7,
 	/* extended type for TYPE_ALLOC */
 	TYPE_ALLOC_BT  = 1 << 4,
+	TYPE_ALLOC_SAMPLED = 1 << 5,
 	/* extended type for TYPE_MONITOR */
 	TYPE_MONITOR_BT  = 1 << 7,
 	/* extended type for TYPE_SAMPLE */
@@ -26,6 +26,15 @@ check_report_basics ($report);
 check_report_calls ($report, "T:Main (string[])" => 1);
 check_report_allocation ($report, "System.Object" => 1000000);
 report_errors ();
+# test sampled allocations: the estimated count should be close to the real one
+$report = run_test ("test-alloc.exe", "report,nocalls,alloc=4096");
+check_report_basics ($report);
+check_report_allocation_range ($report, "System.Object" => [900000, 1100000]);
+report_errors ();
+# test a tiny writer queue which drops data: what is written must still decode
+$report = run_test ("test-alloc.exe", "report,maxqueue=1,dropfull");
+check_report_decoded ($report);
+report_errors ();
 # test additional named threads and method calls
 $report = run_test ("test-busy.exe");
 check_report_basics ($report);
@@ -202,6 +211,13 @@ sub check_report_basics
 	check_report_jit ($report);
 }
 
+sub check_report_decoded
+{
+	my $report = shift;
+	push @errors, "Report could not be decoded." if $report =~ /unhandled profiler event/;
+	push @errors, "Incomplete report." unless $report =~ /^Metadata summary$/m;
+}
+
 sub check_report_metadata
 {
 	my $report = shift;
@@ -336,6 +352,21 @@ sub check_report_allocation
 	}
 }
 
+sub check_report_allocation_range
+{
+	my $report = shift;
+	my %allocs = @_;
+	my $section = get_section ($report, "Allocation");
+	foreach my $type (keys %allocs) {
+		my ($min, $max) = @{$allocs{$type}};
+		if ($section =~ /\d+\s+(\d+)\s+\d+\s+\Q$type\E$/m) {
+			push @errors, "Wrong allocs for type $type." unless $1 >= $min && $1 <= $max;
+		} else {
+			push @errors, "No allocs for type $type.";
+		}
+	}
+}
+
 sub check_report_heapshot
 {
 	my $report = shift;
@@ -209,5 +209,26 @@ class Tests {
 
 		return 0;
 	}
+
+	public static int test_0_create_delegate_reuses_code () {
+		Tests d1 = new Tests ();
+		Tests d2 = new Tests ();
+		d1.int_field = 1;
+		d2.int_field = 2;
+
+		// Delegates created by the runtime share the code of the first one invoked
+		for (int i = 0; i < 2; ++i) {
+			if (new Delegate1 (d1.adder1) (2) != 3)
+				return 1;
+			if (((Delegate1)Delegate.CreateDelegate (typeof (Delegate1), d1, "adder1")) (2) != 3)
+				return 2;
+			if (((Delegate1)Delegate.CreateDelegate (typeof (Delegate1), d2, "adder1")) (2) != 4)
+				return 3;
+			if (((Delegate1)Delegate.CreateDelegate (typeof (Delegate1), typeof (Tests), "adder1_static")) (2) != 2)
+				return 4;
+		}
+
+		return 0;
+	}
 }
 }
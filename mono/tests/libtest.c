@@ -416,6 +416,34 @@ mono_test_empty_pinvoke (int i)
 	return i;
 }
 
+LIBTEST_API gint64 STDCALL 
+mono_test_direct_add_int64 (gint64 a, gint64 b)
+{
+	return a + b;
+}
+
+LIBTEST_API double STDCALL 
+mono_test_direct_mul_double (double a, float b)
+{
+	return a * b;
+}
+
+LIBTEST_API gint8 STDCALL 
+mono_test_direct_negate_sbyte (gint8 b)
+{
+	return -b;
+}
+
+LIBTEST_API int STDCALL 
+mono_test_direct_sum_bytes (guint8 *buf, int len)
+{
+	int i, sum = 0;
+
+	for (i = 0; i < len; ++i)
+		sum += buf [i];
+	return sum;
+}
+
 LIBTEST_API int STDCALL  
 mono_test_marshal_bool_byref (int a, int *b, int c)
 {
@@ -5301,6 +5329,14 @@ mono_test_marshal_lpstr (char *str)
 	return strcmp ("ABC", str);
 }
 
+LIBTEST_API char* STDCALL
+mono_test_marshal_lpstr_echo (char *str1, char *str2)
+{
+	if (!str1 || !str2)
+		return NULL;
+	return marshal_strdup (strcmp (str1, str2) ? "" : str1);
+}
+
 LIBTEST_API int STDCALL
 mono_test_marshal_lpwstr (gunichar2 *str)
 {
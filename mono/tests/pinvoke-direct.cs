@@ -0,0 +1,104 @@
+using System;
+using System.Runtime.InteropServices;
+
+namespace System.Runtime.InteropServices {
+	/* Recognized by name, marks p/invokes which are called without a full wrapper */
+	[AttributeUsage (AttributeTargets.Method)]
+	public sealed class SuppressGCTransitionAttribute : Attribute {
+	}
+}
+
+public enum Color : byte {
+	Red = 1,
+	Green = 2
+}
+
+public unsafe class Tests {
+
+	[DllImport ("libtest")]
+	[SuppressGCTransition]
+	public static extern int mono_test_empty_pinvoke (int i);
+
+	[DllImport ("libtest", EntryPoint="mono_test_empty_pinvoke")]
+	[SuppressGCTransition]
+	public static extern Color return_color (Color c);
+
+	[DllImport ("libtest")]
+	[SuppressGCTransition]
+	public static extern long mono_test_direct_add_int64 (long a, long b);
+
+	[DllImport ("libtest")]
+	[SuppressGCTransition]
+	public static extern double mono_test_direct_mul_double (double a, float b);
+
+	[DllImport ("libtest")]
+	[SuppressGCTransition]
+	public static extern sbyte mono_test_direct_negate_sbyte (sbyte b);
+
+	[DllImport ("libtest")]
+	[SuppressGCTransition]
+	public static extern int mono_test_direct_sum_bytes (byte *buf, int len);
+
+	/* Not eligible, these get the regular wrapper */
+	[DllImport ("libtest", EntryPoint="mono_test_direct_sum_bytes")]
+	[SuppressGCTransition]
+	public static extern int sum_bytes_array (byte[] buf, int len);
+
+	[DllImport ("libtest", EntryPoint="mono_test_empty_pinvoke", SetLastError=true)]
+	[SuppressGCTransition]
+	public static extern int empty_pinvoke_last_error (int i);
+
+	public static int Main () {
+		return TestDriver.RunTests (typeof (Tests));
+	}
+
+	public static int test_0_int () {
+		for (int i = 0; i < 1000; ++i) {
+			if (mono_test_empty_pinvoke (i) != i)
+				return 1;
+		}
+		return 0;
+	}
+
+	public static int test_0_enum () {
+		return return_color (Color.Green) == Color.Green ? 0 : 1;
+	}
+
+	public static int test_0_int64 () {
+		return mono_test_direct_add_int64 (0x100000000L, -1) == 0xffffffffL ? 0 : 1;
+	}
+
+	public static int test_0_float () {
+		return mono_test_direct_mul_double (2.5, 4.0f) == 10.0 ? 0 : 1;
+	}
+
+	public static int test_0_small_return () {
+		if (mono_test_direct_negate_sbyte (5) != -5)
+			return 1;
+		if (mono_test_direct_negate_sbyte (-128) != -128)
+			return 2;
+		return 0;
+	}
+
+	public static int test_0_pointer () {
+		byte[] buf = new byte [256];
+
+		for (int i = 0; i < buf.Length; ++i)
+			buf [i] = (byte)i;
+		fixed (byte *p = buf) {
+			if (mono_test_direct_sum_bytes (p, buf.Length) != 255 * 256 / 2)
+				return 1;
+		}
+		return 0;
+	}
+
+	public static int test_0_not_blittable () {
+		byte[] buf = new byte [] { 1, 2, 3 };
+
+		if (sum_bytes_array (buf, buf.Length) != 6)
+			return 1;
+		if (empty_pinvoke_last_error (3) != 3)
+			return 2;
+		return 0;
+	}
+}
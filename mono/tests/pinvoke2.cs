@@ -1722,6 +1722,41 @@ public class Tests {
 		return 0;
 	}
 
+	[DllImport ("libtest", EntryPoint="mono_test_marshal_lpstr_echo")]
+	public static extern string mono_test_marshal_lpstr_echo ([MarshalAs(UnmanagedType.LPStr)] string str1, [MarshalAs(UnmanagedType.LPStr)] string str2);
+
+	public static int test_0_mono_test_marshal_lpstr_sizes () {
+		/* Short strings are converted on the stack, longer ones into a cached buffer */
+		foreach (int len in new int [] { 0, 1, 84, 85, 86, 255, 256, 257, 10000, 2000000 }) {
+			for (int k = 0; k < 3; ++k) {
+				char c = k == 0 ? 'a' : (k == 1 ? '\u00e9' : '\u5e74');
+				string s = new string (c, len);
+
+				if (mono_test_marshal_lpstr_echo (s, String.Copy (s)) != s)
+					return len * 3 + k + 1;
+			}
+		}
+		if (mono_test_marshal_lpstr_echo (null, "") != null)
+			return 1;
+		/* Embedded nuls end the native string */
+		if (mono_test_marshal_lpstr_echo ("ab\0cd", "ab") != "ab")
+			return 2;
+		return 0;
+	}
+
+	public static int test_0_mono_test_marshal_lpstr_invalid () {
+		try {
+			mono_test_marshal_lpstr_echo (new string ('a', 1000) + "\ud800", "");
+			return 1;
+		} catch (ArgumentException) {
+		}
+		/* The cached buffer is still usable */
+		string s = new string ('b', 1000);
+		if (mono_test_marshal_lpstr_echo (s, s) != s)
+			return 2;
+		return 0;
+	}
+
 	[DllImport ("libtest", EntryPoint="mono_test_marshal_lpwstr")]
 	public static extern int mono_test_marshal_lpwstr ([MarshalAs(UnmanagedType.LPWStr)] string str);
 
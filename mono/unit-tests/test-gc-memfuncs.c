@@ -20,6 +20,10 @@
 #include "config.h"
 
 #include "metadata/gc-internal.h"
+#include "utils/mono-hwcap.h"
+#if defined(TARGET_X86) || defined(TARGET_AMD64)
+#include "utils/mono-hwcap-x86.h"
+#endif
 
 #include <stdlib.h>
 #include <string.h>
@@ -30,28 +34,19 @@
 #define START_OFFSET	128
 
 #define BZERO_OFFSETS	64
-#define BZERO_SIZES	256
+#define BZERO_SIZES	512
 
 #define MEMMOVE_SRC_OFFSETS		32
 #define MEMMOVE_DEST_OFFSETS		32
-#define MEMMOVE_SIZES			256
+#define MEMMOVE_SIZES			512
 #define MEMMOVE_NONOVERLAP_START	1024
 
-int
-main (void)
-{
-	unsigned char *random_mem = malloc (POOL_SIZE);
-	unsigned char *reference = malloc (POOL_SIZE);
-	unsigned char *playground = malloc (POOL_SIZE);
-	long *long_random_mem;
-	int i, offset, size, src_offset, dest_offset;
+static unsigned char *random_mem, *reference, *playground;
 
-	srandom (time (NULL));
-
-	/* init random memory */
-	long_random_mem = (long*)random_mem;
-	for (i = 0; i < POOL_SIZE / sizeof (long); ++i)
-		long_random_mem [i] = random ();
+static void
+run_tests (void)
+{
+	int offset, size, src_offset, dest_offset;
 
 	/* test bzero */
 	for (offset = 0; offset <= BZERO_OFFSETS; ++offset) {
@@ -99,6 +94,36 @@ main (void)
 			}
 		}
 	}
+}
+
+int
+main (void)
+{
+	long *long_random_mem;
+	int i;
+
+	random_mem = malloc (POOL_SIZE);
+	reference = malloc (POOL_SIZE);
+	playground = malloc (POOL_SIZE);
+
+	srandom (time (NULL));
+
+	/* init random memory */
+	long_random_mem = (long*)random_mem;
+	for (i = 0; i < POOL_SIZE / sizeof (long); ++i)
+		long_random_mem [i] = random ();
+
+	/* Large blocks use vector code selected by the detected hardware capabilities */
+	mono_hwcap_init ();
+	run_tests ();
+
+#if defined(TARGET_X86) || defined(TARGET_AMD64)
+	/* Test the SSE2 code too */
+	if (mono_hwcap_x86_has_avx2) {
+		mono_hwcap_x86_has_avx2 = FALSE;
+		run_tests ();
+	}
+#endif
 
 	return 0;
 }
@@ -0,0 +1,304 @@
+/*
+ * test-hashtable-bench.c: Throughput and memory benchmark for GHashTable.
+ *
+ * Compares the open addressing GHashTable from eglib with a chained table laid
+ * out like the one it replaced (one malloced node per entry), for integer and
+ * string keys. Pass a number on the command line to scale the number of entries.
+ *
+ * Copyright 2015 Xamarin Inc (http://www.xamarin.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License 2.0 as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License 2.0 along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#define LOOKUP_ROUNDS 20
+
+/* A chained table with the layout of the GHashTable before it used open addressing */
+
+typedef struct _Node Node;
+
+struct _Node {
+	gpointer key;
+	gpointer value;
+	Node *next;
+};
+
+typedef struct {
+	GHashFunc hash_func;
+	GEqualFunc key_equal_func;
+	Node **table;
+	int table_size;
+	int in_use;
+} ChainedTable;
+
+static gpointer
+chained_new (GHashFunc hash_func, GEqualFunc key_equal_func)
+{
+	ChainedTable *t = g_new0 (ChainedTable, 1);
+
+	t->hash_func = hash_func;
+	t->key_equal_func = key_equal_func;
+	t->table_size = g_spaced_primes_closest (1);
+	t->table = g_new0 (Node*, t->table_size);
+	return t;
+}
+
+static void
+chained_rehash (ChainedTable *t)
+{
+	int i, old_size = t->table_size;
+	Node **old = t->table;
+
+	t->table_size = g_spaced_primes_closest (t->in_use * 2);
+	t->table = g_new0 (Node*, t->table_size);
+	for (i = 0; i < old_size; ++i) {
+		Node *n, *next;
+
+		for (n = old [i]; n; n = next) {
+			guint h = t->hash_func (n->key) % t->table_size;
+
+			next = n->next;
+			n->next = t->table [h];
+			t->table [h] = n;
+		}
+	}
+	g_free (old);
+}
+
+static void
+chained_insert (gpointer table, gpointer key, gpointer value)
+{
+	ChainedTable *t = table;
+	guint h;
+	Node *n;
+
+	if (t->in_use > t->table_size * 2)
+		chained_rehash (t);
+	h = t->hash_func (key) % t->table_size;
+	for (n = t->table [h]; n; n = n->next) {
+		if (t->key_equal_func (n->key, key)) {
+			n->value = value;
+			return;
+		}
+	}
+	n = g_new (Node, 1);
+	n->key = key;
+	n->value = value;
+	n->next = t->table [h];
+	t->table [h] = n;
+	t->in_use++;
+}
+
+static gpointer
+chained_lookup (gpointer table, gconstpointer key)
+{
+	ChainedTable *t = table;
+	Node *n;
+
+	for (n = t->table [t->hash_func (key) % t->table_size]; n; n = n->next) {
+		if (t->key_equal_func (n->key, key))
+			return n->value;
+	}
+	return NULL;
+}
+
+static void
+chained_destroy (gpointer table)
+{
+	ChainedTable *t = table;
+	int i;
+
+	for (i = 0; i < t->table_size; ++i) {
+		Node *n, *next;
+
+		for (n = t->table [i]; n; n = next) {
+			next = n->next;
+			g_free (n);
+		}
+	}
+	g_free (t->table);
+	g_free (t);
+}
+
+static gpointer
+ghashtable_new (GHashFunc hash_func, GEqualFunc key_equal_func)
+{
+	return g_hash_table_new (hash_func, key_equal_func);
+}
+
+static void
+ghashtable_insert (gpointer table, gpointer key, gpointer value)
+{
+	g_hash_table_insert (table, key, value);
+}
+
+static gpointer
+ghashtable_lookup (gpointer table, gconstpointer key)
+{
+	return g_hash_table_lookup (table, key);
+}
+
+static void
+ghashtable_destroy (gpointer table)
+{
+	g_hash_table_destroy (table);
+}
+
+typedef struct {
+	const char *name;
+	gpointer (*create) (GHashFunc hash_func, GEqualFunc key_equal_func);
+	void (*insert) (gpointer table, gpointer key, gpointer value);
+	gpointer (*lookup) (gpointer table, gconstpointer key);
+	void (*destroy) (gpointer table);
+} TableOps;
+
+static const TableOps table_ops [] = {
+	{ "GHashTable", ghashtable_new, ghashtable_insert, ghashtable_lookup, ghashtable_destroy },
+	{ "chained", chained_new, chained_insert, chained_lookup, chained_destroy }
+};
+
+static double
+now (void)
+{
+	struct timeval tv;
+
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/* Bytes currently allocated with malloc, or -1 if that can't be determined */
+static gssize
+heap_in_use (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 mi = mallinfo2 ();
+	return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+	struct mallinfo mi = mallinfo ();
+	return mi.uordblks + mi.hblkhd;
+#else
+	return -1;
+#endif
+}
+
+/*
+ * Look the keys up in a different order than they were inserted in, otherwise the
+ * chained table gets to walk its nodes in allocation order.
+ */
+static int*
+shuffled_indexes (int n)
+{
+	int *order = g_new (int, n);
+	guint32 seed = 12345;
+	int i;
+
+	for (i = 0; i < n; ++i)
+		order [i] = i;
+	for (i = n - 1; i > 0; --i) {
+		int j, tmp;
+
+		seed = seed * 1103515245 + 12345;
+		j = (seed >> 8) % (i + 1);
+		tmp = order [i];
+		order [i] = order [j];
+		order [j] = tmp;
+	}
+	return order;
+}
+
+static int
+run (const TableOps *ops, const char *kind, gpointer *keys, int *order, int n, GHashFunc hash_func, GEqualFunc key_equal_func)
+{
+	gpointer table;
+	gssize heap_before, heap_after;
+	double start, insert_time, lookup_time;
+	int i, j, res = 0;
+
+	heap_before = heap_in_use ();
+	start = now ();
+	table = ops->create (hash_func, key_equal_func);
+	for (i = 0; i < n; ++i)
+		ops->insert (table, keys [i], GINT_TO_POINTER (i + 1));
+	insert_time = now () - start;
+	heap_after = heap_in_use ();
+
+	start = now ();
+	for (j = 0; j < LOOKUP_ROUNDS; ++j) {
+		for (i = 0; i < n; ++i) {
+			int k = order [i];
+
+			if (ops->lookup (table, keys [k]) != GINT_TO_POINTER (k + 1))
+				res = 1;
+		}
+	}
+	lookup_time = now () - start;
+
+	printf ("%-10s %-6s %8d entries: insert %7.1f Mops/s, lookup %7.1f Mops/s", ops->name, kind, n,
+		n / insert_time / 1000000.0, (double)n * LOOKUP_ROUNDS / lookup_time / 1000000.0);
+	if (heap_before >= 0)
+		printf (", %5.1f bytes/entry\n", (double)(heap_after - heap_before) / n);
+	else
+		printf ("\n");
+
+	ops->destroy (table);
+	if (res)
+		printf ("%s: LOOKUP FAILED\n", ops->name);
+	return res;
+}
+
+int
+main (int argc, char **argv)
+{
+	int sizes [] = { 100, 10000, 200000 };
+	int i, j, k, scale = 1, res = 0;
+
+	if (argc > 1)
+		scale = MAX (1, atoi (argv [1]));
+
+	for (i = 0; i < G_N_ELEMENTS (sizes); ++i) {
+		int n = sizes [i] * scale;
+		gpointer *int_keys = g_new (gpointer, n);
+		gpointer *str_keys = g_new (gpointer, n);
+		int *order = shuffled_indexes (n);
+
+		/* Aligned pointer-like keys, the common case for g_direct_hash () */
+		for (k = 0; k < n; ++k) {
+			int_keys [k] = GUINT_TO_POINTER ((k + 1) * 16);
+			str_keys [k] = g_strdup_printf ("System.Collections.Generic.Key%d", k);
+		}
+
+		for (j = 0; j < G_N_ELEMENTS (table_ops); ++j) {
+			res += run (&table_ops [j], "int", int_keys, order, n, g_direct_hash, g_direct_equal);
+			res += run (&table_ops [j], "string", str_keys, order, n, g_str_hash, g_str_equal);
+		}
+
+		for (k = 0; k < n; ++k)
+			g_free (str_keys [k]);
+		g_free (int_keys);
+		g_free (str_keys);
+		g_free (order);
+	}
+
+	return res;
+}
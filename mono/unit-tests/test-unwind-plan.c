@@ -0,0 +1,205 @@
+/*
+ * test-unwind-plan.c: Unit test for unwinding with precomputed unwind plans.
+ *
+ * Unwinding a frame with the plan built for some unwind info must give the same
+ * result as decoding the unwind info with mono_unwind_frame (), at every ip.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License 2.0 as published by the Free Software Foundation;
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License 2.0 along with this library; if not, write to the Free
+ * Software Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "config.h"
+
+#include "mini/mini.h"
+#include "mini/mini-unwind.h"
+#include "utils/mono-counters.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(TARGET_AMD64) || defined(TARGET_X86)
+
+#ifdef TARGET_AMD64
+#define SP_REG AMD64_RSP
+#define FP_REG AMD64_RBP
+#define SAVED_REG1 AMD64_RBX
+#define SAVED_REG2 AMD64_R12
+#else
+#define SP_REG X86_ESP
+#define FP_REG X86_EBP
+#define SAVED_REG1 X86_EBX
+#define SAVED_REG2 X86_ESI
+#endif
+/* The unwinders keep the ip of the caller after the integer registers */
+#define PC_REG MONO_MAX_IREGS
+#define NREGS (MONO_MAX_IREGS + 1)
+
+#define SLOT_SIZE ((int)sizeof (mgreg_t))
+#define CODE_LEN 64
+/* Where the epilog is at compile time */
+#define EPILOG_POS 40
+
+static GSList*
+add_op (GSList *ops, int when, int op, int reg, int val)
+{
+	MonoUnwindOp *unwind_op = g_new0 (MonoUnwindOp, 1);
+
+	unwind_op->op = op;
+	unwind_op->reg = reg;
+	unwind_op->val = val;
+	unwind_op->when = when;
+	return g_slist_append (ops, unwind_op);
+}
+
+/*
+ * Unwind ops of a method with a frame pointer, which saves two registers, and has
+ * an exit in the middle of the body, and an epilog at EPILOG_POS. With USE_STATE,
+ * the ops after the inner exit restore the state of the body. With USE_MARK, the
+ * epilog ops are relative to a mark location given at unwind time.
+ */
+static GSList*
+create_unwind_ops (gboolean use_state, gboolean use_mark)
+{
+	GSList *ops = NULL;
+
+	/* state at the call site */
+	ops = add_op (ops, 0, DW_CFA_def_cfa, SP_REG, SLOT_SIZE);
+	ops = add_op (ops, 0, DW_CFA_offset, PC_REG, -SLOT_SIZE);
+	/* push fp; mov fp, sp */
+	ops = add_op (ops, 1, DW_CFA_def_cfa_offset, 0, 2 * SLOT_SIZE);
+	ops = add_op (ops, 1, DW_CFA_offset, FP_REG, -2 * SLOT_SIZE);
+	ops = add_op (ops, 4, DW_CFA_def_cfa_register, FP_REG, 0);
+	/* save the callee saved registers */
+	ops = add_op (ops, 6, DW_CFA_offset, SAVED_REG1, -3 * SLOT_SIZE);
+	ops = add_op (ops, 8, DW_CFA_offset, SAVED_REG2, -4 * SLOT_SIZE);
+
+	if (use_state) {
+		/* an exit in the middle of the body: pop the frame and ret */
+		ops = add_op (ops, 20, DW_CFA_remember_state, 0, 0);
+		ops = add_op (ops, 22, DW_CFA_same_value, SAVED_REG2, 0);
+		ops = add_op (ops, 22, DW_CFA_same_value, SAVED_REG1, 0);
+		ops = add_op (ops, 24, DW_CFA_def_cfa, SP_REG, SLOT_SIZE);
+		ops = add_op (ops, 24, DW_CFA_same_value, FP_REG, 0);
+		ops = add_op (ops, 25, DW_CFA_restore_state, 0, 0);
+		/* more body, using a different frame offset */
+		ops = add_op (ops, 30, DW_CFA_def_cfa_offset, 0, 2 * SLOT_SIZE);
+	}
+
+	if (use_mark)
+		ops = add_op (ops, EPILOG_POS, DW_CFA_mono_advance_loc, 0, 0);
+	/* the epilog: restore the registers, pop fp, ret */
+	ops = add_op (ops, EPILOG_POS + 2, DW_CFA_same_value, SAVED_REG2, 0);
+	ops = add_op (ops, EPILOG_POS + 4, DW_CFA_same_value, SAVED_REG1, 0);
+	ops = add_op (ops, EPILOG_POS + 5, DW_CFA_def_cfa, SP_REG, SLOT_SIZE);
+	ops = add_op (ops, EPILOG_POS + 5, DW_CFA_same_value, FP_REG, 0);
+
+	return ops;
+}
+
+static int
+check_unwind_info (const char *desc, gboolean use_state, gboolean use_mark, int mark_pos)
+{
+	static mgreg_t stack [64];
+	GSList *ops;
+	guint8 *unwind_info;
+	guint32 unwind_info_len, index;
+	MonoUnwindPlan *plan;
+	guint8 code [CODE_LEN];
+	guint8 *mark_locations [1], **marks;
+	int i, ip, res = 0;
+
+	ops = create_unwind_ops (use_state, use_mark);
+	unwind_info = mono_unwind_ops_encode (ops, &unwind_info_len);
+	index = mono_cache_unwind_info (unwind_info, unwind_info_len);
+	plan = mono_get_cached_unwind_plan (index);
+	if (!plan) {
+		printf ("%s: no plan was built\n", desc);
+		return 1;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (stack); ++i)
+		stack [i] = 0x1000 + i;
+	mark_locations [0] = code + mark_pos;
+	marks = use_mark ? mark_locations : NULL;
+
+	for (ip = 0; ip < CODE_LEN; ++ip) {
+		mgreg_t regs [NREGS], plan_regs [NREGS];
+		mgreg_t *save_locations [NREGS], *plan_save_locations [NREGS];
+		guint8 *cfa, *plan_cfa;
+
+		/* the frame is in the middle of STACK, so each saved register comes from a different slot */
+		for (i = 0; i < NREGS; ++i)
+			regs [i] = 0x100 + i;
+		regs [SP_REG] = (mgreg_t)&stack [16];
+		regs [FP_REG] = (mgreg_t)&stack [24];
+		memcpy (plan_regs, regs, sizeof (regs));
+
+		mono_unwind_frame (unwind_info, unwind_info_len, code, code + CODE_LEN, code + ip, marks,
+						   regs, NREGS, save_locations, NREGS, &cfa);
+		mono_unwind_frame_with_plan (plan, code, code + ip, marks,
+									 plan_regs, NREGS, plan_save_locations, NREGS, &plan_cfa);
+
+		if (cfa != plan_cfa) {
+			printf ("%s: ip %d: cfa %p, with the plan %p\n", desc, ip, cfa, plan_cfa);
+			res = 1;
+		}
+		for (i = 0; i < NREGS; ++i) {
+			if (regs [i] != plan_regs [i]) {
+				printf ("%s: ip %d: reg %d is %p, with the plan %p\n", desc, ip, i, (gpointer)regs [i], (gpointer)plan_regs [i]);
+				res = 1;
+			}
+			if (save_locations [i] != plan_save_locations [i]) {
+				printf ("%s: ip %d: reg %d is saved at %p, with the plan %p\n", desc, ip, i, save_locations [i], plan_save_locations [i]);
+				res = 1;
+			}
+		}
+	}
+
+	g_slist_foreach (ops, (GFunc)g_free, NULL);
+	g_slist_free (ops);
+	g_free (unwind_info);
+	return res;
+}
+
+int
+main (void)
+{
+	int res = 0;
+
+	mono_counters_init ();
+	mono_unwind_init ();
+
+	res |= check_unwind_info ("plain", FALSE, FALSE, 0);
+	res |= check_unwind_info ("remember/restore state", TRUE, FALSE, 0);
+	res |= check_unwind_info ("epilog mark", FALSE, TRUE, EPILOG_POS);
+	/* a shared epilog, which is further away from the start than at compile time */
+	res |= check_unwind_info ("moved epilog mark", FALSE, TRUE, EPILOG_POS + 8);
+	res |= check_unwind_info ("remember/restore state and epilog mark", TRUE, TRUE, EPILOG_POS);
+
+	mono_unwind_cleanup ();
+
+	if (res)
+		printf ("UNWIND PLAN TEST FAILED\n");
+	return res;
+}
+
+#else
+
+int
+main (void)
+{
+	/* Only the amd64 and x86 unwinders use plans */
+	return 0;
+}
+
+#endif
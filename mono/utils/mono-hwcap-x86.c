@@ -38,6 +38,8 @@ gboolean mono_hwcap_x86_has_ssse3 = FALSE;
 gboolean mono_hwcap_x86_has_sse41 = FALSE;
 gboolean mono_hwcap_x86_has_sse42 = FALSE;
 gboolean mono_hwcap_x86_has_sse4a = FALSE;
+gboolean mono_hwcap_x86_has_avx = FALSE;
+gboolean mono_hwcap_x86_has_avx2 = FALSE;
 
 static gboolean
 cpuid (int id, int *p_eax, int *p_ebx, int *p_ecx, int *p_edx)
@@ -88,9 +90,10 @@ cpuid (int id, int *p_eax, int *p_ebx, int *p_ecx, int *p_edx)
 #endif
 
 	/* Now issue the actual cpuid instruction. We can use
-	   MSVC's __cpuid on both 32-bit and 64-bit. */
+	   MSVC's __cpuidex on both 32-bit and 64-bit. The sub-leaf
+	   in ECX is always 0, leaf 7 needs it. */
 #if defined(_MSC_VER)
-	__cpuid (info, id);
+	__cpuidex (info, id, 0);
 	*p_eax = info [0];
 	*p_ebx = info [1];
 	*p_ecx = info [2];
@@ -103,23 +106,46 @@ cpuid (int id, int *p_eax, int *p_ebx, int *p_ecx, int *p_edx)
 		"cpuid\n\t"
 		"xchgl\t%%ebx, %k1\n\t"
 		: "=a" (*p_eax), "=&r" (*p_ebx), "=c" (*p_ecx), "=d" (*p_edx)
-		: "0" (id)
+		: "0" (id), "2" (0)
 	);
 #else
 	__asm__ __volatile__ (
 		"cpuid\n\t"
 		: "=a" (*p_eax), "=b" (*p_ebx), "=c" (*p_ecx), "=d" (*p_edx)
-		: "a" (id)
+		: "a" (id), "c" (0)
 	);
 #endif
 
 	return TRUE;
 }
 
+/* Returns the low 32 bits of XCR0. Only call this if cpuid reports OSXSAVE. */
+static guint32
+xgetbv (void)
+{
+#if defined(_MSC_VER)
+	return (guint32)_xgetbv (0);
+#else
+	guint32 eax, edx;
+
+	/* xgetbv, spelled out for old assemblers */
+	__asm__ __volatile__ (
+		".byte 0x0f, 0x01, 0xd0\n\t"
+		: "=a" (eax), "=d" (edx)
+		: "c" (0)
+	);
+	return eax;
+#endif
+}
+
 void
 mono_hwcap_arch_init (void)
 {
 	int eax, ebx, ecx, edx;
+	int max_leaf = 0;
+
+	if (cpuid (0, &eax, &ebx, &ecx, &edx))
+		max_leaf = eax;
 
 	if (cpuid (1, &eax, &ebx, &ecx, &edx)) {
 		if (edx & (1 << 15)) {
@@ -146,6 +172,15 @@ mono_hwcap_arch_init (void)
 
 		if (ecx & (1 << 20))
 			mono_hwcap_x86_has_sse42 = TRUE;
+
+		/* AVX also needs the OS to save the YMM registers (OSXSAVE, XCR0 bits 1 and 2) */
+		if ((ecx & (1 << 28)) && (ecx & (1 << 27)) && (xgetbv () & 0x6) == 0x6)
+			mono_hwcap_x86_has_avx = TRUE;
+	}
+
+	if (mono_hwcap_x86_has_avx && max_leaf >= 7 && cpuid (7, &eax, &ebx, &ecx, &edx)) {
+		if (ebx & (1 << 5))
+			mono_hwcap_x86_has_avx2 = TRUE;
 	}
 
 	if (cpuid (0x80000000, &eax, &ebx, &ecx, &edx)) {
@@ -175,4 +210,6 @@ mono_hwcap_print (FILE *f)
 	g_fprintf (f, "mono_hwcap_x86_has_sse41 = %i\n", mono_hwcap_x86_has_sse41);
 	g_fprintf (f, "mono_hwcap_x86_has_sse42 = %i\n", mono_hwcap_x86_has_sse42);
 	g_fprintf (f, "mono_hwcap_x86_has_sse4a = %i\n", mono_hwcap_x86_has_sse4a);
+	g_fprintf (f, "mono_hwcap_x86_has_avx = %i\n", mono_hwcap_x86_has_avx);
+	g_fprintf (f, "mono_hwcap_x86_has_avx2 = %i\n", mono_hwcap_x86_has_avx2);
 }
@@ -369,6 +369,10 @@ mono_file_map (size_t length, int flags, int fd, guint64 offset, void **ret_hand
 		mflags |= MAP_FIXED;
 	if (flags & MONO_MMAP_32BIT)
 		mflags |= MAP_32BIT;
+#ifdef MAP_POPULATE
+	if (flags & MONO_MMAP_POPULATE)
+		mflags |= MAP_POPULATE;
+#endif
 
 	ptr = mmap (0, length, prot, mflags, fd, offset);
 	if (ptr == MAP_FAILED)
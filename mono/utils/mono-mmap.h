@@ -17,7 +17,9 @@ enum {
 	MONO_MMAP_SHARED  = 1 << 5,
 	MONO_MMAP_ANON    = 1 << 6,
 	MONO_MMAP_FIXED   = 1 << 7,
-	MONO_MMAP_32BIT   = 1 << 8
+	MONO_MMAP_32BIT   = 1 << 8,
+	/* prefault the pages of file mappings, if supported */
+	MONO_MMAP_POPULATE = 1 << 9
 };
 
 /*